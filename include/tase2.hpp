@@ -10,60 +10,34 @@
 #include <plugin_api.h>
 #include <reading.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <map>
 #include <mutex>
+#include <queue>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "libtase2/hal_thread.h"
 #include "libtase2/hal_time.h"
 #include "libtase2/tase2_server.h"
+#include "tase2_backoff.hpp"
+#include "tase2_coalescer.hpp"
+#include "tase2_command_queue.hpp"
 #include "tase2_config.hpp"
 #include "tase2_datapoint.hpp"
+#include "tase2_ingest_queue.hpp"
+#include "tase2_latency.hpp"
+#include "tase2_outstanding_command.hpp"
+#include "tase2_pivot.hpp"
+#include "tase2_update_traits.hpp"
 #include "tase2_utility.hpp"
 
-class TASE2OutstandingCommand
-{
-  public:
-    TASE2OutstandingCommand (const std::string& domain,
-                             const std::string& name, int cmdExecTimeout,
-                             bool isSelect);
-    ~TASE2OutstandingCommand () = default;
-
-    bool hasTimedOut (uint64_t currentTime);
-
-    std::string
-    Domain ()
-    {
-        return m_domain;
-    };
-    std::string
-    Name ()
-    {
-        return m_name;
-    };
-
-    bool
-    isSelect ()
-    {
-        return m_select;
-    };
-
-  private:
-    std::string m_domain;
-    std::string m_name;
-
-    bool m_select;
-
-    int m_cmdExecTimeout;
-
-    uint64_t m_commandRcvdTime = 0;
-    uint64_t m_nextTimeout = 0;
-
-    int m_state = 0; /* 0 - idle/complete, 1 - waiting for ACT-CON, 2 - waiting
-                        for ACT-TERM */
-};
+/* maximum number of model updates applied per m_connectionLock hold */
+#define TASE2_UPDATES_PER_LOCK 1024
 
 class TASE2Server
 {
@@ -83,8 +57,34 @@ class TASE2Server
     {
         m_modelPath = path;
     };
+
+    /* compiled model kept between starts, empty to always import the
+     * JSON configuration */
+    void
+    setModelSnapshotPath (const std::string& path)
+    {
+        m_modelSnapshotPath = path;
+    };
+
+    const std::string&
+    getModelSnapshotPath () const
+    {
+        return m_modelSnapshotPath;
+    };
+
+    /* true when the running model was replayed from the snapshot */
+    bool
+    isModelReplayed () const
+    {
+        return m_modelReplayed;
+    };
+
     void configure (const ConfigCategory* conf);
-    void handleActCon (const std::string& domain, const std::string& name);
+
+    /* applies a changed configuration, rebuilds the server only when the
+     * model shape, the protocol stack or the TLS configuration changed */
+    void reconfigure (const ConfigCategory* conf);
+    void handleActCon (TASE2Datapoint* controlPoint);
     uint32_t send (const std::vector<Reading*>& readings);
     void stop ();
     void registerControl (int (*operation) (char* operation, int paramCount,
@@ -92,8 +92,6 @@ class TASE2Server
                                             ControlDestination destination,
                                             ...));
 
-    void updateDatapointInServer (std::shared_ptr<TASE2Datapoint>,
-                                  bool timeSynced);
     const std::string getObjRefFromID (const std::string& id);
     TASE2Config*
     getConfig ()
@@ -105,13 +103,58 @@ class TASE2Server
                                const std::string& label, uint64_t timestamp,
                                bool hasSelect);
 
+    /* false when send applies updates synchronously */
+    bool getIngestStats (TASE2IngestStats& stats);
+
+    /* updates left out by deadband and identical value filters */
+    uint64_t getSuppressedUpdates ();
+
+    /* updates left out by last-value-wins coalescing */
+    uint64_t getCoalescedUpdates ();
+
+    /* commands rejected by the command rate limits */
+    uint64_t
+    getThrottledCommands () const
+    {
+        return m_throttledCommands.load (std::memory_order_relaxed);
+    };
+
+    /* command latencies of a control point, nullptr for unknown points
+     * and for points that did not receive a command yet */
+    const TASE2CommandLatency*
+    getCommandLatency (const std::string& domain,
+                       const std::string& name) const;
+
+    /* command latencies of all control points of a type */
+    const TASE2CommandLatency&
+    getCommandLatency (Tase2_ControlPointType type) const
+    {
+        return m_commandLatency[type];
+    };
+
   private:
     std::vector<std::pair<TASE2Server*, TASE2Datapoint*>*>* sdpObjects
         = nullptr;
 
-    std::vector<TASE2OutstandingCommand*> m_outstandingCommands;
+    /* select-before-operate state of every control point, the points also
+     * flag their own state so that handleActCon can skip the lock */
+    TASE2OutstandingCommands m_outstandingCommands;
     std::mutex m_outstandingCommandsLock;
 
+    /* earliest deadline on top, the monitoring thread sleeps until then */
+    std::priority_queue<TASE2CommandTimeout,
+                        std::vector<TASE2CommandTimeout>,
+                        std::greater<TASE2CommandTimeout> >
+        m_commandTimeouts;
+    std::condition_variable m_commandTimeoutsCond;
+
+    /* indexed by Tase2_ControlPointType */
+    TASE2CommandLatency m_commandLatency[3];
+
+    /* limit over all control points, taken with the point's own bucket */
+    TASE2TokenBucket m_commandRate;
+    std::atomic<uint64_t> m_throttledCommands{ 0 };
+
     Semaphore outputQueueLock = nullptr;
     LinkedList outputQueue = nullptr;
 
@@ -121,11 +164,18 @@ class TASE2Server
     TLSConfiguration m_tlsConfig = nullptr;
 
     std::string m_modelPath;
+    std::string m_modelSnapshotPath;
+    bool m_modelReplayed = false;
 
-    uint64_t m_lastConnCheck;
-    uint64_t m_connTimeout = 5000;
+    /* as last applied, compared by reconfigure */
+    std::string m_stackConfigJson;
+    std::string m_tlsConfigJson;
 
-    bool m_started;
+    /* held by send, reconfigure and stop, the configuration and the
+     * model do not change under a batch of readings */
+    std::mutex m_configLock;
+
+    std::atomic<bool> m_started;
     std::string m_name;
     TASE2Config* m_config = nullptr;
 
@@ -135,23 +185,74 @@ class TASE2Server
 
     std::thread* m_monitoringThread = nullptr;
     std::thread* m_connectionThread = nullptr;
+    std::thread* m_publisherThread = nullptr;
+    std::thread* m_dispatchThread = nullptr;
     std::mutex m_connectionLock;
 
-    std::unordered_map<std::string, std::shared_ptr<TASE2Datapoint> >
-        m_modelEntries;
+    /* nullptr when the handlers dispatch commands themselves */
+    TASE2CommandQueue* m_commandQueue = nullptr;
+
+    /* connection thread waits between reconnect attempts */
+    std::mutex m_connectionStateLock;
+    std::condition_variable m_connectionStateCond;
 
     int (*m_oper) (char* operation, int paramCount, char* names[],
                    char* parameters[], ControlDestination destination, ...)
         = NULL;
 
+    std::vector<TASE2PointUpdate> m_pendingUpdates;
+
+    /* asynchronous ingest mode, send only queues the decoded updates */
+    TASE2IngestQueue* m_ingestQueue = nullptr;
+
+    /* optional, used by the thread that applies the updates */
+    TASE2UpdateCoalescer* m_coalescer = nullptr;
+
+    std::atomic<uint64_t> m_suppressedUpdates{ 0 };
+
+    bool decodeUpdate (const TASE2AssetEntry* assetEntry, Datapoint* dp,
+                       const std::string& dpJson, TASE2PointUpdate& update);
+    void applyUpdate (const TASE2PointUpdate& update);
+    void applyUpdates (const std::vector<TASE2PointUpdate>& updates);
+
+    bool readConfig (const ConfigCategory* config, std::string& stackConfig,
+                     std::string& exchangeConfig, std::string& tlsConfig,
+                     std::string& modelConfig);
+    /* true when the model was replayed from the snapshot */
+    bool importModel (const std::string& modelConfig,
+                      const std::string& exchangeConfig, TASE2Config*& config,
+                      Tase2_DataModel& model);
+    static void discardModel (TASE2Config* config, Tase2_DataModel model);
+    void createServer (const std::string& stackConfig,
+                       const std::string& tlsConfig);
+    void rebuildServer (TASE2Config* config, Tase2_DataModel model,
+                        const std::string& stackConfig,
+                        const std::string& tlsConfig);
+    void updateServer (const TASE2Config& config);
+    /* stop with m_configLock held */
+    void stopLocked ();
     bool createTLSConfiguration ();
     void _monitoringThread ();
     void _connectionThread ();
-
-    void addToOutstandingCommands (const std::string& domain,
-                                   const std::string& name, bool isSelect);
+    void _publisherThread ();
+    void stopPublisher ();
+    void _dispatchThread ();
+    void stopDispatcher ();
+    static void joinThread (std::thread*& thread);
+
+    Tase2_HandlerResult startCommand (TASE2Datapoint* controlPoint,
+                                      bool isSelect, uint64_t receivedUs);
+    bool takeCommandTokens (TASE2Datapoint* controlPoint);
+    void cancelCommand (TASE2Datapoint* controlPoint);
+    void dispatchCommand (const TASE2CommandRequest& request);
+
+    /* dispatch latency, or confirmation latency when confirmed is set */
+    void recordCommandLatency (TASE2Datapoint* controlPoint, bool confirmed,
+                               uint64_t receivedUs);
+    void logCommandLatencies ();
 
     void removeAllOutstandingCommands ();
+    void expireOutstandingCommand (const TASE2CommandTimeout& timeout);
 
     static void clientConnectionHandler (void* parameter,
                                          const char* clientAddress,
@@ -166,9 +267,11 @@ class TASE2Server
                                               Tase2_TagValue value,
                                               const char* reason);
 
-    void forwardCommand (const std::string& scope, const std::string& domain,
-                         const std::string& name, const std::string& type,
-                         uint64_t ts, Tase2_OperateValue* value, bool select);
+    Tase2_HandlerResult forwardCommand (Tase2_ControlPoint controlPoint,
+                                        const char* action, uint64_t ts,
+                                        uint64_t receivedUs,
+                                        const Tase2_OperateValue* value,
+                                        bool select);
     static Tase2_HandlerResult operateHandler (void* parameter,
                                                Tase2_ControlPoint controlPoint,
                                                Tase2_OperateValue value);
@@ -176,7 +279,9 @@ class TASE2Server
     FRIEND_TEST (ConnectionHandlerTest, NormalConnection);
     FRIEND_TEST (ControlTest, OutstandingCommandSuccess);
     FRIEND_TEST (ControlTest, OutstandingCommandFailure);
+    FRIEND_TEST (ControlTest, SelectConfirmationIsNotRecorded);
     FRIEND_TEST (DatasetTest, CreateDatasetAndUpdate);
+    FRIEND_TEST (RateLimitTest, RejectedRequestKeepsTokens);
     FRIEND_TEST (ConnectionHandlerTest, NormalConnectionActive);
     friend class DatasetTest;
 };
@@ -0,0 +1,38 @@
+#ifndef TASE2_BACKOFF_H
+#define TASE2_BACKOFF_H
+
+#include <cstdint>
+#include <random>
+
+/*
+ * Exponential backoff for reconnect attempts. The interval doubles with
+ * every attempt up to the maximum; the returned delay is drawn from the
+ * upper half of the current interval, so that several plugin instances
+ * do not retry in lockstep.
+ */
+class TASE2Backoff
+{
+  public:
+    TASE2Backoff (uint64_t minInterval, uint64_t maxInterval);
+    ~TASE2Backoff () = default;
+
+    /* delay in ms before the next attempt */
+    uint64_t next ();
+
+    void reset ();
+
+    uint64_t
+    minInterval () const
+    {
+        return m_minInterval;
+    };
+
+  private:
+    uint64_t m_minInterval;
+    uint64_t m_maxInterval;
+    uint64_t m_interval;
+
+    std::minstd_rand m_random;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef TASE2_COALESCER_H
+#define TASE2_COALESCER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "tase2_ingest_queue.hpp"
+
+/*
+ * Last-value-wins reduction of a batch of point updates. Only the newest
+ * update per point is kept, at the position of that newest update; points
+ * marked as coalesce exempt keep all their updates. A dirty bitmap over
+ * the point ids makes a pass O(updates), independent of the model size.
+ */
+class TASE2UpdateCoalescer
+{
+  public:
+    explicit TASE2UpdateCoalescer (size_t pointCount);
+    ~TASE2UpdateCoalescer () = default;
+
+    void coalesce (std::vector<TASE2PointUpdate>& updates);
+
+    /* number of updates removed so far */
+    uint64_t
+    getCoalesced () const
+    {
+        return m_coalesced;
+    };
+
+  private:
+    bool testAndSet (uint32_t id);
+    void clear (uint32_t id);
+
+    std::vector<uint64_t> m_dirty;
+
+    uint64_t m_coalesced = 0;
+};
+
+#endif
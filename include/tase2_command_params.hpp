@@ -0,0 +1,87 @@
+#ifndef TASE2_COMMAND_PARAMS_H
+#define TASE2_COMMAND_PARAMS_H
+
+#include <cstdint>
+#include <string>
+
+#include "libtase2/tase2_common.h"
+
+enum CommandParameters
+{
+    CMD_TYPE,
+    CMD_SCOPE,
+    CMD_DOMAIN,
+    CMD_NAME,
+    CMD_VALUE,
+    CMD_SELECT,
+    CMD_TS,
+    CMD_PARAMETER_COUNT
+};
+
+/* large enough for an int16 or a float printed with %f */
+#define TASE2_COMMAND_VALUE_SIZE 64
+#define TASE2_COMMAND_TS_SIZE 24
+
+/*
+ * Parameters of the TASE2Command operation for one control point. The
+ * constant part (type, scope, domain, name) is built with the model, a
+ * command only adds the value, the select flag and the timestamp.
+ */
+class TASE2CommandParams
+{
+  public:
+    TASE2CommandParams (const std::string& domain, const std::string& name,
+                        Tase2_ControlPointType type);
+    ~TASE2CommandParams () = default;
+
+    /* the parameters point into the strings of the block */
+    TASE2CommandParams (const TASE2CommandParams&) = delete;
+    TASE2CommandParams& operator= (const TASE2CommandParams&) = delete;
+
+    const std::string&
+    Domain () const
+    {
+        return m_domain;
+    };
+
+    const std::string&
+    Name () const
+    {
+        return m_name;
+    };
+
+    const char*
+    Type () const
+    {
+        return m_parameters[CMD_TYPE];
+    };
+
+    static char**
+    Names ()
+    {
+        return s_names;
+    };
+
+    /*
+     * Fills parameters with the operation parameters of a command. The
+     * value (nullptr for a select) and the timestamp are formatted into
+     * the caller's buffers, of TASE2_COMMAND_VALUE_SIZE and
+     * TASE2_COMMAND_TS_SIZE bytes.
+     */
+    void build (char* parameters[CMD_PARAMETER_COUNT],
+                const Tase2_OperateValue* value, bool select, uint64_t ts,
+                char* valueBuffer, char* tsBuffer) const;
+
+  private:
+    std::string m_scope;
+    std::string m_domain;
+    std::string m_name;
+
+    Tase2_ControlPointType m_type;
+
+    char* m_parameters[CMD_PARAMETER_COUNT];
+
+    static char* s_names[CMD_PARAMETER_COUNT];
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef TASE2_COMMAND_QUEUE_H
+#define TASE2_COMMAND_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "libtase2/tase2_common.h"
+#include "tase2_datapoint.hpp"
+
+#define TASE2_COMMAND_QUEUE_DEFAULT_SIZE 256
+
+/* select or operate accepted by a handler, waiting to be dispatched */
+struct TASE2CommandRequest
+{
+    TASE2Datapoint* controlPoint;
+    Tase2_OperateValue value;
+    bool select;
+
+    /* wall clock time in ms for the co_ts parameter */
+    uint64_t ts;
+
+    /* monotonic time in us the request was received by the handler */
+    uint64_t receivedUs;
+};
+
+/*
+ * Bounded FIFO between the libtase2 handlers and the dispatcher thread.
+ * A single consumer takes the requests in arrival order, so requests for
+ * the same control point are dispatched in the order they were accepted.
+ */
+class TASE2CommandQueue
+{
+  public:
+    explicit TASE2CommandQueue (size_t capacity);
+    ~TASE2CommandQueue () = default;
+
+    /* false when the queue is full or closed */
+    bool push (const TASE2CommandRequest& request);
+
+    /* waits for a request, false once the queue is closed and empty */
+    bool pop (TASE2CommandRequest& request);
+
+    /* rejects new requests, the queued ones can still be taken */
+    void close ();
+
+    size_t size ();
+
+    size_t
+    capacity () const
+    {
+        return m_capacity;
+    };
+
+  private:
+    size_t m_capacity;
+
+    std::deque<TASE2CommandRequest> m_requests;
+    bool m_closed = false;
+
+    std::mutex m_lock;
+    std::condition_variable m_condition;
+};
+
+#endif
@@ -4,7 +4,13 @@
 #include "logger.h"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
+#include "tase2_command_queue.hpp"
 #include "tase2_datapoint.hpp"
+#include "tase2_ingest_queue.hpp"
+#include "tase2_model_snapshot.hpp"
+#include "tase2_point_index.hpp"
+#include "tase2_rate_limit.hpp"
+#include "tase2_update_traits.hpp"
 
 #include <algorithm>
 #include <regex>
@@ -14,6 +20,101 @@
 
 #include <libtase2/tase2_server.h>
 
+/* FNV-1a offset basis, the model shape of an empty configuration */
+#define TASE2_MODEL_SHAPE_INIT 0xcbf29ce484222325ULL
+
+/*
+ * Point resolved from the asset name of a reading (exchanged data label or
+ * pivot id), see TASE2Config::getDatapointByAsset.
+ */
+struct TASE2AssetEntry
+{
+    std::string domain;
+    TASE2Datapoint* point;
+
+    /* of the point type, nullptr for commands; a reading of the asset is
+     * applied with these, its identifiers and type are not decoded */
+    const TASE2UpdateTraits* traits;
+};
+
+/* upper bound of the points one range of model_conf expands to */
+#define TASE2_RANGE_MAX_POINTS 1000000
+
+/*
+ * Range of point names in model_conf, "prefix" followed by each index of
+ * "range" : [ first, last ], zero padded to "digits" when given. A
+ * datapoint with a range stands for one point per name, bilateral tables
+ * and datasets can refer to a range or to the points of a "tag".
+ */
+struct TASE2PointRange
+{
+    std::string prefix;
+    uint32_t first;
+    uint32_t last;
+    int digits;
+
+    std::string name (uint32_t index) const;
+};
+
+/* datapoint of model_conf, validated but not yet added to the model */
+struct TASE2PreparedPoint
+{
+    std::string name;
+    DPTYPE type;
+    std::string tag;
+
+    /* indication points */
+    bool hasCOV;
+    TASE2IndicationOptions options;
+
+    /* control points */
+    Tase2_DeviceClass deviceClass;
+    bool hasTag;
+    int16_t checkBackId;
+    TASE2RateLimit limit;
+};
+
+/* an ICC as prepared by an import thread */
+struct TASE2PreparedIcc
+{
+    std::string name;
+    bool hasName = false;
+    bool hasDatapoints = false;
+
+    std::vector<TASE2PreparedPoint> points;
+
+    /* an invalid datapoint follows the points, the import stops there */
+    bool stop = false;
+};
+
+enum TASE2PrepareResult
+{
+    PREPARE_POINT,
+    PREPARE_SKIP,
+    PREPARE_STOP
+};
+
+/*
+ * Bilateral table as configured, kept to compare the tables of two
+ * configurations; points are referred to by point id.
+ */
+struct TASE2BilateralTableDef
+{
+    std::string name;
+    std::string icc;
+    std::string apTitle;
+    int aeQualifier;
+    std::vector<uint32_t> points;
+
+    bool
+    operator== (const TASE2BilateralTableDef& other) const
+    {
+        return name == other.name && icc == other.icc
+               && apTitle == other.apTitle
+               && aeQualifier == other.aeQualifier && points == other.points;
+    };
+};
+
 class TASE2Config
 {
   public:
@@ -23,10 +124,32 @@ class TASE2Config
     ~TASE2Config ();
 
     void importProtocolConfig (const std::string& protocolConfig);
-    void importExchangeConfig (const std::string& exchangeConfig,
+    /* false when the import stopped early, errors are logged; what was
+     * imported before stays in the model */
+    bool importExchangeConfig (const std::string& exchangeConfig,
                                Tase2_DataModel model);
-    void importModelConfig (const std::string& modelConfig,
+    bool importModelConfig (const std::string& modelConfig,
+                            Tase2_DataModel model);
+
+    /* both build the same model, importModelConfig picks one by size */
+    bool importModelDocument (const std::string& modelConfig,
+                              Tase2_DataModel model);
+    bool importModelStream (const std::string& modelConfig,
                             Tase2_DataModel model);
+
+    /* replays a snapshot written for the configuration with this hash,
+     * false when there is none; on false after a partial replay the
+     * config and the model have to be discarded */
+    bool importModelSnapshot (const std::string& path, uint64_t hash,
+                              Tase2_DataModel model);
+
+    /* records the model changes of the following imports, nullptr to
+     * stop recording */
+    void
+    setModelSnapshot (TASE2ModelSnapshot* snapshot)
+    {
+        m_snapshot = snapshot;
+    };
     void importTlsConfig (const std::string& tlsConfig);
 
     std::string
@@ -67,12 +190,10 @@ class TASE2Config
         return m_useTLS;
     };
 
-    std::unordered_map<
-        std::string,
-        std::unordered_map<std::string, std::shared_ptr<TASE2Datapoint> > >
-    getModelEntries ()
+    const TASE2PointIndex&
+    getPointIndex () const
     {
-        return m_modelEntries;
+        return m_points;
     };
 
     std::vector<Tase2_BilateralTable>&
@@ -81,8 +202,71 @@ class TASE2Config
         return m_bilateral_tables;
     };
 
-    std::shared_ptr<TASE2Datapoint>
-    getDatapointByReference (const std::string& ref, const std::string& name);
+    /* same order as getBilateralTables */
+    const std::vector<TASE2BilateralTableDef>&
+    getBilateralTableDefs () const
+    {
+        return m_bilateralTableDefs;
+    };
+
+    /*
+     * Hash over everything the MMS model of the server is made of: domains,
+     * points with their types and attributes, transfer sets and datasets.
+     * Exchanged data, change filters, rate limits and bilateral tables are
+     * left out, the update* methods below change them in place.
+     */
+    uint64_t
+    getModelShape () const
+    {
+        return m_modelShape;
+    };
+
+    /* the next methods take a configuration with the same model shape,
+     * the first two return the number of changed points */
+
+    /* exchanged definitions, change filters and coalescing */
+    size_t updatePointOptions (const TASE2Config& next);
+
+    /* the buckets are replaced, the caller holds off the command
+     * handlers */
+    size_t updateCommandRateLimits (const TASE2Config& next);
+
+    /* tables of next are created on the model of this configuration; the
+     * removed ones are for the caller to destroy once the server has
+     * dropped them */
+    void updateBilateralTables (const TASE2Config& next,
+                                std::vector<Tase2_BilateralTable>& added,
+                                std::vector<Tase2_BilateralTable>& removed);
+
+    /* points stay owned by the configuration */
+    TASE2Datapoint*
+    findDatapoint (TASE2StringRef ref, TASE2StringRef name) const
+    {
+        return m_points.find (ref, name);
+    };
+
+    /* point of a control point of the model, for the command handlers */
+    TASE2Datapoint*
+    findControlPoint (Tase2_ControlPoint controlPoint) const
+    {
+        auto it = m_controlPoints.find (controlPoint);
+
+        return it == m_controlPoints.end () ? nullptr : it->second;
+    };
+
+    const std::unordered_map<Tase2_ControlPoint, TASE2Datapoint*>&
+    getControlPoints () const
+    {
+        return m_controlPoints;
+    };
+
+    const TASE2AssetEntry*
+    getDatapointByAsset (const std::string& asset) const
+    {
+        auto it = m_assetIndex.find (asset);
+
+        return it == m_assetIndex.end () ? nullptr : &it->second;
+    };
 
     int
     CmdExecTimeout ()
@@ -90,6 +274,39 @@ class TASE2Config
         return m_cmdExecTimeout;
     };
 
+    /* commands handed to the operation callback by a dispatcher thread */
+    bool
+    AsyncCommands ()
+    {
+        return m_asyncCommands;
+    };
+
+    int
+    CommandQueueSize ()
+    {
+        return m_commandQueueSize;
+    };
+
+    /* limit over all control points, and default of each control point */
+    const TASE2RateLimit&
+    GlobalCommandRateLimit () const
+    {
+        return m_globalCommandRateLimit;
+    };
+
+    const TASE2RateLimit&
+    PointCommandRateLimit () const
+    {
+        return m_pointCommandRateLimit;
+    };
+
+    /* seconds a selected control point waits for the operate */
+    int
+    SelectTimeout ()
+    {
+        return m_selectTimeout;
+    };
+
     std::string&
     GetPrivateKey ()
     {
@@ -117,9 +334,135 @@ class TASE2Config
         return m_passive;
     }
 
+    int
+    ReconnectMinInterval ()
+    {
+        return m_reconnectMinInterval;
+    };
+
+    int
+    ReconnectMaxInterval ()
+    {
+        return m_reconnectMaxInterval;
+    };
+
+    bool
+    AsyncIngest ()
+    {
+        return m_asyncIngest;
+    };
+
+    int
+    IngestQueueSize ()
+    {
+        return m_ingestQueueSize;
+    };
+
+    IngestOverflowPolicy
+    IngestOverflow ()
+    {
+        return m_ingestOverflow;
+    };
+
+    bool
+    CoalesceUpdates ()
+    {
+        return m_coalesceUpdates;
+    };
+
+    int
+    CoalesceWindow ()
+    {
+        return m_coalesceWindow;
+    };
+
   private:
+    friend class TASE2ModelReader;
+
     static bool isValidIPAddress (const std::string& addrStr);
 
+    /* one element of model_conf each, shared by the DOM and the streaming
+     * import, false when the import has to stop */
+    void importCommandRateLimits (const rapidjson::Value& rateLimit);
+    Tase2_Domain importDomain (const std::string& name,
+                               Tase2_DataModel model);
+    bool importDatapoint (const rapidjson::Value& datapoint,
+                          const std::string& domainName, Tase2_Domain domain);
+
+    /* validation without changes to the config or the model, safe to run
+     * on several threads; the commit methods add the result in order */
+    TASE2PrepareResult prepareDatapoint (const rapidjson::Value& datapoint,
+                                         TASE2PreparedPoint& point) const;
+    TASE2PrepareResult
+    prepareDatapoints (const rapidjson::Value& datapoint,
+                       std::vector<TASE2PreparedPoint>& points) const;
+    void prepareIcc (const rapidjson::Value& iccValue,
+                     TASE2PreparedIcc& icc) const;
+    bool prepareIccPoint (const rapidjson::Value& datapoint,
+                          TASE2PreparedIcc& icc) const;
+    TASE2Datapoint* commitDatapoint (const std::string& domainName,
+                                     Tase2_Domain domain,
+                                     const TASE2PreparedPoint& point);
+    bool commitIcc (const TASE2PreparedIcc& icc, Tase2_DataModel model);
+    bool importBilateralTable (const rapidjson::Value& bltValue);
+    bool importDSTransferSet (const rapidjson::Value& dts);
+    void importDataset (const rapidjson::Value& ds);
+
+    /* changes to the model once an element is validated, also used to
+     * replay a snapshot; a point with the reference of an existing one is
+     * not added, nullptr */
+    void setCommandRateLimits (const TASE2RateLimit& global,
+                               const TASE2RateLimit& point);
+    TASE2Datapoint* addIndicationPoint (const std::string& domainName,
+                                        Tase2_Domain domain,
+                                        const std::string& name, DPTYPE type,
+                                        bool hasCOV,
+                                        const TASE2IndicationOptions& options);
+    TASE2Datapoint* addControlPoint (const std::string& domainName,
+                                     Tase2_Domain domain,
+                                     const std::string& name, DPTYPE type,
+                                     Tase2_DeviceClass deviceClass,
+                                     bool hasTag, int16_t checkBackId,
+                                     const TASE2RateLimit& limit);
+    Tase2_BilateralTable addBilateralTable (const std::string& name,
+                                            const std::string& iccName,
+                                            Tase2_Domain icc,
+                                            const std::string& apTitle,
+                                            int aeQualifier);
+    void addBilateralTablePoint (Tase2_BilateralTable blt,
+                                 TASE2Datapoint* t2dp);
+    void addDSTransferSet (const std::string& domainName, Tase2_Domain domain,
+                           const std::string& name);
+    Tase2_DataSet addDataset (const std::string& domainName,
+                              Tase2_Domain domain, const std::string& name);
+    void addDatasetEntry (Tase2_DataSet dataSet, Tase2_Domain domain,
+                          const std::string& name);
+    void addExchangedPoint (TASE2Datapoint* t2dp, const std::string& domain,
+                            const std::string& label,
+                            const std::string& pivotId);
+
+    void addToModelShape (const std::string& str);
+    void addToModelShape (int value);
+
+    Tase2_Domain findDomain (bool vcc, const std::string& name) const;
+    TASE2Datapoint* findPoint (uint32_t pointId) const;
+
+    static bool importRateLimit (const rapidjson::Value& value,
+                                 const char* what, TASE2RateLimit& limit);
+    static bool importPointRange (const rapidjson::Value& value,
+                                  TASE2PointRange& range);
+
+    /* adds the names of the points a table or dataset entry refers to,
+     * invalid entries are logged and ignored */
+    void selectDatapoints (const std::string& domain,
+                           const rapidjson::Value& selector,
+                           std::vector<std::string>& names) const;
+    TASE2RateLimit importControlOptions (const rapidjson::Value& datapoint,
+                                         const std::string& label) const;
+    static TASE2IndicationOptions
+    importIndicationOptions (const rapidjson::Value& datapoint,
+                             const std::string& label, DPTYPE type);
+
     std::string m_remoteAP = "";
     std::string m_localAP = "";
 
@@ -129,6 +472,13 @@ class TASE2Config
     std::string m_ip = "";
     int m_tcpPort = -1;
     int m_cmdExecTimeout = 5;
+    int m_selectTimeout = 10;
+
+    TASE2RateLimit m_globalCommandRateLimit = { 0.0, 0.0 };
+    TASE2RateLimit m_pointCommandRateLimit = { 0.0, 0.0 };
+
+    bool m_asyncCommands = false;
+    int m_commandQueueSize = TASE2_COMMAND_QUEUE_DEFAULT_SIZE;
 
     bool m_useTLS = false;
 
@@ -138,13 +488,42 @@ class TASE2Config
 
     bool m_passive = true;
 
+    /* active endpoint, reconnect backoff in ms */
+    int m_reconnectMinInterval = 1000;
+    int m_reconnectMaxInterval = 30000;
+
+    bool m_asyncIngest = false;
+    int m_ingestQueueSize = TASE2_INGEST_DEFAULT_CAPACITY;
+    IngestOverflowPolicy m_ingestOverflow = INGEST_OVERFLOW_BLOCK;
+
+    bool m_coalesceUpdates = false;
+    int m_coalesceWindow = 0;
+
+    TASE2PointIndex m_points;
+
+    /* built with the model, points stay owned by m_points */
+    std::unordered_map<Tase2_ControlPoint, TASE2Datapoint*> m_controlPoints;
+
+    /* built by importExchangeConfig, points stay owned by m_points */
+    std::unordered_map<std::string, TASE2AssetEntry> m_assetIndex;
+
+    std::vector<Tase2_BilateralTable> m_bilateral_tables;
+
+    /* same order as m_bilateral_tables */
+    std::vector<TASE2BilateralTableDef> m_bilateralTableDefs;
+
+    /* points by domain and "tag" of model_conf, used to fill the tables
+     * and datasets; points stay owned by m_points */
     std::unordered_map<
         std::string,
-        std::unordered_map<std::string, std::shared_ptr<TASE2Datapoint> > >
-        m_modelEntries;
+        std::unordered_map<std::string, std::vector<TASE2Datapoint*> > >
+        m_tags;
 
-    std::vector<Tase2_BilateralTable> m_bilateral_tables;
+    uint64_t m_modelShape = TASE2_MODEL_SHAPE_INIT;
     std::unordered_map<std::string, Tase2_Domain> m_domains;
+    Tase2_Domain m_vcc = nullptr;
+
+    TASE2ModelSnapshot* m_snapshot = nullptr;
     std::string m_privateKey;
     std::string m_ownCertificate;
     std::vector<std::string> m_remoteCertificates;
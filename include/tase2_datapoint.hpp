@@ -1,6 +1,7 @@
 #ifndef TASE2_DATAPOINT_H
 #define TASE2_DATAPOINT_H
 
+#include <atomic>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -9,6 +10,9 @@
 #include "datapoint.h"
 #include "libtase2/tase2_common.h"
 #include "libtase2/tase2_model.h"
+#include "tase2_command_params.hpp"
+#include "tase2_latency.hpp"
+#include "tase2_rate_limit.hpp"
 #include "tase2_utility.hpp"
 
 typedef enum
@@ -71,8 +75,8 @@ class TASE2Datapoint
     DPTYPE
     getType () { return m_type; };
 
-    const std::string
-    getLabel ()
+    const std::string&
+    getLabel () const
     {
         return m_label;
     };
@@ -101,40 +105,63 @@ class TASE2Datapoint
         m_dp.ControlPoint = cont;
     };
 
+    /* operation parameters of a control point, built with the model */
+    const TASE2CommandParams*
+    getCommandParams () const
+    {
+        return m_commandParams.get ();
+    };
+
     void
-    setIndicationPoint (Tase2_IndicationPoint ind)
+    createCommandParams (const std::string& domain)
     {
-        m_dp.IndPoint = ind;
-    }
+        m_commandParams.reset (new TASE2CommandParams (
+            domain, m_label, toControlPointType (m_type)));
+    };
 
-    const Tase2_QualityClass
-    getQuality ()
+    /* dense position among the control points of the model */
+    uint32_t
+    getControlIndex () const
     {
-        return m_quality;
+        return m_controlIndex;
     };
 
-    void setQuality (Datapoint* qualityDp);
+    void
+    setControlIndex (uint32_t index)
+    {
+        m_controlIndex = index;
+    };
 
-    const long
-    getIntVal ()
+    /* nullptr when the commands of the point are not rate limited */
+    TASE2TokenBucket*
+    getCommandRate () const
     {
-        return m_intVal;
+        return m_commandRate.get ();
     };
 
-    const float
-    getFloatVal ()
+    void
+    setCommandRateLimit (const TASE2RateLimit& limit)
     {
-        return m_floatVal;
+        m_commandRate.reset (limit.rate > 0.0 ? new TASE2TokenBucket (limit)
+                                              : nullptr);
     };
 
-    const bool
-    hasIntVal ()
+    /* nullptr until a command of the point was recorded */
+    TASE2CommandLatency*
+    getCommandLatency () const
     {
-        return m_hasIntVal;
+        return m_commandLatency.load (std::memory_order_acquire);
     };
 
-    bool updateDatapoint (Datapoint* value, Datapoint* timestamp,
-                          Datapoint* quality);
+    /* the histograms take several kB, they are only allocated for control
+     * points that receive commands. Called by any command thread. */
+    TASE2CommandLatency* createCommandLatency ();
+
+    void
+    setIndicationPoint (Tase2_IndicationPoint ind)
+    {
+        m_dp.IndPoint = ind;
+    }
 
     void
     setCheckBackId (int16_t id)
@@ -148,48 +175,153 @@ class TASE2Datapoint
         return m_checkBackId;
     };
 
+    /* may change on a reconfiguration while the server runs */
     bool
-    inExchangedDefinitions ()
+    inExchangedDefinitions () const
     {
-        return m_inExchangedDefinitions;
+        return m_inExchangedDefinitions.load (std::memory_order_relaxed);
     }
 
     void
     setInExchangedDefinitions (bool value)
     {
-        m_inExchangedDefinitions = value;
+        m_inExchangedDefinitions.store (value, std::memory_order_relaxed);
     }
 
-    bool hasTimedOut (uint64_t currentTime);
+    /* dense position in the point index, see TASE2PointIndex::insert */
+    uint32_t
+    getPointId () const
+    {
+        return m_pointId;
+    };
 
-  private:
-    std::string m_label;
+    void
+    setPointId (uint32_t id)
+    {
+        m_pointId = id;
+    };
+
+    /*
+     * Change filter applied before a value goes to the model. An update is
+     * suppressed when its flags equal the last applied ones and the value
+     * is identical (suppressIdentical) or within the deadband around the
+     * last applied value. The deadband is the larger of the absolute
+     * deadband and deadbandPercent of the last applied value. May change
+     * on a reconfiguration while the publisher thread reads it.
+     */
+    void
+    setChangeFilter (double deadband, double deadbandPercent,
+                     bool suppressIdentical)
+    {
+        m_deadband.store (deadband, std::memory_order_relaxed);
+        m_deadbandPercent.store (deadbandPercent, std::memory_order_relaxed);
+        m_suppressIdentical.store (suppressIdentical,
+                                   std::memory_order_relaxed);
+    };
+
+    bool
+    hasChangeFilter () const
+    {
+        return getSuppressIdentical () || getDeadband () > 0.0
+               || getDeadbandPercent () > 0.0;
+    };
+
+    double
+    getDeadband () const
+    {
+        return m_deadband.load (std::memory_order_relaxed);
+    };
+
+    double
+    getDeadbandPercent () const
+    {
+        return m_deadbandPercent.load (std::memory_order_relaxed);
+    };
+
+    bool
+    getSuppressIdentical () const
+    {
+        return m_suppressIdentical.load (std::memory_order_relaxed);
+    };
+
+    /* returns false when the update is to be suppressed, compared with the
+     * last value passed to commitChange */
+    bool checkChange (long intValue, double floatValue, bool isFloat,
+                      Tase2_DataFlags flags) const;
 
-    bool isTransient;
+    /* keeps the value of an update that was applied to the model, updates
+     * dropped between the check and the model never become the reference */
+    void commitChange (long intValue, double floatValue, bool isFloat,
+                       Tase2_DataFlags flags);
+
+    /* COV/SOE points report every value, they are never coalesced */
+    bool
+    isCoalesceExempt () const
+    {
+        return m_coalesceExempt.load (std::memory_order_relaxed);
+    };
+
+    void
+    setCoalesceExempt (bool value)
+    {
+        m_coalesceExempt.store (value, std::memory_order_relaxed);
+    };
 
-    long m_intVal;
-    float m_floatVal;
+    /* number of commands on this control point waiting for confirmation,
+     * read without lock by the send path */
+    bool
+    hasOutstandingCommands () const
+    {
+        return m_outstandingCommands.load (std::memory_order_acquire) > 0;
+    }
 
-    bool m_inExchangedDefinitions = false;
+    void
+    addOutstandingCommand ()
+    {
+        m_outstandingCommands.fetch_add (1, std::memory_order_release);
+    }
 
-    bool m_hasIntVal;
+    void
+    removeOutstandingCommand ()
+    {
+        m_outstandingCommands.fetch_sub (1, std::memory_order_release);
+    }
 
+  private:
+    /* fields of the send path first, points are stored next to each
+     * other by TASE2PointIndex */
     using dp = union
     {
         Tase2_IndicationPoint IndPoint;
         Tase2_ControlPoint ControlPoint;
     };
 
-    uint64_t m_nextTimeout = 0;
-
     dp m_dp;
+    DPTYPE m_type;
+    uint32_t m_pointId = 0;
 
-    int16_t m_checkBackId;
+    /* last applied value, a float value of a Real point as stored by the
+     * model. Checked by the north task, committed by the publisher */
+    std::atomic<double> m_lastValue{ 0.0 };
+    std::atomic<Tase2_DataFlags> m_flags{ 0 };
+    std::atomic<bool> m_hasValue{ false };
 
-    Tase2_QualityClass m_quality;
-    Tase2_TimeStampClass m_timestamp;
+    std::atomic<bool> m_suppressIdentical{ false };
+    std::atomic<bool> m_coalesceExempt{ false };
+    std::atomic<bool> m_inExchangedDefinitions{ false };
 
-    DPTYPE m_type;
+    std::atomic<double> m_deadband{ 0.0 };
+    std::atomic<double> m_deadbandPercent{ 0.0 };
+
+    std::atomic<int> m_outstandingCommands{ 0 };
+    uint32_t m_controlIndex = 0;
+    int16_t m_checkBackId = 0;
+
+    std::string m_label;
+
+    std::unique_ptr<TASE2CommandParams> m_commandParams;
+    std::atomic<TASE2CommandLatency*> m_commandLatency{ nullptr };
+    std::unique_ptr<TASE2TokenBucket> m_commandRate;
 };
 
 #endif
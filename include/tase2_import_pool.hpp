@@ -0,0 +1,53 @@
+#ifndef TASE2_IMPORT_POOL_H
+#define TASE2_IMPORT_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* upper bound of the threads preparing one model import */
+#define TASE2_IMPORT_MAX_THREADS 8
+
+/*
+ * Threads preparing the ICCs of a model import, one task per ICC. The
+ * tasks only read the configuration, the model is changed by the thread
+ * that created the pool. Without threads the tasks run in submit.
+ */
+class TASE2ImportPool
+{
+  public:
+    explicit TASE2ImportPool (size_t threads);
+    ~TASE2ImportPool ();
+
+    TASE2ImportPool (const TASE2ImportPool&) = delete;
+    TASE2ImportPool& operator= (const TASE2ImportPool&) = delete;
+
+    /* threads worth starting for this many tasks, 0 to run them inline */
+    static size_t threadsFor (size_t tasks);
+
+    void submit (std::function<void ()> task);
+
+    /* returns once every submitted task has run */
+    void wait ();
+
+  private:
+    void run ();
+
+    std::vector<std::thread> m_threads;
+
+    std::deque<std::function<void ()> > m_tasks;
+
+    /* queued and running tasks */
+    size_t m_pending = 0;
+    bool m_closed = false;
+
+    std::mutex m_lock;
+    std::condition_variable m_taskCond;
+    std::condition_variable m_doneCond;
+};
+
+#endif
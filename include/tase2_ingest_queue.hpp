@@ -0,0 +1,145 @@
+#ifndef TASE2_INGEST_QUEUE_H
+#define TASE2_INGEST_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tase2_datapoint.hpp"
+
+#define TASE2_INGEST_DEFAULT_CAPACITY 4096
+
+/*
+ * Decoded and validated update of one indication point, applied to the
+ * model by TASE2Server::applyUpdate.
+ */
+struct TASE2PointUpdate
+{
+    TASE2Datapoint* point;
+    DPTYPE type;
+    long intValue;
+    double floatValue;
+    Tase2_DataFlags dataFlags;
+    uint64_t timestamp;
+};
+
+/* what push does when the ring is full */
+typedef enum
+{
+    INGEST_OVERFLOW_BLOCK,       /* wait for the publisher */
+    INGEST_OVERFLOW_DROP_OLDEST, /* discard the oldest queued update */
+    INGEST_OVERFLOW_COALESCE,    /* keep the latest update per point aside */
+    INGEST_OVERFLOW_UNKNOWN = -1
+} IngestOverflowPolicy;
+
+struct TASE2IngestStats
+{
+    size_t capacity;
+    size_t occupancy;
+    size_t highWatermark;
+    uint64_t pushed;
+    uint64_t published;
+    uint64_t dropped;
+    uint64_t coalesced;
+    uint64_t blocked;
+};
+
+/*
+ * Bounded ring between the north task thread (single producer) and the
+ * publisher thread. Each slot carries a sequence number, so the producer
+ * can also take the oldest entry out itself for INGEST_OVERFLOW_DROP_OLDEST
+ * without locking. The mutex is only used to park a waiting thread and for
+ * the coalescing overflow area.
+ */
+class TASE2IngestQueue
+{
+  public:
+    TASE2IngestQueue (size_t capacity, IngestOverflowPolicy policy);
+    ~TASE2IngestQueue () = default;
+
+    static IngestOverflowPolicy
+    getPolicyFromString (const std::string& policy);
+
+    /* producer side, returns false once the queue is closed */
+    bool push (const TASE2PointUpdate& update);
+
+    /*
+     * Consumer side. Appends up to maxCount queued updates to batch, waits
+     * up to timeoutMs when the queue is empty. Returns the number of
+     * updates appended.
+     */
+    size_t pop (std::vector<TASE2PointUpdate>& batch, size_t maxCount,
+                int timeoutMs);
+
+    /* wakes up both sides, pop still returns what is left */
+    void close ();
+
+    bool
+    isClosed () const
+    {
+        return m_closed.load (std::memory_order_acquire);
+    };
+
+    size_t
+    capacity () const
+    {
+        return m_mask + 1;
+    };
+
+    size_t size () const;
+
+    TASE2IngestStats getStats () const;
+
+  private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        TASE2PointUpdate update;
+    };
+
+    bool tryPush (const TASE2PointUpdate& update);
+    bool tryPop (TASE2PointUpdate& update);
+
+    void coalesce (const TASE2PointUpdate& update);
+    void wakeUp (std::atomic<bool>& waiting);
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+
+    IngestOverflowPolicy m_policy;
+
+    /* next position to write, only changed by the producer */
+    std::atomic<size_t> m_tail{ 0 };
+    /* keeps the two positions on separate cache lines */
+    char m_padding[64];
+    /* next position to read, claimed by compare and swap */
+    std::atomic<size_t> m_head{ 0 };
+
+    std::atomic<bool> m_closed{ false };
+
+    std::mutex m_waitLock;
+    std::condition_variable m_waitCondition;
+    std::atomic<bool> m_consumerWaiting{ false };
+    std::atomic<bool> m_producerWaiting{ false };
+
+    /* INGEST_OVERFLOW_COALESCE: latest update per point, in arrival order */
+    std::mutex m_overflowLock;
+    std::vector<TASE2PointUpdate> m_overflow;
+    std::unordered_map<TASE2Datapoint*, size_t> m_overflowIndex;
+    std::atomic<bool> m_overflowPending{ false };
+
+    std::atomic<size_t> m_highWatermark{ 0 };
+    std::atomic<uint64_t> m_pushed{ 0 };
+    std::atomic<uint64_t> m_published{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+    std::atomic<uint64_t> m_coalesced{ 0 };
+    std::atomic<uint64_t> m_blocked{ 0 };
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef TASE2_LATENCY_H
+#define TASE2_LATENCY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/* sub-buckets per power of two, relative precision of 1/16 */
+#define TASE2_LATENCY_SUB_BUCKET_BITS 4
+
+/* values are clamped to 2^36 us, about 19 hours */
+#define TASE2_LATENCY_MAX_EXPONENT 36
+
+/*
+ * HDR style latency histogram in us. Values below 16 have a bucket of
+ * their own, above that every power of two is split into 16 buckets, so
+ * a percentile is reported within 6.25% of the recorded value. Recording
+ * is wait free and may happen from any thread.
+ */
+class TASE2LatencyHistogram
+{
+  public:
+    static const size_t SUB_BUCKETS = 1 << TASE2_LATENCY_SUB_BUCKET_BITS;
+    static const size_t BUCKETS
+        = (TASE2_LATENCY_MAX_EXPONENT - TASE2_LATENCY_SUB_BUCKET_BITS + 1)
+          * SUB_BUCKETS;
+
+    TASE2LatencyHistogram ();
+    ~TASE2LatencyHistogram () = default;
+
+    TASE2LatencyHistogram (const TASE2LatencyHistogram&) = delete;
+    TASE2LatencyHistogram& operator= (const TASE2LatencyHistogram&) = delete;
+
+    void record (uint64_t valueUs);
+
+    uint64_t
+    count () const
+    {
+        return m_count.load (std::memory_order_relaxed);
+    };
+
+    uint64_t
+    max () const
+    {
+        return m_max.load (std::memory_order_relaxed);
+    };
+
+    double mean () const;
+
+    /* upper bound of the bucket holding the given percentile (0-100),
+     * 0 when nothing was recorded */
+    uint64_t percentile (double percent) const;
+
+    static size_t bucketIndex (uint64_t valueUs);
+    static uint64_t bucketUpperBound (size_t index);
+
+  private:
+    std::atomic<uint64_t> m_buckets[BUCKETS];
+
+    std::atomic<uint64_t> m_count{ 0 };
+    std::atomic<uint64_t> m_sum{ 0 };
+    std::atomic<uint64_t> m_max{ 0 };
+};
+
+/*
+ * Latencies of the commands of a control point or a control point type,
+ * all measured from the receipt of the select or operate request.
+ */
+struct TASE2CommandLatency
+{
+    /* until the command was handed over by the operation callback */
+    TASE2LatencyHistogram dispatch;
+
+    /* until the ACT-CON was received from the south side */
+    TASE2LatencyHistogram confirm;
+
+    std::atomic<uint64_t> timeouts{ 0 };
+
+    /* rejected by the command rate limits */
+    std::atomic<uint64_t> throttled{ 0 };
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef TASE2_MODEL_READER_H
+#define TASE2_MODEL_READER_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "rapidjson/reader.h"
+#include "tase2_config.hpp"
+#include "tase2_import_pool.hpp"
+
+#include <libtase2/tase2_server.h>
+
+/* model configurations from this size on are imported without a DOM */
+#define TASE2_MODEL_STREAM_THRESHOLD (1024 * 1024)
+
+enum TASE2ModelElement
+{
+    MODEL_ELEMENT_NONE,
+    MODEL_ELEMENT_RATE_LIMIT,
+    MODEL_ELEMENT_VCC_POINT,
+    MODEL_ELEMENT_ICC_POINT,
+    MODEL_ELEMENT_BLT,
+    MODEL_ELEMENT_DTS,
+    MODEL_ELEMENT_DATASET
+};
+
+/* element of model_conf, as offsets in the configuration text; an ICC
+ * point span of MODEL_ELEMENT_NONE stands for an invalid datapoint */
+struct TASE2ModelSpan
+{
+    TASE2ModelElement element;
+    size_t begin;
+    size_t end;
+};
+
+/* ICC read by the reader, its points are prepared by an import thread */
+struct TASE2StreamIcc
+{
+    std::vector<TASE2ModelSpan> points;
+    TASE2PreparedIcc prepared;
+    std::atomic<bool> done{ false };
+};
+
+/*
+ * Streaming import of model_conf. The rapidjson reader walks the
+ * configuration once and each datapoint, bilateral table, dataset transfer
+ * set and dataset is imported as soon as its closing brace is read, so
+ * only one element at a time is held as a DOM.
+ *
+ * The points of an ICC are kept as spans until the ICC ends, then parsed
+ * and validated by the import threads while the reader goes on; the ICCs
+ * are added to the model in order at the end of the icc array. Tables and
+ * datasets that come before the ICCs wait for them as spans.
+ */
+class TASE2ModelReader
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, TASE2ModelReader>
+{
+  public:
+    TASE2ModelReader (TASE2Config& config, const std::string& modelConfig,
+                      Tase2_DataModel model);
+
+    /* false when the configuration is invalid, errors are logged */
+    bool parse ();
+
+    /* rapidjson handler */
+    bool Default ();
+    bool String (const char* str, rapidjson::SizeType length, bool copy);
+    bool StartObject ();
+    bool Key (const char* str, rapidjson::SizeType length, bool copy);
+    bool EndObject (rapidjson::SizeType memberCount);
+    bool StartArray ();
+    bool EndArray (rapidjson::SizeType elementCount);
+
+  private:
+    static TASE2ModelElement elementAt (const std::string& path);
+
+    bool invalidElement (TASE2ModelElement element);
+    bool importElement (const TASE2ModelSpan& span);
+    bool importPending (std::vector<TASE2ModelSpan>& spans);
+
+    bool beginIcc (const char* name, size_t length);
+    bool endIcc ();
+    void prepareIcc (TASE2StreamIcc& icc);
+    bool commitIccs (bool wait);
+    bool endModelConf ();
+
+    TASE2Config& m_config;
+    const std::string& m_modelConfig;
+    Tase2_DataModel m_model;
+
+    rapidjson::StringStream m_stream;
+
+    /* "/model_conf/icc/[]/datapoints/[]" style path of the next value,
+     * with the length of the path of each open object or array */
+    std::string m_path;
+    std::vector<size_t> m_frames;
+
+    /* object being skipped by the reader until it can be imported */
+    TASE2ModelElement m_element = MODEL_ELEMENT_NONE;
+    size_t m_elementBegin = 0;
+    int m_elementDepth = 0;
+
+    unsigned m_sections = 0;
+
+    Tase2_Domain m_vcc;
+
+    /* ICC being read */
+    bool m_iccHasName = false;
+    std::string m_iccName;
+    std::vector<TASE2ModelSpan> m_iccPoints;
+
+    /* ICCs of the icc array read so far, the pool is destroyed first as
+     * its tasks refer to them */
+    std::deque<TASE2StreamIcc> m_iccs;
+    std::unique_ptr<TASE2ImportPool> m_pool;
+
+    /* tables and datasets wait for the end of the icc array */
+    bool m_iccComplete = false;
+    std::vector<TASE2ModelSpan> m_deferred;
+};
+
+#endif
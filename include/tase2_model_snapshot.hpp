@@ -0,0 +1,168 @@
+#ifndef TASE2_MODEL_SNAPSHOT_H
+#define TASE2_MODEL_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "libtase2/tase2_model.h"
+#include "tase2_datapoint.hpp"
+#include "tase2_rate_limit.hpp"
+
+#define TASE2_SNAPSHOT_VERSION 2
+
+/*
+ * Record of a snapshot, one per change TASE2Config made to the model while
+ * importing model_conf and exchanged_data. Points are referred to by point
+ * id, tables and dataset entries apply to the last table or dataset.
+ */
+enum TASE2SnapshotRecord
+{
+    SNAPSHOT_RATE_LIMITS = 1,
+    SNAPSHOT_DOMAIN,
+    SNAPSHOT_INDICATION,
+    SNAPSHOT_CONTROL,
+    SNAPSHOT_BLT,
+    SNAPSHOT_BLT_POINT,
+    SNAPSHOT_DSTS,
+    SNAPSHOT_DATASET,
+    SNAPSHOT_DATASET_ENTRY,
+    SNAPSHOT_EXCHANGE
+};
+
+/* options of an indication point, as resolved from its configuration */
+struct TASE2IndicationOptions
+{
+    bool coalesceExempt;
+    double deadband;
+    double deadbandPercent;
+    bool suppressIdentical;
+};
+
+/*
+ * Compiled form of the model. Written once the JSON configuration has been
+ * imported, then memory mapped and replayed on the next start with the
+ * same configuration, without parsing or validating it again.
+ *
+ * The file is only meant for the host and the build that wrote it: values
+ * are stored in host byte order, strings with their terminating nul so
+ * they are used in place. The key includes the plugin version and build,
+ * the header the byte order, anything else is rejected by open.
+ */
+class TASE2ModelSnapshot
+{
+  public:
+    explicit TASE2ModelSnapshot (uint64_t hash) : m_hash (hash) {}
+    ~TASE2ModelSnapshot () = default;
+
+    TASE2ModelSnapshot (const TASE2ModelSnapshot&) = delete;
+    TASE2ModelSnapshot& operator= (const TASE2ModelSnapshot&) = delete;
+
+    /* key of a snapshot, over everything the model is built from and the
+     * build of the plugin */
+    static uint64_t hash (const std::string& modelConfig,
+                          const std::string& exchangeConfig);
+
+    void addRateLimits (const TASE2RateLimit& global,
+                        const TASE2RateLimit& point);
+    void addDomain (const std::string& name);
+    void addIndicationPoint (bool vcc, const std::string& domain,
+                             const std::string& name, DPTYPE type,
+                             bool hasCOV,
+                             const TASE2IndicationOptions& options);
+    void addControlPoint (bool vcc, const std::string& domain,
+                          const std::string& name, DPTYPE type,
+                          Tase2_DeviceClass deviceClass, bool hasTag,
+                          int16_t checkBackId, const TASE2RateLimit& limit);
+    void addBilateralTable (const std::string& name, const std::string& icc,
+                            const std::string& apTitle, int aeQualifier);
+    void addBilateralTablePoint (uint32_t pointId);
+    void addDSTransferSet (const std::string& domain,
+                           const std::string& name);
+    void addDataset (const std::string& domain, const std::string& name);
+    void addDatasetEntry (const std::string& name);
+    void addExchangedPoint (uint32_t pointId, const std::string& domain,
+                            const std::string& label,
+                            const std::string& pivotId);
+
+    size_t
+    size () const
+    {
+        return m_records.size ();
+    };
+
+    /* replaces the file at path, false on I/O errors */
+    bool save (const std::string& path) const;
+
+    /* removes the file at path, a missing file is not an error */
+    static bool remove (const std::string& path);
+
+  private:
+    void put (const void* data, size_t size);
+    void putString (const std::string& str);
+
+    template <typename T>
+    void
+    put (T value)
+    {
+        put (&value, sizeof (value));
+    };
+
+    uint64_t m_hash;
+    std::string m_records;
+};
+
+/* memory mapped snapshot, records are read in order */
+class TASE2SnapshotReader
+{
+  public:
+    TASE2SnapshotReader () = default;
+    ~TASE2SnapshotReader ();
+
+    TASE2SnapshotReader (const TASE2SnapshotReader&) = delete;
+    TASE2SnapshotReader& operator= (const TASE2SnapshotReader&) = delete;
+
+    /* false when there is no snapshot for hash or it is damaged */
+    bool open (const std::string& path, uint64_t hash);
+
+    /* type of the next record, false at the end or after an error */
+    bool next (TASE2SnapshotRecord& record);
+
+    uint8_t getU8 ();
+    int16_t getI16 ();
+    int32_t getI32 ();
+    uint32_t getU32 ();
+    double getDouble ();
+
+    /* points into the mapping, valid until the reader is destroyed */
+    const char* getString ();
+
+    /* no read went past a record */
+    bool
+    ok () const
+    {
+        return !m_error;
+    };
+
+  private:
+    void unmap ();
+    void get (void* data, size_t size);
+
+    template <typename T>
+    T
+    get ()
+    {
+        T value = T ();
+        get (&value, sizeof (value));
+        return value;
+    };
+
+    void* m_mapping = nullptr;
+    size_t m_mappingSize = 0;
+
+    const char* m_pos = nullptr;
+    const char* m_end = nullptr;
+    bool m_error = false;
+};
+
+#endif
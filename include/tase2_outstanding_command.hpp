@@ -0,0 +1,206 @@
+#ifndef TASE2_OUTSTANDING_COMMAND_H
+#define TASE2_OUTSTANDING_COMMAND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "libtase2/tase2_model.h"
+#include "tase2_datapoint.hpp"
+
+typedef enum
+{
+    COMMAND_IDLE,
+    COMMAND_SELECTED,
+    COMMAND_OPERATING,
+    COMMAND_CONFIRMED
+} CommandState;
+
+/*
+ * Select-before-operate state of one control point:
+ *
+ *   IDLE/CONFIRMED --select--> SELECTED --operate--> OPERATING
+ *   IDLE/CONFIRMED ----------operate---------------> OPERATING
+ *   OPERATING --ACT-CON--> CONFIRMED
+ *   SELECTED/OPERATING --timeout or cancel--> IDLE
+ *
+ * A select is only accepted by an idle point, an operate by any point not
+ * already operating. An ACT-CON in SELECTED confirms the select and keeps
+ * the point selected until the operate or the select timeout.
+ *
+ * Every transition into SELECTED or OPERATING gets a new id, a timeout
+ * only applies while the id it was armed with is still current.
+ */
+class TASE2OutstandingCommand
+{
+  public:
+    TASE2OutstandingCommand () = default;
+    ~TASE2OutstandingCommand () = default;
+
+    /* now and the deadlines are monotonic times in ms, receivedUs is the
+     * monotonic time in us the request was received by the handler */
+    bool select (uint64_t id, uint64_t now, int selectTimeout,
+                 uint64_t receivedUs);
+    bool operate (uint64_t id, uint64_t now, int cmdExecTimeout,
+                  uint64_t receivedUs);
+
+    /* false when nothing is waiting for a confirmation */
+    bool confirm ();
+
+    /* false when the command armed with id is no longer in progress */
+    bool expire (uint64_t id);
+
+    void cancel ();
+
+    bool
+    isActive () const
+    {
+        return m_state == COMMAND_SELECTED || m_state == COMMAND_OPERATING;
+    };
+
+    /* whether select or operate would accept a request now */
+    bool
+    canSelect () const
+    {
+        return !isActive ();
+    };
+
+    bool
+    canOperate () const
+    {
+        return m_state != COMMAND_OPERATING;
+    };
+
+    CommandState
+    State () const
+    {
+        return m_state;
+    };
+
+    TASE2Datapoint*
+    ControlPoint () const
+    {
+        return m_controlPoint;
+    };
+
+    uint64_t
+    Id () const
+    {
+        return m_id;
+    };
+
+    uint64_t
+    Deadline () const
+    {
+        return m_deadline;
+    };
+
+    uint64_t
+    ReceivedUs () const
+    {
+        return m_receivedUs;
+    };
+
+    bool
+    isSelect () const
+    {
+        return m_state == COMMAND_SELECTED;
+    };
+
+  private:
+    friend class TASE2OutstandingCommands;
+
+    TASE2Datapoint* m_controlPoint = nullptr;
+
+    CommandState m_state = COMMAND_IDLE;
+    bool m_selectConfirmed = false;
+
+    uint64_t m_id = 0;
+    uint64_t m_deadline = 0;
+    uint64_t m_receivedUs = 0;
+};
+
+/*
+ * One TASE2OutstandingCommand slot per control point of the model, at the
+ * control index of the point. Transitions go through the table, which
+ * counts the points with a command in progress and keeps the lock free
+ * flag of the points up to date. Not thread safe, the server serializes
+ * all calls with its outstanding commands lock.
+ */
+class TASE2OutstandingCommands
+{
+  public:
+    TASE2OutstandingCommands () = default;
+    ~TASE2OutstandingCommands () = default;
+
+    void init (const std::unordered_map<Tase2_ControlPoint, TASE2Datapoint*>&
+                   controlPoints);
+
+    /* nullptr for points that are not a control point of the model */
+    TASE2OutstandingCommand*
+    get (TASE2Datapoint* controlPoint)
+    {
+        size_t index = controlPoint->getControlIndex ();
+
+        if (index < m_slots.size ()
+            && m_slots[index].m_controlPoint == controlPoint)
+        {
+            return &m_slots[index];
+        }
+
+        return nullptr;
+    };
+
+    bool select (TASE2OutstandingCommand& command, uint64_t now,
+                 int selectTimeout, uint64_t receivedUs);
+    bool operate (TASE2OutstandingCommand& command, uint64_t now,
+                  int cmdExecTimeout, uint64_t receivedUs);
+    bool confirm (TASE2OutstandingCommand& command);
+    bool expire (TASE2OutstandingCommand& command, uint64_t id);
+    void cancel (TASE2OutstandingCommand& command);
+
+    /* cancels all commands in progress */
+    void clear ();
+
+    /* number of control points with a command in progress */
+    size_t
+    size () const
+    {
+        return m_active;
+    };
+
+    bool
+    empty () const
+    {
+        return m_active == 0;
+    };
+
+  private:
+    void track (TASE2OutstandingCommand& command, bool wasActive);
+
+    std::vector<TASE2OutstandingCommand> m_slots;
+
+    size_t m_active = 0;
+    uint64_t m_nextId = 0;
+};
+
+/*
+ * Entry of the command timeout heap. Entries of commands that completed
+ * in the meantime stay in the heap and are skipped when they come up,
+ * the id tells them apart from a newer command on the point.
+ */
+struct TASE2CommandTimeout
+{
+    uint64_t deadline;
+    uint64_t id;
+    TASE2Datapoint* controlPoint;
+
+    bool
+    operator> (const TASE2CommandTimeout& other) const
+    {
+        return deadline > other.deadline;
+    }
+};
+
+#endif
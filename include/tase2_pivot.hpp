@@ -0,0 +1,106 @@
+#ifndef TASE2_PIVOT_H
+#define TASE2_PIVOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "datapoint.h"
+#include "libtase2/tase2_common.h"
+#include "tase2_datapoint.hpp"
+
+/* TASE.2 object names are MMS identifiers (max. 32 characters). The buffers
+ * leave some headroom, longer names are rejected by the decoder. */
+#define TASE2_PIVOT_MAX_ID_LENGTH 64
+
+typedef enum
+{
+    PIVOT_ATTR_UNKNOWN,
+    PIVOT_ATTR_DOMAIN,
+    PIVOT_ATTR_NAME,
+    PIVOT_ATTR_TYPE,
+    PIVOT_ATTR_VALUE,
+    PIVOT_ATTR_VALIDITY,
+    PIVOT_ATTR_CS,
+    PIVOT_ATTR_NORMAL_VALUE,
+    PIVOT_ATTR_TS,
+    PIVOT_ATTR_TS_VALIDITY
+} PivotAttribute;
+
+typedef enum
+{
+    PIVOT_VALUE_NONE,
+    PIVOT_VALUE_INTEGER,
+    PIVOT_VALUE_FLOAT,
+    PIVOT_VALUE_OTHER
+} PivotValueKind;
+
+/*
+ * Flat result of decoding one pivot "data_object". Plain data only, so it
+ * can live on the stack of the send path.
+ */
+struct TASE2PivotRecord
+{
+    char domain[TASE2_PIVOT_MAX_ID_LENGTH + 1];
+    char name[TASE2_PIVOT_MAX_ID_LENGTH + 1];
+
+    int type;
+
+    PivotValueKind valueKind;
+    long intValue;
+    double floatValue;
+
+    Tase2_DataFlags dataFlags;
+
+    bool hasTs;
+    uint64_t timestamp;
+    bool tsValid;
+};
+
+static_assert (std::is_pod<TASE2PivotRecord>::value,
+               "TASE2PivotRecord has to stay a POD type");
+
+class TASE2PivotDecoder
+{
+  public:
+    /*
+     * Decode the attributes of a pivot "data_object" datapoint into record.
+     * Returns false when the object is not a dictionary or one of the
+     * identifiers does not fit into the record. Without identifiers the
+     * domain, name and type are skipped, for objects whose point is known
+     * from the asset name. Does not allocate, apart from the copies made
+     * by Datapoint::getName, which returns the attribute name by value.
+     */
+    static bool decode (Datapoint* dataObject, TASE2PivotRecord& record,
+                        bool identifiers = true);
+
+    static PivotAttribute getAttribute (const std::string& name);
+
+    static Tase2_DataFlags getValidityFlags (const std::string& validity);
+
+    static Tase2_DataFlags
+    getCurrentSourceFlags (const std::string& currentSource);
+
+    /*
+     * Key used by the attribute and enum switches. Evaluated at compile time
+     * for the case labels, so a collision between two known names is a
+     * duplicate case label and fails the build.
+     */
+    static constexpr uint32_t
+    hash (const char* s, size_t len, size_t pos)
+    {
+        return len > pos ? (static_cast<uint32_t> (len) << 8)
+                               ^ static_cast<uint8_t> (s[pos])
+                         : static_cast<uint32_t> (len) << 8;
+    }
+
+    template <size_t N>
+    static constexpr uint32_t
+    key (const char (&s)[N], size_t pos)
+    {
+        return hash (s, N - 1, pos);
+    }
+};
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef TASE2_POINT_INDEX_H
+#define TASE2_POINT_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "tase2_datapoint.hpp"
+
+/*
+ * Non-owning reference to a character sequence, used for lookups without
+ * building a std::string key.
+ */
+struct TASE2StringRef
+{
+    TASE2StringRef (const char* str) : data (str), size (strlen (str)) {}
+
+    TASE2StringRef (const std::string& str)
+        : data (str.data ()), size (str.size ())
+    {
+    }
+
+    TASE2StringRef (const char* str, size_t len) : data (str), size (len) {}
+
+    bool
+    operator== (const std::string& other) const
+    {
+        return size == other.size ()
+               && memcmp (data, other.data (), size) == 0;
+    }
+
+    const char* data;
+    size_t size;
+};
+
+/* points per chunk of the point store */
+#define TASE2_POINT_CHUNK 1024
+
+/*
+ * Dense store of all model points, addressed by point id and indexed by
+ * (domain, name). The points are constructed in place in fixed chunks, so
+ * they need no allocation of their own and keep their address as the store
+ * grows. The name of a point is only held by the point, domains are
+ * interned and referred to by id.
+ *
+ * One open addressing table for all domains, so a lookup costs one hash
+ * over the two keys and does not depend on how many points a domain holds.
+ */
+class TASE2PointIndex
+{
+  public:
+    TASE2PointIndex () = default;
+    ~TASE2PointIndex ();
+
+    TASE2PointIndex (const TASE2PointIndex&) = delete;
+    TASE2PointIndex& operator= (const TASE2PointIndex&) = delete;
+
+    void clear ();
+
+    void reserve (size_t count);
+
+    /* creates a point, its point id is its position in the store;
+     * nullptr when there is a point with this reference already */
+    TASE2Datapoint* insert (const std::string& domain,
+                            const std::string& name, DPTYPE type);
+
+    TASE2Datapoint* find (TASE2StringRef domain, TASE2StringRef name) const;
+
+    /* slots a find of this reference looks at, 0 while the index is empty */
+    size_t probes (TASE2StringRef domain, TASE2StringRef name) const;
+
+    bool hasDomain (TASE2StringRef domain) const;
+
+    size_t
+    size () const
+    {
+        return m_hashes.size ();
+    };
+
+    /* chunks of TASE2_POINT_CHUNK points allocated so far */
+    size_t
+    chunks () const
+    {
+        return m_chunks.size ();
+    };
+
+    /* pointId < size () */
+    TASE2Datapoint*
+    point (uint32_t pointId) const
+    {
+        PointStorage* chunk = m_chunks[pointId / TASE2_POINT_CHUNK].get ();
+
+        return reinterpret_cast<TASE2Datapoint*> (
+            &chunk[pointId % TASE2_POINT_CHUNK]);
+    };
+
+    const std::string&
+    domain (uint32_t pointId) const
+    {
+        return m_domainNames[m_domainIds[pointId]];
+    };
+
+  private:
+    typedef std::aligned_storage<sizeof (TASE2Datapoint),
+                                 alignof (TASE2Datapoint)>::type PointStorage;
+
+    static uint64_t hash (TASE2StringRef domain, TASE2StringRef name);
+
+    size_t findSlot (TASE2StringRef domain, TASE2StringRef name,
+                     uint64_t hash, size_t* probes = nullptr) const;
+
+    void rehash (size_t slotCount);
+
+    uint32_t internDomain (const std::string& domain);
+
+    /* one entry per point id */
+    std::vector<uint64_t> m_hashes;
+    std::vector<uint32_t> m_domainIds;
+    std::vector<std::unique_ptr<PointStorage[]> > m_chunks;
+
+    /* point id + 1, 0 marks an empty slot; size is a power of two */
+    std::vector<uint32_t> m_slots;
+
+    std::vector<std::string> m_domainNames;
+};
+
+#endif
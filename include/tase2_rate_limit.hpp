@@ -0,0 +1,53 @@
+#ifndef TASE2_RATE_LIMIT_H
+#define TASE2_RATE_LIMIT_H
+
+#include <cstdint>
+
+/* rate in commands per second, 0 for no limit; burst in commands */
+struct TASE2RateLimit
+{
+    double rate;
+    double burst;
+};
+
+/*
+ * Token bucket holding up to burst tokens, refilled at rate tokens per
+ * second. Not thread safe, the server takes the buckets under its
+ * outstanding commands lock.
+ */
+class TASE2TokenBucket
+{
+  public:
+    TASE2TokenBucket () = default;
+    explicit TASE2TokenBucket (const TASE2RateLimit& limit);
+    ~TASE2TokenBucket () = default;
+
+    void configure (const TASE2RateLimit& limit);
+
+    bool
+    isLimited () const
+    {
+        return m_rate > 0.0;
+    };
+
+    /* limit as applied, with the burst raised to at least one command */
+    TASE2RateLimit
+    getLimit () const
+    {
+        return { m_rate, m_burst };
+    };
+
+    /* refills the bucket, true when a token can be taken */
+    bool refill (uint64_t nowUs);
+
+    void take ();
+
+  private:
+    double m_rate = 0.0;
+    double m_burst = 0.0;
+    double m_tokens = 0.0;
+
+    uint64_t m_lastUs = 0;
+};
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef TASE2_UPDATE_TRAITS_H
+#define TASE2_UPDATE_TRAITS_H
+
+#include "libtase2/tase2_common.h"
+#include "libtase2/tase2_model.h"
+#include "tase2_datapoint.hpp"
+#include "tase2_ingest_queue.hpp"
+#include "tase2_pivot.hpp"
+
+/*
+ * Sets the value of an indication point, one specialization per
+ * indication point type and quality/timestamp combination.
+ */
+template <Tase2_IndicationPointType IndType, bool HasQuality,
+          bool HasTimestamp>
+struct TASE2IndicationSetter;
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_REAL, false, false>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setReal (ip, (float)update.floatValue);
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_REAL, true, false>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setRealQ (ip, (float)update.floatValue,
+                                        update.dataFlags);
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_REAL, true, true>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setRealQTimeStamp (
+            ip, (float)update.floatValue, update.dataFlags, update.timestamp);
+    }
+};
+
+/* State points carry the quality flags in the state value */
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_STATE, false, false>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setState (
+            ip, static_cast<Tase2_DataState> (update.intValue));
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_STATE, true, false>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setState (
+            ip,
+            static_cast<Tase2_DataState> (update.intValue | update.dataFlags));
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_STATE, true, true>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setStateTimeStamp (
+            ip,
+            static_cast<Tase2_DataState> (update.intValue | update.dataFlags),
+            update.timestamp);
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_DISCRETE, false, false>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setDiscrete (ip, update.intValue);
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_DISCRETE, true, false>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setDiscreteQ (ip, update.intValue,
+                                            update.dataFlags);
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_DISCRETE, true, true>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setDiscreteQTimeStamp (
+            ip, update.intValue, update.dataFlags, update.timestamp);
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_STATE_SUPPLEMENTAL, false,
+                             false>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setStateSupplemental (
+            ip, static_cast<Tase2_DataStateSupplemental> (update.intValue));
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_STATE_SUPPLEMENTAL, true,
+                             false>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setStateSupplementalQ (
+            ip, static_cast<Tase2_DataStateSupplemental> (update.intValue),
+            update.dataFlags);
+    }
+};
+
+template <>
+struct TASE2IndicationSetter<TASE2_IND_POINT_TYPE_STATE_SUPPLEMENTAL, true,
+                             true>
+{
+    static void
+    set (Tase2_IndicationPoint ip, const TASE2PointUpdate& update)
+    {
+        Tase2_IndicationPoint_setStateSupplementalQTimeStamp (
+            ip, static_cast<Tase2_DataStateSupplemental> (update.intValue),
+            update.dataFlags, update.timestamp);
+    }
+};
+
+/*
+ * Entry of the update table: what an indication point of a DPTYPE expects
+ * from a pivot data object and how its value is set.
+ */
+struct TASE2UpdateTraits
+{
+    PivotValueKind valueKind;
+    bool hasQuality;
+    bool hasTimestamp;
+    void (*apply) (Tase2_IndicationPoint ip, const TASE2PointUpdate& update);
+};
+
+/* compile time description of one indication DPTYPE, derived from the
+ * layout of the enum (four variants per indication point type) */
+template <DPTYPE Type> struct TASE2TypeTraits
+{
+    static_assert (Type >= REAL && Type < COMMAND,
+                   "only indication point types have update traits");
+
+    static constexpr Tase2_IndicationPointType indicationType
+        = static_cast<Tase2_IndicationPointType> (Type / 4);
+
+    static constexpr bool hasQuality = Type % 4 > 0;
+
+    /* the *Ext variants only differ in the timestamp class of the point */
+    static constexpr bool hasTimestamp = Type % 4 > 1;
+
+    static constexpr PivotValueKind valueKind
+        = indicationType == TASE2_IND_POINT_TYPE_REAL ? PIVOT_VALUE_FLOAT
+                                                      : PIVOT_VALUE_INTEGER;
+
+    typedef TASE2IndicationSetter<indicationType, hasQuality, hasTimestamp>
+        Setter;
+
+    static constexpr TASE2UpdateTraits
+    entry ()
+    {
+        return { valueKind, hasQuality, hasTimestamp, &Setter::set };
+    }
+};
+
+class TASE2UpdateTable
+{
+  public:
+    /* nullptr for commands and unknown types */
+    static const TASE2UpdateTraits*
+    get (DPTYPE type)
+    {
+        return type >= REAL && type < COMMAND ? &s_table[type] : nullptr;
+    }
+
+  private:
+    static constexpr TASE2UpdateTraits s_table[COMMAND] = {
+        TASE2TypeTraits<REAL>::entry (),
+        TASE2TypeTraits<REALQ>::entry (),
+        TASE2TypeTraits<REALQTIME>::entry (),
+        TASE2TypeTraits<REALQTIMEEXT>::entry (),
+        TASE2TypeTraits<STATE>::entry (),
+        TASE2TypeTraits<STATEQ>::entry (),
+        TASE2TypeTraits<STATEQTIME>::entry (),
+        TASE2TypeTraits<STATEQTIMEEXT>::entry (),
+        TASE2TypeTraits<DISCRETE>::entry (),
+        TASE2TypeTraits<DISCRETEQ>::entry (),
+        TASE2TypeTraits<DISCRETEQTIME>::entry (),
+        TASE2TypeTraits<DISCRETEQTIMEEXT>::entry (),
+        TASE2TypeTraits<STATESUP>::entry (),
+        TASE2TypeTraits<STATESUPQ>::entry (),
+        TASE2TypeTraits<STATESUPQTIME>::entry (),
+        TASE2TypeTraits<STATESUPQTIMEEXT>::entry (),
+    };
+};
+
+#endif
@@ -11,71 +11,127 @@ namespace Tase2Utility {
 
 static const std::string PluginName = PLUGIN_NAME;
 
+typedef enum
+{
+    LEVEL_DEBUG,
+    LEVEL_INFO,
+    LEVEL_WARNING,
+    LEVEL_ERROR,
+    LEVEL_FATAL
+} LogLevel;
+
+/*
+ * Check the current Fledge log level. The level names (debug, info, warning,
+ * error, fatal) differ in their first character, so this is a single
+ * character switch and cheap enough to guard every log call.
+ */
+inline bool
+isLogEnabled (LogLevel level)
+{
+    const std::string& minLevel = Logger::getLogger ()->getMinLevel ();
+
+    LogLevel minimum = LEVEL_WARNING;
+
+    switch (minLevel.empty () ? 'w' : minLevel[0])
+    {
+    case 'd':
+        minimum = LEVEL_DEBUG;
+        break;
+    case 'i':
+        minimum = LEVEL_INFO;
+        break;
+    case 'e':
+        minimum = LEVEL_ERROR;
+        break;
+    case 'f':
+        minimum = LEVEL_FATAL;
+        break;
+    default:
+        break;
+    }
+
+    return level >= minimum;
+}
+
 /*
  * Log helper function that will log both in the Fledge syslog file and in
- * stdout for unit tests
+ * stdout for unit tests. Nothing is formatted when the level is disabled;
+ * arguments that are expensive to build should be guarded by the caller
+ * with isLogEnabled.
  */
 template <class... Args>
 void
-log_debug (const std::string& format, Args&&... args)
+log_debug (const char* format, Args&&... args)
 {
+    if (!isLogEnabled (LEVEL_DEBUG))
+        return;
+
 #ifdef UNIT_TEST
     printf (std::string (format).append ("\n").c_str (),
             std::forward<Args> (args)...);
     fflush (stdout);
 #endif
-    Logger::getLogger ()->debug (format.c_str (),
-                                 std::forward<Args> (args)...);
+    Logger::getLogger ()->debug (format, std::forward<Args> (args)...);
 }
 
 template <class... Args>
 void
-log_info (const std::string& format, Args&&... args)
+log_info (const char* format, Args&&... args)
 {
+    if (!isLogEnabled (LEVEL_INFO))
+        return;
+
 #ifdef UNIT_TEST
     printf (std::string (format).append ("\n").c_str (),
             std::forward<Args> (args)...);
     fflush (stdout);
 #endif
-    Logger::getLogger ()->info (format.c_str (), std::forward<Args> (args)...);
+    Logger::getLogger ()->info (format, std::forward<Args> (args)...);
 }
 
 template <class... Args>
 void
-log_warn (const std::string& format, Args&&... args)
+log_warn (const char* format, Args&&... args)
 {
+    if (!isLogEnabled (LEVEL_WARNING))
+        return;
+
 #ifdef UNIT_TEST
     printf (std::string (format).append ("\n").c_str (),
             std::forward<Args> (args)...);
     fflush (stdout);
 #endif
-    Logger::getLogger ()->warn (format.c_str (), std::forward<Args> (args)...);
+    Logger::getLogger ()->warn (format, std::forward<Args> (args)...);
 }
 
 template <class... Args>
 void
-log_error (const std::string& format, Args&&... args)
+log_error (const char* format, Args&&... args)
 {
+    if (!isLogEnabled (LEVEL_ERROR))
+        return;
+
 #ifdef UNIT_TEST
     printf (std::string (format).append ("\n").c_str (),
             std::forward<Args> (args)...);
     fflush (stdout);
 #endif
-    Logger::getLogger ()->error (format.c_str (),
-                                 std::forward<Args> (args)...);
+    Logger::getLogger ()->error (format, std::forward<Args> (args)...);
 }
 
 template <class... Args>
 void
-log_fatal (const std::string& format, Args&&... args)
+log_fatal (const char* format, Args&&... args)
 {
+    if (!isLogEnabled (LEVEL_FATAL))
+        return;
+
 #ifdef UNIT_TEST
     printf (std::string (format).append ("\n").c_str (),
             std::forward<Args> (args)...);
     fflush (stdout);
 #endif
-    Logger::getLogger ()->fatal (format.c_str (),
-                                 std::forward<Args> (args)...);
+    Logger::getLogger ()->fatal (format, std::forward<Args> (args)...);
 }
 }
 
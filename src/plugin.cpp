@@ -510,6 +510,13 @@ extern "C"
                         [ { "cert_file" : "tase2_client.cer" } ]
                 }
             })
+        },
+        "model_snapshot" : {
+            "description" : "Keep a compiled data model for faster restarts",
+            "type" : "boolean",
+            "displayName" : "Model snapshot",
+            "order" : "6",
+            "default" : "false"
         }
     });
     /**
@@ -600,6 +607,27 @@ extern "C"
         }
     }
 
+    /**
+     * Reconfigure the plugin
+     *
+     * Changes to the exchanged data, the change filters, the command rate
+     * limits and the bilateral tables are applied to the running server,
+     * the connected clients stay connected. Other changes rebuild the
+     * server.
+     *
+     * @param handle	The plugin handle
+     * @param newConfig	The new configuration of the plugin
+     */
+    void
+    plugin_reconfigure (PLUGIN_HANDLE* handle, const string& newConfig)
+    {
+        TASE2Server* tase2 = (TASE2Server*)*handle;
+
+        ConfigCategory config ("new", newConfig);
+
+        tase2->reconfigure (&config);
+    }
+
     /**
      * Shutdown the plugin
      *
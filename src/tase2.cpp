@@ -7,8 +7,12 @@
 #include <tase2.hpp>
 #include <utils.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <stdbool.h>
 #include <string>
+#include <sys/stat.h>
 #include <vector>
 
 static uint64_t
@@ -26,6 +30,21 @@ getMonotonicTimeInMs ()
     return timeVal;
 }
 
+static uint64_t
+getMonotonicTimeInUs ()
+{
+    uint64_t timeVal = 0;
+
+    struct timespec ts;
+
+    if (clock_gettime (CLOCK_MONOTONIC, &ts) == 0)
+    {
+        timeVal = ((uint64_t)ts.tv_sec * 1000000LL) + (ts.tv_nsec / 1000);
+    }
+
+    return timeVal;
+}
+
 static uint64_t
 GetCurrentTimeInMs ()
 {
@@ -71,26 +90,113 @@ TASE2Server::TASE2Server () : m_started (false), m_config (new TASE2Config ())
 TASE2Server::~TASE2Server ()
 {
     stop ();
-    if (m_monitoringThread)
+
+    removeAllOutstandingCommands ();
+
+    delete m_ingestQueue;
+    delete m_coalescer;
+    delete m_commandQueue;
+
+    if (m_tlsConfig)
     {
-        m_monitoringThread->join ();
-        delete m_monitoringThread;
+        TLSConfiguration_destroy (m_tlsConfig);
     }
 
-    if (m_connectionThread)
+    delete m_config;
+}
+
+void
+TASE2Server::discardModel (TASE2Config* config, Tase2_DataModel model)
+{
+    for (Tase2_BilateralTable blt : config->getBilateralTables ())
     {
-        m_connectionThread->join ();
-        delete m_connectionThread;
+        Tase2_BilateralTable_destroy (blt);
     }
 
-    removeAllOutstandingCommands ();
+    delete config;
 
-    if (m_tlsConfig)
+    if (model)
     {
-        TLSConfiguration_destroy (m_tlsConfig);
+        Tase2_DataModel_destroy (model);
     }
+}
 
-    delete m_config;
+bool
+TASE2Server::importModel (const std::string& modelConfig,
+                          const std::string& exchangeConfig,
+                          TASE2Config*& config, Tase2_DataModel& model)
+{
+    uint64_t begin = getMonotonicTimeInMs ();
+    uint64_t hash = TASE2ModelSnapshot::hash (modelConfig, exchangeConfig);
+
+    model = Tase2_DataModel_create ();
+
+    if (!m_modelSnapshotPath.empty ())
+    {
+        if (config->importModelSnapshot (m_modelSnapshotPath, hash, model))
+        {
+            Tase2Utility::log_info (
+                "Model restored from %s in %llu ms, %zu datapoints",
+                m_modelSnapshotPath.c_str (),
+                (unsigned long long)(getMonotonicTimeInMs () - begin),
+                config->getPointIndex ().size ());
+            return true;
+        }
+
+        Tase2Utility::log_info (
+            "No model snapshot for this configuration in %s",
+            m_modelSnapshotPath.c_str ());
+
+        /* nothing of a partly replayed snapshot is kept */
+        discardModel (config, model);
+
+        config = new TASE2Config ();
+        model = Tase2_DataModel_create ();
+    }
+
+    TASE2ModelSnapshot snapshot (hash);
+
+    if (!m_modelSnapshotPath.empty ())
+    {
+        config->setModelSnapshot (&snapshot);
+    }
+
+    bool imported = config->importModelConfig (modelConfig, model);
+
+    imported = config->importExchangeConfig (exchangeConfig, model)
+               && imported;
+
+    config->setModelSnapshot (nullptr);
+
+    Tase2Utility::log_info ("Model imported in %llu ms, %zu datapoints",
+                            (unsigned long long)(getMonotonicTimeInMs ()
+                                                 - begin),
+                            config->getPointIndex ().size ());
+
+    if (m_modelSnapshotPath.empty ())
+    {
+        return false;
+    }
+
+    /* a partly imported model is not replayed, not even an older one */
+    if (!imported)
+    {
+        if (!TASE2ModelSnapshot::remove (m_modelSnapshotPath))
+        {
+            Tase2Utility::log_warn ("Failed to remove model snapshot %s",
+                                    m_modelSnapshotPath.c_str ());
+        }
+
+        return false;
+    }
+
+    if (!snapshot.save (m_modelSnapshotPath))
+    {
+        Tase2Utility::log_warn ("Failed to write model snapshot %s",
+                                m_modelSnapshotPath.c_str ());
+    }
+
+    return false;
 }
 
 void
@@ -99,13 +205,49 @@ TASE2Server::setJsonConfig (const std::string& stackConfig,
                             const std::string& tlsConfig,
                             const std::string& modelConfig)
 {
-    m_model = Tase2_DataModel_create ();
-    m_config->importModelConfig (modelConfig, m_model);
-    m_config->importExchangeConfig (dataExchangeConfig, m_model);
+    m_modelReplayed
+        = importModel (modelConfig, dataExchangeConfig, m_config, m_model);
+    createServer (stackConfig, tlsConfig);
+}
+
+void
+TASE2Server::createServer (const std::string& stackConfig,
+                           const std::string& tlsConfig)
+{
+    m_stackConfigJson = stackConfig;
+    m_tlsConfigJson = tlsConfig;
+
     m_config->importProtocolConfig (stackConfig);
 
     m_passive = m_config->Passive ();
 
+    m_outstandingCommands.init (m_config->getControlPoints ());
+    m_commandRate.configure (m_config->GlobalCommandRateLimit ());
+
+    if (m_config->AsyncIngest ())
+    {
+        m_ingestQueue = new TASE2IngestQueue (m_config->IngestQueueSize (),
+                                              m_config->IngestOverflow ());
+
+        Tase2Utility::log_info ("Asynchronous ingest, queue size %zu",
+                                m_ingestQueue->capacity ());
+    }
+
+    if (m_config->AsyncCommands ())
+    {
+        m_commandQueue = new TASE2CommandQueue (m_config->CommandQueueSize ());
+
+        Tase2Utility::log_info ("Asynchronous command dispatch, queue size "
+                                "%zu",
+                                m_commandQueue->capacity ());
+    }
+
+    if (m_config->CoalesceUpdates ())
+    {
+        m_coalescer
+            = new TASE2UpdateCoalescer (m_config->getPointIndex ().size ());
+    }
+
     if (m_config->TLSEnabled ())
     {
         m_config->importTlsConfig (tlsConfig);
@@ -163,370 +305,975 @@ TASE2Server::start ()
         = new std::thread (&TASE2Server::_connectionThread, this);
     m_monitoringThread
         = new std::thread (&TASE2Server::_monitoringThread, this);
-}
-
-void
-TASE2Server::_connectionThread ()
-{
-    Tase2Utility::log_debug ("Connection thread called");
-
-    if (!m_server)
-    {
-        Tase2Utility::log_error ("No server, can't start");
-        return;
-    }
 
-    if (m_passive)
+    if (m_ingestQueue)
     {
-        Tase2_Server_setLocalIpAddress (m_server,
-                                        m_config->ServerIp ().c_str ());
-
-        Tase2_Server_setTcpPort (m_server, m_config->TcpPort ());
+        m_publisherThread
+            = new std::thread (&TASE2Server::_publisherThread, this);
     }
 
-    m_lastConnCheck = getMonotonicTimeInMs ();
-    Tase2_Endpoint_connect (m_endpoint);
-
-    while (m_started)
+    if (m_commandQueue)
     {
-        m_connectionLock.lock ();
-        if (getMonotonicTimeInMs () > m_lastConnCheck + m_connTimeout)
-        {
-            m_lastConnCheck = getMonotonicTimeInMs ();
-            if (!m_passive
-                && Tase2_Endpoint_getState (m_endpoint)
-                       != TASE2_ENDPOINT_STATE_CONNECTED)
-            {
-                Tase2Utility::log_warn ("Connection failed, trying again");
-
-                Tase2_Endpoint_connect (m_endpoint);
-            }
-        }
-        m_connectionLock.unlock ();
-        Thread_sleep (50);
+        m_dispatchThread
+            = new std::thread (&TASE2Server::_dispatchThread, this);
     }
 }
 
 void
-TASE2Server::_monitoringThread ()
+TASE2Server::_publisherThread ()
 {
-    Tase2Utility::log_debug ("Monitoring thread called");
+    Tase2Utility::log_debug ("Publisher thread called");
 
-    // LCOV_EXCL_START
-    if (!m_server)
-    {
-        Tase2Utility::log_error ("No server, can't start");
-        return;
-    }
-    // LCOV_EXCL_STOP
+    std::vector<TASE2PointUpdate> batch;
 
-    while (m_started)
+    int window = m_coalescer ? m_config->CoalesceWindow () : 0;
+
+    while (!m_ingestQueue->isClosed ())
     {
-        /* check timeouts for outstanding commands */
-        m_outstandingCommandsLock.lock ();
+        batch.clear ();
+
+        if (m_ingestQueue->pop (batch, TASE2_UPDATES_PER_LOCK, 100) == 0)
+        {
+            continue;
+        }
 
-        uint64_t currentTime = Hal_getTimeInMs ();
+        /* collect everything arriving within the window, so that repeated
+         * updates of a point are reduced to the newest one */
+        uint64_t windowEnd = getMonotonicTimeInMs () + window;
+        uint64_t now;
 
-        for (auto it = m_outstandingCommands.begin ();
-             it != m_outstandingCommands.end ();)
+        while (window > 0 && !m_ingestQueue->isClosed ()
+               && (now = getMonotonicTimeInMs ()) < windowEnd)
         {
-            if ((*it)->hasTimedOut (currentTime))
-            {
-                Tase2Utility::log_warn (
-                    "command %s:%s timeout", (*it)->Domain ().c_str (),
-                    (*it)->Name ().c_str ()); // LCOV_EXCL_LINE
+            m_ingestQueue->pop (batch, TASE2_UPDATES_PER_LOCK,
+                                (int)(windowEnd - now));
+        }
 
-                delete *it;
-                it = m_outstandingCommands.erase (it);
-            }
-            else
-            {
-                ++it;
-            }
+        if (m_coalescer)
+        {
+            m_coalescer->coalesce (batch);
         }
 
-        m_outstandingCommandsLock.unlock ();
-        Thread_sleep (50);
+        applyUpdates (batch);
     }
-}
-
-void
-TASE2Server::addToOutstandingCommands (const std::string& domain,
-                                       const std::string& name, bool isSelect)
-{
-    m_outstandingCommandsLock.lock ();
 
-    TASE2OutstandingCommand* outstandingCommand = new TASE2OutstandingCommand (
-        domain, name, m_config->CmdExecTimeout (), isSelect);
+    /* publish the updates queued before the close, in order */
+    batch.clear ();
 
-    m_outstandingCommands.push_back (outstandingCommand);
+    while (m_ingestQueue->pop (batch, TASE2_UPDATES_PER_LOCK, 0) > 0)
+    {
+        if (m_coalescer)
+        {
+            m_coalescer->coalesce (batch);
+        }
 
-    m_outstandingCommandsLock.unlock ();
+        applyUpdates (batch);
+        batch.clear ();
+    }
 }
 
 void
-TASE2Server::removeAllOutstandingCommands ()
+TASE2Server::_dispatchThread ()
 {
-    m_outstandingCommandsLock.lock ();
+    Tase2Utility::log_debug ("Dispatch thread called");
 
-    std::vector<TASE2OutstandingCommand*>::iterator it;
+    TASE2CommandRequest request;
 
-    for (auto oc : m_outstandingCommands)
+    /* returns false once the queue is closed and drained */
+    while (m_commandQueue->pop (request))
     {
-        TASE2OutstandingCommand* outstandingCommand = *it;
-        delete oc;
+        dispatchCommand (request);
     }
-
-    m_outstandingCommands.clear ();
-
-    m_outstandingCommandsLock.unlock ();
 }
 
 void
-TASE2Server::stop ()
+TASE2Server::stopDispatcher ()
 {
-    m_started = false;
-    if (m_model)
-    {
-        Tase2_DataModel_destroy (m_model);
-    }
-    if (m_server)
+    if (!m_commandQueue)
     {
-        Tase2_Server_destroy (m_server);
-    }
-    if (m_endpoint)
-    {
-        Tase2_Endpoint_destroy (m_endpoint);
+        return;
     }
+
+    m_commandQueue->close ();
+
+    joinThread (m_dispatchThread);
 }
 
 void
-TASE2Server::clientConnectionHandler (void* parameter,
-                                      const char* clientAddress,
-                                      Tase2_BilateralTable clientBlt,
-                                      bool connect)
+TASE2Server::stopPublisher ()
 {
-    if (connect)
-    {
-        Tase2Utility::log_info ("Client from %s connected\n", clientAddress);
-    }
-    else
-    {
-        Tase2Utility::log_info ("Client from %s disconnected\n",
-                                clientAddress);
-    }
-
-    if (clientBlt)
+    if (!m_ingestQueue || m_ingestQueue->isClosed ())
     {
-        Tase2Utility::log_debug ("client BLT: %s\n",
-                                 Tase2_BilateralTable_getID (clientBlt));
+        return;
     }
-}
-
-Tase2_HandlerResult
-TASE2Server::selectHandler (void* parameter, Tase2_ControlPoint controlPoint)
-{
-    auto server = (TASE2Server*)parameter;
 
-    Tase2_ControlPointType type = Tase2_ControlPoint_getType (controlPoint);
+    /* no new updates are accepted, the publisher drains the rest */
+    m_ingestQueue->close ();
 
-    std::string domain
-        = Tase2_Domain_getName (Tase2_ControlPoint_getDomain (controlPoint));
-    std::string name = Tase2_ControlPoint_getName (controlPoint);
+    joinThread (m_publisherThread);
 
-    std::string scope = domain == "vcc" ? "vcc" : "domain";
+    TASE2IngestStats stats = m_ingestQueue->getStats ();
 
-    Tase2Utility::log_debug ("Received select for %s:%s\n", domain.c_str (),
-                             name.c_str ());
-
-    switch (type)
-    {
-    case TASE2_CONTROL_TYPE_COMMAND: {
-        server->forwardCommand (scope, domain, name, "Command",
-                                GetCurrentTimeInMs (), nullptr, true);
-        break; // LCOV_EXCL_LINE
-    }
-    case TASE2_CONTROL_TYPE_SETPOINT_DESCRETE: {
-        server->forwardCommand (scope, domain, name, "SetPointDiscrete",
-                                GetCurrentTimeInMs (), nullptr, true);
-        break; // LCOV_EXCL_LINE
-    }
-    case TASE2_CONTROL_TYPE_SETPOINT_REAL: {
-        server->forwardCommand (scope, domain, name, "SetPointReal",
-                                GetCurrentTimeInMs (), nullptr, true);
-        break; // LCOV_EXCL_LINE
-    }
-    }
-
-    return TASE2_RESULT_SUCCESS;
+    Tase2Utility::log_info (
+        "Ingest queue: %llu pushed, %llu published, %llu dropped, "
+        "%llu coalesced, %llu blocked, high watermark %zu/%zu",
+        (unsigned long long)stats.pushed, (unsigned long long)stats.published,
+        (unsigned long long)stats.dropped,
+        (unsigned long long)stats.coalesced,
+        (unsigned long long)stats.blocked, stats.highWatermark,
+        stats.capacity);
 }
 
-Tase2_HandlerResult
-TASE2Server::setTagHandler (void* parameter, Tase2_ControlPoint controlPoint,
-                            Tase2_TagValue value, const char* reason)
+uint64_t
+TASE2Server::getSuppressedUpdates ()
 {
-    Tase2Utility::log_debug (
-        "Set tag value %i for control %s\n", value,
-        Tase2_DataPoint_getName ((Tase2_DataPoint)controlPoint));
-
-    Tase2Utility::log_debug ("   reason given by client: %s\n", reason);
+    return m_suppressedUpdates.load (std::memory_order_relaxed);
+}
 
-    return TASE2_RESULT_SUCCESS;
+uint64_t
+TASE2Server::getCoalescedUpdates ()
+{
+    return m_coalescer ? m_coalescer->getCoalesced () : 0;
 }
 
-Tase2_HandlerResult
-TASE2Server::operateHandler (void* parameter, Tase2_ControlPoint controlPoint,
-                             Tase2_OperateValue value)
+const TASE2CommandLatency*
+TASE2Server::getCommandLatency (const std::string& domain,
+                                const std::string& name) const
 {
-    auto server = (TASE2Server*)parameter;
+    TASE2Datapoint* controlPoint = m_config->findDatapoint (domain, name);
 
-    Tase2_ControlPointType type = Tase2_ControlPoint_getType (controlPoint);
+    return controlPoint ? controlPoint->getCommandLatency () : nullptr;
+}
 
-    std::string domain
-        = Tase2_Domain_getName (Tase2_ControlPoint_getDomain (controlPoint));
-    std::string name = Tase2_ControlPoint_getName (controlPoint);
+void
+TASE2Server::recordCommandLatency (TASE2Datapoint* controlPoint,
+                                   bool confirmed, uint64_t receivedUs)
+{
+    uint64_t now = getMonotonicTimeInUs ();
+    uint64_t latency = now > receivedUs ? now - receivedUs : 0;
 
-    std::string scope = domain == "vcc" ? "vcc" : "domain";
+    TASE2CommandLatency& typeLatency = m_commandLatency
+        [TASE2Datapoint::toControlPointType (controlPoint->getType ())];
 
-    Tase2Utility::log_debug ("Received operate for %s:%s\n", domain.c_str (),
-                             name.c_str ());
+    TASE2CommandLatency* pointLatency = controlPoint->createCommandLatency ();
 
-    switch (type)
+    if (confirmed)
     {
-    case TASE2_CONTROL_TYPE_COMMAND: {
-        server->forwardCommand (scope, domain, name, "Command",
-                                GetCurrentTimeInMs (), &value, false);
-        break; // LCOV_EXCL_LINE
+        typeLatency.confirm.record (latency);
     }
-    case TASE2_CONTROL_TYPE_SETPOINT_DESCRETE: {
-        server->forwardCommand (scope, domain, name, "SetPointDiscrete",
-                                GetCurrentTimeInMs (), &value, false);
-        break; // LCOV_EXCL_LINE
+    else
+    {
+        typeLatency.dispatch.record (latency);
     }
-    case TASE2_CONTROL_TYPE_SETPOINT_REAL: {
-        server->forwardCommand (scope, domain, name, "SetPointReal",
-                                GetCurrentTimeInMs (), &value, false);
-        break; // LCOV_EXCL_LINE
+
+    if (confirmed)
+    {
+        pointLatency->confirm.record (latency);
     }
+    else
+    {
+        pointLatency->dispatch.record (latency);
     }
-    return TASE2_RESULT_SUCCESS;
 }
 
-enum CommandParameters
+static void
+logLatency (const char* what, const TASE2CommandLatency& latency)
 {
-    TYPE,
-    SCOPE,
-    DOMAIN,
-    NAME,
-    VALUE,
-    SELECT,
-    TS
-};
+    const TASE2LatencyHistogram& dispatch = latency.dispatch;
+    const TASE2LatencyHistogram& confirm = latency.confirm;
+
+    Tase2Utility::log_info (
+        "Command latency %s: %llu dispatched, p50 %llu us, p99 %llu us, "
+        "max %llu us; %llu confirmed, p50 %llu us, p90 %llu us, "
+        "p99 %llu us, max %llu us; %llu timeouts, %llu throttled",
+        what, (unsigned long long)dispatch.count (),
+        (unsigned long long)dispatch.percentile (50),
+        (unsigned long long)dispatch.percentile (99),
+        (unsigned long long)dispatch.max (),
+        (unsigned long long)confirm.count (),
+        (unsigned long long)confirm.percentile (50),
+        (unsigned long long)confirm.percentile (90),
+        (unsigned long long)confirm.percentile (99),
+        (unsigned long long)confirm.max (),
+        (unsigned long long)latency.timeouts.load (),
+        (unsigned long long)latency.throttled.load ());
+}
 
 void
-TASE2Server::forwardCommand (const std::string& scope,
-                             const std::string& domain,
-                             const std::string& name, const std::string& type,
-                             uint64_t ts, Tase2_OperateValue* value,
-                             bool select)
+TASE2Server::logCommandLatencies ()
 {
+    static const char* typeNames[] = { "Command", "SetPointReal",
+                                       "SetPointDiscrete" };
 
-    std::shared_ptr<TASE2Datapoint> t2dp
-        = m_config->getDatapointByReference (domain, name);
-
-    if (!t2dp || !t2dp->inExchangedDefinitions ())
+    for (int type = 0; type < 3; type++)
     {
-        Tase2Utility::log_debug (
-            "Skipping command: %s %s, reason: datapoints is not in "
-            "Exchanged Definitions",
-            domain.c_str (), name.c_str ());
-        return;
+        if (m_commandLatency[type].dispatch.count () > 0
+            || m_commandLatency[type].throttled > 0)
+        {
+            logLatency (typeNames[type], m_commandLatency[type]);
+        }
     }
 
-    int parameterCount = 7;
-    std::string tsStr = std::to_string (ts);
-    char* s_scope = (char*)scope.c_str ();
-    char* s_type = (char*)type.c_str ();
-    char* s_domain = (char*)domain.c_str ();
-    char* s_name = (char*)name.c_str ();
-    char* s_val = (char*)"";
-    char* s_select = (char*)(select ? "1" : "0");
-    char* s_ts = (char*)tsStr.c_str ();
-
-    std::string val;
-
-    char* parameters[parameterCount];
-    char* names[parameterCount];
+    const TASE2PointIndex& points = m_config->getPointIndex ();
 
-    names[TYPE] = (char*)"co_type";
-    names[SCOPE] = (char*)"co_scope";
-    names[DOMAIN] = (char*)"co_domain";
-    names[NAME] = (char*)"co_name";
-    names[VALUE] = (char*)"co_value";
-    names[SELECT] = (char*)"co_se";
-    names[TS] = (char*)"co_ts";
-
-    Tase2Utility::log_debug ("%s", type.c_str ());
-    if (!select)
+    for (uint32_t pointId = 0; pointId < points.size (); pointId++)
     {
-        if (type == "Command")
-        {
-            val = std::to_string (value->commandValue);
-        }
-        else if (type == "SetPointDiscrete")
-        {
-            val = std::to_string (value->discreteValue);
-        }
-        else if (type == "SetPointReal")
+        TASE2Datapoint* point = points.point (pointId);
+        TASE2CommandLatency* latency = point->getCommandLatency ();
+
+        if (latency
+            && (latency->dispatch.count () > 0 || latency->throttled > 0))
         {
-            val = std::to_string (value->realValue);
+            std::string what
+                = points.domain (pointId) + ":" + point->getLabel ();
+
+            logLatency (what.c_str (), *latency);
         }
     }
-    s_val = (char*)val.c_str ();
+}
 
-    parameters[TYPE] = s_type;
-    parameters[SCOPE] = s_scope;
-    parameters[DOMAIN] = s_domain;
-    parameters[NAME] = s_name;
-    parameters[VALUE] = s_val;
-    parameters[SELECT] = s_select;
-    parameters[TS] = s_ts;
+bool
+TASE2Server::getIngestStats (TASE2IngestStats& stats)
+{
+    if (!m_ingestQueue)
+    {
+        return false;
+    }
 
-    addToOutstandingCommands (domain, name, select);
+    stats = m_ingestQueue->getStats ();
 
-    m_oper ((char*)"TASE2Command", parameterCount, names, parameters,
-            DestinationBroadcast, NULL);
+    return true;
 }
 
 void
-TASE2Server::handleActCon (const std::string& domain, const std::string& name)
+TASE2Server::_connectionThread ()
 {
-    m_outstandingCommandsLock.lock ();
+    Tase2Utility::log_debug ("Connection thread called");
 
-    for (std::vector<TASE2OutstandingCommand*>::iterator it
-         = m_outstandingCommands.begin ();
-         it != m_outstandingCommands.end (); it++)
+    if (!m_server)
     {
-        TASE2OutstandingCommand* outstandingCommand = *it;
+        Tase2Utility::log_error ("No server, can't start");
+        return;
+    }
 
-        if (outstandingCommand->Domain () == domain
-            && outstandingCommand->Name () == name)
-        {
-            m_outstandingCommands.erase (it);
+    if (m_passive)
+    {
+        Tase2_Server_setLocalIpAddress (m_server,
+                                        m_config->ServerIp ().c_str ());
 
-            Tase2Utility::log_debug (
-                "Outstanding command %i:%i confirmation  "
-                "-> remove",
-                outstandingCommand->Domain (),
-                outstandingCommand->Name ()); // LCOV_EXCL_LINE
+        Tase2_Server_setTcpPort (m_server, m_config->TcpPort ());
+    }
 
-            delete outstandingCommand;
+    Tase2_Endpoint_connect (m_endpoint);
+
+    std::unique_lock<std::mutex> lock (m_connectionStateLock);
+
+    /* a passive endpoint keeps listening, nothing to supervise */
+    if (m_passive)
+    {
+        m_connectionStateCond.wait (lock, [this] { return !m_started; });
+        return;
+    }
+
+    TASE2Backoff backoff (m_config->ReconnectMinInterval (),
+                          m_config->ReconnectMaxInterval ());
+
+    uint64_t delay = backoff.next ();
+
+    while (m_started)
+    {
+        /* returns early only when the server stops */
+        if (m_connectionStateCond.wait_for (
+                lock, std::chrono::milliseconds (delay),
+                [this] { return !m_started; }))
+        {
+            break;
+        }
+
+        if (Tase2_Endpoint_getState (m_endpoint)
+            == TASE2_ENDPOINT_STATE_CONNECTED)
+        {
+            /* check the connection again after the minimum interval */
+            backoff.reset ();
+            delay = backoff.minInterval ();
+            continue;
+        }
+
+        delay = backoff.next ();
+
+        Tase2Utility::log_warn ("Connection failed, trying again, next "
+                                "attempt in %llu ms",
+                                (unsigned long long)delay);
+
+        Tase2_Endpoint_connect (m_endpoint);
+    }
+}
+
+void
+TASE2Server::_monitoringThread ()
+{
+    Tase2Utility::log_debug ("Monitoring thread called");
+
+    // LCOV_EXCL_START
+    if (!m_server)
+    {
+        Tase2Utility::log_error ("No server, can't start");
+        return;
+    }
+    // LCOV_EXCL_STOP
+
+    std::unique_lock<std::mutex> lock (m_outstandingCommandsLock);
+
+    while (m_started)
+    {
+        if (m_commandTimeouts.empty ())
+        {
+            m_commandTimeoutsCond.wait (lock);
+            continue;
+        }
+
+        TASE2CommandTimeout next = m_commandTimeouts.top ();
+        uint64_t currentTime = getMonotonicTimeInMs ();
+
+        if (next.deadline > currentTime)
+        {
+            /* woken up early when a command with an earlier deadline is
+             * added or the server stops */
+            m_commandTimeoutsCond.wait_for (
+                lock, std::chrono::milliseconds (next.deadline - currentTime));
+            continue;
+        }
+
+        m_commandTimeouts.pop ();
+
+        expireOutstandingCommand (next);
+    }
+}
+
+void
+TASE2Server::expireOutstandingCommand (const TASE2CommandTimeout& timeout)
+{
+    TASE2Datapoint* controlPoint = timeout.controlPoint;
+    TASE2OutstandingCommand* command
+        = m_outstandingCommands.get (controlPoint);
+
+    bool wasSelect = command && command->isSelect ();
+
+    /* otherwise the command completed before its deadline */
+    if (command && m_outstandingCommands.expire (*command, timeout.id))
+    {
+        const TASE2CommandParams* params = controlPoint->getCommandParams ();
+
+        if (wasSelect)
+        {
+            Tase2Utility::log_warn ("select %s:%s timeout -> deselected",
+                                    params->Domain ().c_str (),
+                                    params->Name ().c_str ());
+        }
+        else
+        {
+            Tase2Utility::log_warn (
+                "command %s:%s timeout", params->Domain ().c_str (),
+                params->Name ().c_str ()); // LCOV_EXCL_LINE
+
+            m_commandLatency[TASE2Datapoint::toControlPointType (
+                controlPoint->getType ())]
+                .timeouts++;
+
+            controlPoint->createCommandLatency ()->timeouts++;
+        }
+    }
+
+    /* drop the entries of completed commands, nothing left to wait for */
+    if (m_outstandingCommands.empty ())
+    {
+        m_commandTimeouts = decltype (m_commandTimeouts) ();
+    }
+}
+
+Tase2_HandlerResult
+TASE2Server::startCommand (TASE2Datapoint* controlPoint, bool isSelect,
+                           uint64_t receivedUs)
+{
+    std::unique_lock<std::mutex> lock (m_outstandingCommandsLock);
+
+    TASE2OutstandingCommand* command
+        = m_outstandingCommands.get (controlPoint);
+
+    // LCOV_EXCL_START
+    if (!command)
+    {
+        return TASE2_RESULT_OBJECT_NON_EXISTENT;
+    }
+    // LCOV_EXCL_STOP
+
+    if (!(isSelect ? command->canSelect () : command->canOperate ()))
+    {
+        const TASE2CommandParams* params = controlPoint->getCommandParams ();
+
+        Tase2Utility::log_warn (
+            "Rejecting %s for %s:%s, reason: %s in progress",
+            isSelect ? "select" : "operate", params->Domain ().c_str (),
+            params->Name ().c_str (),
+            command->isSelect () ? "select" : "command");
+
+        return TASE2_RESULT_TEMPORARILY_UNAVAILABLE;
+    }
+
+    /* only requests the point accepts use up the rate limits */
+    if (!takeCommandTokens (controlPoint))
+    {
+        return TASE2_RESULT_TEMPORARILY_UNAVAILABLE;
+    }
+
+    uint64_t now = getMonotonicTimeInMs ();
+
+    /* cannot fail any more, checked above under the same lock */
+    if (isSelect)
+    {
+        m_outstandingCommands.select (*command, now,
+                                      m_config->SelectTimeout (), receivedUs);
+    }
+    else
+    {
+        m_outstandingCommands.operate (
+            *command, now, m_config->CmdExecTimeout (), receivedUs);
+    }
+
+    TASE2CommandTimeout timeout
+        = { command->Deadline (), command->Id (), controlPoint };
+
+    /* the monitoring thread only has to wake up for a new earliest
+     * deadline */
+    bool earliest = m_commandTimeouts.empty ()
+                    || timeout.deadline < m_commandTimeouts.top ().deadline;
+
+    m_commandTimeouts.push (timeout);
+
+    lock.unlock ();
+
+    if (earliest)
+    {
+        m_commandTimeoutsCond.notify_one ();
+    }
+
+    return TASE2_RESULT_SUCCESS;
+}
+
+bool
+TASE2Server::takeCommandTokens (TASE2Datapoint* controlPoint)
+{
+    uint64_t nowUs = getMonotonicTimeInUs ();
+
+    TASE2TokenBucket* pointRate = controlPoint->getCommandRate ();
+
+    /* refill both, a token is only taken when both have one */
+    bool pointAvailable = !pointRate || pointRate->refill (nowUs);
+    bool globalAvailable = m_commandRate.refill (nowUs);
+
+    if (pointAvailable && globalAvailable)
+    {
+        if (pointRate)
+        {
+            pointRate->take ();
+        }
+
+        m_commandRate.take ();
+
+        return true;
+    }
+
+    m_throttledCommands++;
+
+    m_commandLatency[TASE2Datapoint::toControlPointType (
+        controlPoint->getType ())]
+        .throttled++;
+
+    controlPoint->createCommandLatency ()->throttled++;
+
+    const TASE2CommandParams* params = controlPoint->getCommandParams ();
+
+    Tase2Utility::log_debug ("Throttling command for %s:%s, reason: %s "
+                             "rate limit",
+                             params->Domain ().c_str (),
+                             params->Name ().c_str (),
+                             pointAvailable ? "global" : "point");
+
+    return false;
+}
+
+void
+TASE2Server::cancelCommand (TASE2Datapoint* controlPoint)
+{
+    std::lock_guard<std::mutex> lock (m_outstandingCommandsLock);
+
+    TASE2OutstandingCommand* command
+        = m_outstandingCommands.get (controlPoint);
+
+    if (command)
+    {
+        m_outstandingCommands.cancel (*command);
+    }
+}
+
+void
+TASE2Server::removeAllOutstandingCommands ()
+{
+    m_outstandingCommandsLock.lock ();
+
+    m_outstandingCommands.clear ();
+    m_commandTimeouts = decltype (m_commandTimeouts) ();
+
+    m_outstandingCommandsLock.unlock ();
+}
+
+void
+TASE2Server::stop ()
+{
+    /* a send that found the server running applies its updates before
+     * the model is destroyed */
+    std::lock_guard<std::mutex> configLock (m_configLock);
+
+    stopLocked ();
+}
+
+void
+TASE2Server::stopLocked ()
+{
+    /* all waits of the worker threads are on condition variables, waking
+     * them is enough to have them return */
+    m_started = false;
+
+    /* taking the locks orders the store before the waiters check it */
+    m_outstandingCommandsLock.lock ();
+    m_outstandingCommandsLock.unlock ();
+    m_commandTimeoutsCond.notify_all ();
+
+    m_connectionStateLock.lock ();
+    m_connectionStateLock.unlock ();
+    m_connectionStateCond.notify_all ();
+
+    joinThread (m_monitoringThread);
+    joinThread (m_connectionThread);
+
+    /* hands the accepted commands over before the server goes away */
+    stopDispatcher ();
+
+    /* publishes what is still queued, the server is needed until then */
+    stopPublisher ();
+
+    if (!m_model && !m_server && !m_endpoint)
+    {
+        return;
+    }
+
+    Tase2Utility::log_info (
+        "%llu updates suppressed by change filters, %llu coalesced",
+        (unsigned long long)getSuppressedUpdates (),
+        (unsigned long long)getCoalescedUpdates ());
+
+    if (getThrottledCommands () > 0)
+    {
+        Tase2Utility::log_info (
+            "%llu commands throttled by rate limits",
+            (unsigned long long)getThrottledCommands ());
+    }
+
+    logCommandLatencies ();
+
+    std::lock_guard<std::mutex> lock (m_connectionLock);
+
+    /* the server references the endpoint and the model */
+    if (m_server)
+    {
+        Tase2_Server_destroy (m_server);
+        m_server = nullptr;
+    }
+    if (m_endpoint)
+    {
+        Tase2_Endpoint_destroy (m_endpoint);
+        m_endpoint = nullptr;
+    }
+    if (m_model)
+    {
+        Tase2_DataModel_destroy (m_model);
+        m_model = nullptr;
+    }
+}
+
+void
+TASE2Server::joinThread (std::thread*& thread)
+{
+    if (thread)
+    {
+        thread->join ();
+        delete thread;
+        thread = nullptr;
+    }
+}
+
+void
+TASE2Server::clientConnectionHandler (void* parameter,
+                                      const char* clientAddress,
+                                      Tase2_BilateralTable clientBlt,
+                                      bool connect)
+{
+    if (connect)
+    {
+        Tase2Utility::log_info ("Client from %s connected\n", clientAddress);
+    }
+    else
+    {
+        Tase2Utility::log_info ("Client from %s disconnected\n",
+                                clientAddress);
+    }
+
+    if (clientBlt)
+    {
+        Tase2Utility::log_debug ("client BLT: %s\n",
+                                 Tase2_BilateralTable_getID (clientBlt));
+    }
+}
+
+Tase2_HandlerResult
+TASE2Server::selectHandler (void* parameter, Tase2_ControlPoint controlPoint)
+{
+    uint64_t receivedUs = getMonotonicTimeInUs ();
+
+    auto server = (TASE2Server*)parameter;
+
+    return server->forwardCommand (controlPoint, "select",
+                                   GetCurrentTimeInMs (), receivedUs, nullptr,
+                                   true);
+}
+
+Tase2_HandlerResult
+TASE2Server::setTagHandler (void* parameter, Tase2_ControlPoint controlPoint,
+                            Tase2_TagValue value, const char* reason)
+{
+    Tase2Utility::log_debug (
+        "Set tag value %i for control %s\n", value,
+        Tase2_DataPoint_getName ((Tase2_DataPoint)controlPoint));
+
+    Tase2Utility::log_debug ("   reason given by client: %s\n", reason);
+
+    return TASE2_RESULT_SUCCESS;
+}
+
+Tase2_HandlerResult
+TASE2Server::operateHandler (void* parameter, Tase2_ControlPoint controlPoint,
+                             Tase2_OperateValue value)
+{
+    uint64_t receivedUs = getMonotonicTimeInUs ();
+
+    auto server = (TASE2Server*)parameter;
+
+    return server->forwardCommand (controlPoint, "operate",
+                                   GetCurrentTimeInMs (), receivedUs, &value,
+                                   false);
+}
+
+Tase2_HandlerResult
+TASE2Server::forwardCommand (Tase2_ControlPoint controlPoint,
+                             const char* action, uint64_t ts,
+                             uint64_t receivedUs,
+                             const Tase2_OperateValue* value, bool select)
+{
+    TASE2Datapoint* t2dp = m_config->findControlPoint (controlPoint);
+
+    // LCOV_EXCL_START
+    if (!t2dp)
+    {
+        Tase2Utility::log_debug (
+            "Skipping command: %s, reason: unknown control point",
+            Tase2_DataPoint_getName ((Tase2_DataPoint)controlPoint));
+        return TASE2_RESULT_OBJECT_NON_EXISTENT;
+    }
+    // LCOV_EXCL_STOP
+
+    const TASE2CommandParams* params = t2dp->getCommandParams ();
+
+    Tase2Utility::log_debug ("Received %s for %s:%s\n", action,
+                             params->Domain ().c_str (),
+                             params->Name ().c_str ());
+
+    if (!t2dp->inExchangedDefinitions ())
+    {
+        Tase2Utility::log_debug (
+            "Skipping command: %s %s, reason: datapoints is not in "
+            "Exchanged Definitions",
+            params->Domain ().c_str (), params->Name ().c_str ());
+        return TASE2_RESULT_SUCCESS;
+    }
+
+    Tase2_HandlerResult result = startCommand (t2dp, select, receivedUs);
+
+    if (result != TASE2_RESULT_SUCCESS)
+    {
+        return result;
+    }
+
+    TASE2CommandRequest request = {};
+
+    request.controlPoint = t2dp;
+    request.select = select;
+    request.ts = ts;
+    request.receivedUs = receivedUs;
+
+    if (value)
+    {
+        request.value = *value;
+    }
+
+    if (!m_commandQueue)
+    {
+        dispatchCommand (request);
+
+        return TASE2_RESULT_SUCCESS;
+    }
+
+    /* the dispatcher thread runs the operation callback, the handler
+     * returns without waiting for it */
+    if (!m_commandQueue->push (request))
+    {
+        cancelCommand (t2dp);
+
+        Tase2Utility::log_warn (
+            "Rejecting %s for %s:%s, reason: command queue full", action,
+            params->Domain ().c_str (), params->Name ().c_str ());
+
+        return TASE2_RESULT_TEMPORARILY_UNAVAILABLE;
+    }
+
+    return TASE2_RESULT_SUCCESS;
+}
+
+void
+TASE2Server::dispatchCommand (const TASE2CommandRequest& request)
+{
+    const TASE2CommandParams* params
+        = request.controlPoint->getCommandParams ();
+
+    char* parameters[CMD_PARAMETER_COUNT];
+    char valueBuffer[TASE2_COMMAND_VALUE_SIZE];
+    char tsBuffer[TASE2_COMMAND_TS_SIZE];
+
+    params->build (parameters, request.select ? nullptr : &request.value,
+                   request.select, request.ts, valueBuffer, tsBuffer);
+
+    Tase2Utility::log_debug ("%s", params->Type ());
+
+    m_oper ((char*)"TASE2Command", CMD_PARAMETER_COUNT,
+            TASE2CommandParams::Names (), parameters, DestinationBroadcast,
+            NULL);
+
+    recordCommandLatency (request.controlPoint, false, request.receivedUs);
+}
+
+void
+TASE2Server::handleActCon (TASE2Datapoint* controlPoint)
+{
+    /* common case, no command pending on this point */
+    if (!controlPoint->hasOutstandingCommands ())
+    {
+        return;
+    }
+
+    m_outstandingCommandsLock.lock ();
+
+    TASE2OutstandingCommand* command
+        = m_outstandingCommands.get (controlPoint);
+
+    if (command && m_outstandingCommands.confirm (*command))
+    {
+        /* the confirmation latency is the one of the operates, a point
+         * still selected had its select confirmed */
+        if (!command->isSelect ())
+        {
+            recordCommandLatency (controlPoint, true,
+                                  command->ReceivedUs ());
+        }
+
+        const TASE2CommandParams* params = controlPoint->getCommandParams ();
+
+        Tase2Utility::log_debug (
+            "Outstanding %s %s:%s confirmation",
+            command->isSelect () ? "select" : "command",
+            params->Domain ().c_str (),
+            params->Name ().c_str ()); // LCOV_EXCL_LINE
+
+        if (m_outstandingCommands.empty ())
+        {
+            m_commandTimeouts = decltype (m_commandTimeouts) ();
+        }
+    }
+
+    m_outstandingCommandsLock.unlock ();
+}
+
+bool
+TASE2Server::decodeUpdate (const TASE2AssetEntry* assetEntry, Datapoint* dp,
+                           const std::string& dpJson, TASE2PointUpdate& update)
+{
+    TASE2PivotRecord record;
+
+    /* the point of a known asset, and its type, were resolved when the
+     * exchanged definitions were imported: only the value, the flags and
+     * the timestamp are decoded */
+    // LCOV_EXCL_START
+    if (!TASE2PivotDecoder::decode (dp, record, assetEntry == nullptr))
+    {
+        Tase2Utility::log_debug (
+            "Skipping datapoint: %s, reason: invalid data_object",
+            dpJson.c_str ());
+        return false;
+    }
+    // LCOV_EXCL_STOP
+
+    TASE2Datapoint* t2dp = nullptr;
+    const TASE2UpdateTraits* traits = nullptr;
+
+    if (assetEntry)
+    {
+        t2dp = assetEntry->point;
+        traits = assetEntry->traits;
+
+        handleActCon (t2dp);
+    }
+    else
+    {
+        // LCOV_EXCL_START
+        if (record.type == DP_TYPE_UNKNOWN)
+        {
+            Tase2Utility::log_debug (
+                "Skipping datapoint: %s, reason: type is -1",
+                dpJson.c_str ());
+            return false;
+        }
+        // LCOV_EXCL_STOP
+
+        t2dp = m_config->findDatapoint (record.domain, record.name);
+
+        // LCOV_EXCL_START
+        if (!t2dp)
+        {
+            Tase2Utility::log_debug (
+                "Skipping datapoint: %s, reason: t2dp is null",
+                dpJson.c_str ());
+            return false;
+        }
+        // LCOV_EXCL_STOP
+
+        if (!t2dp->inExchangedDefinitions ())
+        {
+            Tase2Utility::log_debug (
+                "Skipping datapoint: %s, reason: datapoints is not in "
+                "Exchanged Definitions",
+                dpJson.c_str ());
+            return false;
+        }
+
+        handleActCon (t2dp);
+
+        // LCOV_EXCL_START
+        if (t2dp->getType () != static_cast<DPTYPE> (record.type))
+        {
+            Tase2Utility::log_debug (
+                "Skipping datapoint: %s, reason: t2dp type mismatch",
+                dpJson.c_str ());
+            return false;
+        }
+        // LCOV_EXCL_STOP
+
+        traits = TASE2UpdateTable::get (t2dp->getType ());
+    }
+
+    /* command feedback only confirms outstanding commands */
+    if (!traits)
+    {
+        return false;
+    }
+
+    if (record.valueKind != traits->valueKind)
+    {
+        Tase2Utility::log_debug (
+            "Skipping datapoint: %s, reason: value type is not %s",
+            dpJson.c_str (),
+            traits->valueKind == PIVOT_VALUE_FLOAT ? "T_FLOAT" : "T_INTEGER");
+        return false;
+    }
+
+    if (t2dp->hasChangeFilter ()
+        && !t2dp->checkChange (record.intValue, record.floatValue,
+                               traits->valueKind == PIVOT_VALUE_FLOAT,
+                               record.dataFlags))
+    {
+        m_suppressedUpdates.fetch_add (1, std::memory_order_relaxed);
+
+        Tase2Utility::log_debug (
+            "Skipping datapoint: %s, reason: no significant change",
+            dpJson.c_str ());
+        return false;
+    }
+
+    update.point = t2dp;
+    update.type = t2dp->getType ();
+    update.intValue = record.intValue;
+    update.floatValue = record.floatValue;
+    update.dataFlags = record.dataFlags;
+    update.timestamp = record.timestamp;
+
+    return true;
+}
+
+void
+TASE2Server::applyUpdate (const TASE2PointUpdate& update)
+{
+    const TASE2UpdateTraits* traits = TASE2UpdateTable::get (update.type);
+
+    // LCOV_EXCL_START
+    if (!traits)
+    {
+        return;
+    }
+    // LCOV_EXCL_STOP
 
-            break; // LCOV_EXCL_LINE
-        }
+    Tase2_IndicationPoint ip = update.point->getIndicationPoint ();
+
+    traits->apply (ip, update);
+
+    Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
+
+    /* the next updates are filtered against what the model holds, not
+     * against values dropped or coalesced on the way */
+    if (update.point->hasChangeFilter ())
+    {
+        update.point->commitChange (update.intValue, update.floatValue,
+                                    traits->valueKind == PIVOT_VALUE_FLOAT,
+                                    update.dataFlags);
     }
+}
 
-    m_outstandingCommandsLock.unlock ();
+void
+TASE2Server::applyUpdates (const std::vector<TASE2PointUpdate>& updates)
+{
+    /* one critical section per chunk: the connection thread waits for at
+     * most TASE2_UPDATES_PER_LOCK model updates, not for the whole batch */
+    size_t next = 0;
+
+    while (next < updates.size ())
+    {
+        size_t end = std::min (updates.size (), next + TASE2_UPDATES_PER_LOCK);
+
+        m_connectionLock.lock ();
+
+        for (; next < end; next++)
+        {
+            applyUpdate (updates[next]);
+        }
+
+        m_connectionLock.unlock ();
+    }
 }
 
 uint32_t
@@ -534,12 +1281,28 @@ TASE2Server::send (const std::vector<Reading*>& readings)
 {
     int n = 0;
 
-    int readingsSent = 0;
+    std::lock_guard<std::mutex> configLock (m_configLock);
+
+    /* stopped, the model is gone */
+    if (!m_server)
+    {
+        return n;
+    }
+
+    /* decode and validate the whole batch without holding the model lock,
+     * the vector keeps its capacity between calls */
+    m_pendingUpdates.clear ();
 
     for (const auto& reading : readings)
     {
+        /* non-const accessors: they return references into the reading,
+         * the const overloads would copy */
         std::vector<Datapoint*> const& dataPoints = reading->getReadingData ();
-        std::string assetName = reading->getAssetName ();
+
+        /* Fledge returns the asset name by value, a name longer than the
+         * std::string small buffer is copied to the heap */
+        const TASE2AssetEntry* assetEntry
+            = m_config->getDatapointByAsset (reading->getAssetName ());
 
         for (Datapoint* dp : dataPoints)
         {
@@ -553,426 +1316,64 @@ TASE2Server::send (const std::vector<Reading*>& readings)
             }
             // LCOV_EXCL_STOP
 
-            Tase2Utility::log_debug ("Send dp -> %s",
-                                     dp->toJSONProperty ().c_str ());
-            readingsSent++;
-
-            // LCOV_EXCL_START
-            if (!Tase2_Server_isRunning (m_server))
-            {
-                Tase2Utility::log_debug (
-                    "Skipping datapoint: %s, reason: server is not running",
-                    dp->toJSONProperty ().c_str ());
-                continue;
-            }
-            // LCOV_EXCL_STOP
-
-            DatapointValue dpv = dp->getData ();
-
-            std::vector<Datapoint*> const* sdp = dpv.getDpVec ();
+            /* serialised once and only when it is going to be logged */
+            std::string dpJson;
 
-            std::string domain = "";
-            std::string name = "";
-            int type = -1;
-            Tase2_DataFlags dataFlags = 0;
-
-            bool hasTs = false;
-            uint64_t timestamp = 0;
-            bool hasTsValidity = false;
-
-            DatapointValue* value = nullptr;
-
-            for (Datapoint* objDp : *sdp)
+            if (Tase2Utility::isLogEnabled (Tase2Utility::LEVEL_DEBUG))
             {
-                DatapointValue attrVal = objDp->getData ();
-
-                if (objDp->getName () == "do_domain")
-                {
-                    domain = attrVal.toStringValue ();
-                }
-                else if (objDp->getName () == "do_name")
-                {
-                    name = attrVal.toStringValue ();
-                }
-
-                else if (objDp->getName () == "do_type")
-                {
-                    type = TASE2Datapoint::getDpTypeFromString (
-                        attrVal.toStringValue ());
-                }
-                else if (objDp->getName () == "do_value")
-                {
-                    value = new DatapointValue (attrVal);
-                }
-                else if (objDp->getName () == "do_validity")
-                {
-                    std::string validity = objDp->getData ().toStringValue ();
-                    if (validity == "valid")
-                        dataFlags
-                            |= TASE2_DATA_FLAGS_VALIDITY_VALID; // LCOV_EXCL_LINE
-                    else if (validity == "held")
-                        dataFlags |= TASE2_DATA_FLAGS_VALIDITY_HELD;
-                    else if (validity == "suspect")
-                        dataFlags |= TASE2_DATA_FLAGS_VALIDITY_SUSPECT;
-                    else if (validity == "invalid")
-                        dataFlags |= TASE2_DATA_FLAGS_VALIDITY_NOTVALID;
-                }
-                else if (objDp->getName () == "do_cs")
-                {
-                    std::string currentSource
-                        = objDp->getData ().toStringValue ();
-                    if (currentSource == "telemetered")
-                    {
-                        dataFlags
-                            |= TASE2_DATA_FLAGS_CURRENT_SOURCE_TELEMETERED; // LCOV_EXCL_LINE
-                    }
-                    else if (currentSource == "entered")
-                    {
-
-                        dataFlags |= TASE2_DATA_FLAGS_CURRENT_SOURCE_ENTERED;
-                    }
-                    else if (currentSource == "calculated")
-                    {
-                        dataFlags
-                            |= TASE2_DATA_FLAGS_CURRENT_SOURCE_CALCULATED;
-                    }
-                    else if (currentSource == "estimated")
-                    {
-                        dataFlags |= TASE2_DATA_FLAGS_CURRENT_SOURCE_ESTIMATED;
-                    }
-                }
-                else if (objDp->getName () == "do_quality_normal_value")
-                {
-                    std::string normalValue
-                        = objDp->getData ().toStringValue ();
-
-                    if (normalValue == "normal")
-                    {
-                        dataFlags |= TASE2_DATA_FLAGS_NORMAL_VALUE;
-                    }
-                }
-                else if (objDp->getName () == "do_ts")
-                {
-                    timestamp = (uint64_t)attrVal.toInt ();
-                    hasTs = true;
-                }
-                else if (objDp->getName () == "do_ts_validity")
-                {
-                    std::string tsValidity
-                        = objDp->getData ().toStringValue ();
-                    if (tsValidity == "invalid")
-                    {
-                    }
-                }
+                dpJson = dp->toJSONProperty ();
             }
 
-            handleActCon (domain, name);
+            Tase2Utility::log_debug ("Send dp -> %s", dpJson.c_str ());
 
-            DPTYPE dpType;
             // LCOV_EXCL_START
-            if (type == -1)
+            if (!Tase2_Server_isRunning (m_server))
             {
                 Tase2Utility::log_debug (
-                    "Skipping datapoint: %s, reason: type is -1",
-                    dp->toJSONProperty ().c_str ());
-                delete value;
+                    "Skipping datapoint: %s, reason: server is not running",
+                    dpJson.c_str ());
                 continue;
             }
             // LCOV_EXCL_STOP
-            dpType = static_cast<DPTYPE> (type);
-
-            std::shared_ptr<TASE2Datapoint> t2dp
-                = m_config->getDatapointByReference (domain, name);
 
-            // LCOV_EXCL_START
-            if (!t2dp)
-            {
-                Tase2Utility::log_debug (
-                    "Skipping datapoint: %s, reason: t2dp is null",
-                    dp->toJSONProperty ().c_str ());
-                delete value;
-                continue;
-            }
-            // LCOV_EXCL_STOP
+            TASE2PointUpdate update;
 
-            if (!t2dp->inExchangedDefinitions ())
+            if (!decodeUpdate (assetEntry, dp, dpJson, update))
             {
-                Tase2Utility::log_debug (
-                    "Skipping datapoint: %s, reason: datapoints is not in "
-                    "Exchanged Definitions",
-                    dp->toJSONProperty ().c_str ());
-                delete value;
                 continue;
             }
 
-            // LCOV_EXCL_START
-            if (t2dp->getType () != dpType)
+            if (m_ingestQueue)
             {
-                Tase2Utility::log_debug (
-                    "Skipping datapoint: %s, reason: t2dp type mismatch",
-                    dp->toJSONProperty ().c_str ());
-                delete value;
-                continue;
+                m_ingestQueue->push (update);
             }
-            // LCOV_EXCL_STOP
-
-            m_connectionLock.lock ();
-            switch (dpType)
+            else
             {
-            case REAL: {
-                Tase2Utility::log_debug ("Datapoint is REAL %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_FLOAT)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_FLOAT for REAL",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setReal (ip, (float)value->toDouble ());
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case REALQ: {
-                Tase2Utility::log_debug ("Datapoint is REALQ %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_FLOAT)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_FLOAT for REALQ",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setRealQ (ip, (float)value->toDouble (),
-                                                dataFlags);
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case REALQTIME:
-            case REALQTIMEEXT: {
-                Tase2Utility::log_debug ("Datapoint is REALQTIME %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_FLOAT)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_FLOAT for REALQTIME",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setRealQTimeStamp (
-                    ip, (float)value->toDouble (), dataFlags, timestamp);
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case STATE: {
-                Tase2Utility::log_debug ("Datapoint is STATE %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_INTEGER)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_INTEGER for STATE",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setState (
-                    ip, static_cast<Tase2_DataState> (value->toInt ()));
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case STATEQ: {
-                Tase2Utility::log_debug ("Datapoint is STATEQ %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_INTEGER)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_INTEGER for STATEQ",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setState (
-                    ip, static_cast<Tase2_DataState> (value->toInt ()
-                                                      | dataFlags));
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case STATEQTIME:
-            case STATEQTIMEEXT: {
-                Tase2Utility::log_debug ("Datapoint is STATEQTIME %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_INTEGER)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_INTEGER for STATEQTIME",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setStateTimeStamp (
-                    ip,
-                    static_cast<Tase2_DataState> (value->toInt () | dataFlags),
-                    timestamp);
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case DISCRETE: {
-                Tase2Utility::log_debug ("Datapoint is DISCRETE %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_INTEGER)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_INTEGER for DISCRETE",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setDiscrete (ip, value->toInt ());
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case DISCRETEQ: {
-                Tase2Utility::log_debug ("Datapoint is DISCRETEQ %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_INTEGER)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_INTEGER for DISCRETEQ",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setDiscreteQ (ip, value->toInt (),
-                                                    dataFlags);
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case DISCRETEQTIME:
-            case DISCRETEQTIMEEXT: {
-                Tase2Utility::log_debug ("Datapoint is DISCRETEQTIMEEXT %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_INTEGER)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_INTEGER for DISCRETEQTIMEEXT",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setDiscreteQTimeStamp (
-                    ip, value->toInt (), dataFlags, timestamp);
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case STATESUP: {
-                Tase2Utility::log_debug ("Datapoint is STATESUP %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_INTEGER)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_INTEGER for STATESUP",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setStateSupplemental (
-                    ip, static_cast<Tase2_DataStateSupplemental> (
-                            value->toInt ()));
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case STATESUPQ: {
-                Tase2Utility::log_debug ("Datapoint is STATESUPQ %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_INTEGER)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_INTEGER for STATESUPQ",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setStateSupplementalQ (
-                    ip,
-                    static_cast<Tase2_DataStateSupplemental> (value->toInt ()),
-                    dataFlags);
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
-            }
-            case STATESUPQTIME:
-            case STATESUPQTIMEEXT: {
-                Tase2Utility::log_debug ("Datapoint is STATESUPQTIMEEXT %s",
-                                         dp->toJSONProperty ().c_str ());
-                if (value->getType () != DatapointValue::T_INTEGER)
-                {
-                    Tase2Utility::log_debug (
-                        "Skipping datapoint: %s, reason: value type is not "
-                        "T_INTEGER for STATESUPQTIMEEXT",
-                        dp->toJSONProperty ().c_str ());
-                    m_connectionLock.unlock ();
-                    delete value;
-                    continue;
-                }
-                Tase2_IndicationPoint ip = t2dp->getIndicationPoint ();
-                Tase2_IndicationPoint_setStateSupplementalQTimeStamp (
-                    ip,
-                    static_cast<Tase2_DataStateSupplemental> (value->toInt ()),
-                    dataFlags, timestamp);
-                Tase2_Server_updateOnlineValue (m_server, (Tase2_DataPoint)ip);
-                break; // LCOV_EXCL_LINE
+                m_pendingUpdates.push_back (update);
             }
-            }
-            m_connectionLock.unlock ();
-
-            delete value;
         }
         n++;
     }
 
+    if (!m_ingestQueue)
+    {
+        if (m_coalescer)
+        {
+            m_coalescer->coalesce (m_pendingUpdates);
+        }
+
+        applyUpdates (m_pendingUpdates);
+    }
+
     return n;
 }
 
-void
-TASE2Server::configure (const ConfigCategory* config)
+bool
+TASE2Server::readConfig (const ConfigCategory* config,
+                         std::string& stackConfig,
+                         std::string& exchangeConfig, std::string& tlsConfig,
+                         std::string& modelConfig)
 {
-    Tase2Utility::log_info ("configure called"); // LCOV_EXCL_LINE
-
     if (config->itemExists ("name"))
         m_name = config->getValue ("name"); // LCOV_EXCL_LINE
     else
@@ -983,42 +1384,42 @@ TASE2Server::configure (const ConfigCategory* config)
     {
         Tase2Utility::log_error (
             "Missing protocol configuration"); // LCOV_EXCL_LINE
-        return;
+        return false;
     }
 
     if (config->itemExists ("exchanged_data") == false)
     {
         Tase2Utility::log_error (
             "Missing exchange data configuration"); // LCOV_EXCL_LINE
-        return;
+        return false;
     }
 
     if (config->itemExists ("model_conf") == false)
     {
         Tase2Utility::log_error ("Missing model configuration");
-        return;
+        return false;
     }
 
-    std::string protocolStack = config->getValue ("protocol_stack");
+    stackConfig = config->getValue ("protocol_stack");
 
-    std::string dataExchange = config->getValue ("exchanged_data");
+    exchangeConfig = config->getValue ("exchanged_data");
 
-    std::string modelConf = config->getValue ("model_conf");
+    modelConfig = config->getValue ("model_conf");
 
-    if (protocolStack.empty ())
+    if (stackConfig.empty ())
     {
-        protocolStack = config->getDefault ("protocol_stack");
+        stackConfig = config->getDefault ("protocol_stack");
     }
-    if (dataExchange.empty ())
+    if (exchangeConfig.empty ())
     {
-        dataExchange = config->getDefault ("exchanged_data");
+        exchangeConfig = config->getDefault ("exchanged_data");
     }
-    if (modelConf.empty ())
+    if (modelConfig.empty ())
     {
-        modelConf = config->getDefault ("model_conf");
+        modelConfig = config->getDefault ("model_conf");
     }
 
-    std::string tlsConfig = "";
+    tlsConfig = "";
 
     if (config->itemExists ("tls_conf") == false)
     {
@@ -1030,9 +1431,212 @@ TASE2Server::configure (const ConfigCategory* config)
         tlsConfig = config->getValue ("tls_conf");
     }
 
+    /* opt-in, a snapshot is only written for a named plugin */
+    setModelSnapshotPath ("");
+
+    if (config->itemExists ("model_snapshot")
+        && config->getValue ("model_snapshot") == "true")
+    {
+        if (m_name.empty ())
+        {
+            Tase2Utility::log_warn ("Model snapshot needs a server name");
+        }
+        else
+        {
+            std::string varDir = getDataDir () + "/var";
+            std::string snapshotDir = varDir + "/tase2";
+
+            if ((mkdir (varDir.c_str (), 0755) == 0 || errno == EEXIST)
+                && (mkdir (snapshotDir.c_str (), 0755) == 0
+                    || errno == EEXIST))
+            {
+                setModelSnapshotPath (snapshotDir + "/" + m_name + ".model");
+            }
+            else
+            {
+                Tase2Utility::log_warn (
+                    "Cannot create %s, model snapshot disabled: %s",
+                    snapshotDir.c_str (), strerror (errno));
+            }
+        }
+    }
+
+    return true;
+}
+
+void
+TASE2Server::configure (const ConfigCategory* config)
+{
+    Tase2Utility::log_info ("configure called"); // LCOV_EXCL_LINE
+
+    std::string protocolStack;
+    std::string dataExchange;
+    std::string tlsConfig;
+    std::string modelConf;
+
+    if (!readConfig (config, protocolStack, dataExchange, tlsConfig,
+                     modelConf))
+    {
+        return;
+    }
+
     setJsonConfig (protocolStack, dataExchange, tlsConfig, modelConf);
 }
 
+void
+TASE2Server::reconfigure (const ConfigCategory* config)
+{
+    Tase2Utility::log_info ("reconfigure called"); // LCOV_EXCL_LINE
+
+    std::string protocolStack;
+    std::string dataExchange;
+    std::string tlsConfig;
+    std::string modelConf;
+
+    if (!readConfig (config, protocolStack, dataExchange, tlsConfig,
+                     modelConf))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> configLock (m_configLock);
+
+    /* imported on its own model first, to be compared with the running
+     * one; becomes the running model when the server is rebuilt */
+    TASE2Config* next = new TASE2Config ();
+    Tase2_DataModel nextModel = nullptr;
+
+    bool replayed = importModel (modelConf, dataExchange, next, nextModel);
+
+    const char* reason = nullptr;
+
+    if (!m_server)
+    {
+        reason = "no server";
+    }
+    else if (next->getModelShape () != m_config->getModelShape ())
+    {
+        reason = "model changed";
+    }
+    else if (protocolStack != m_stackConfigJson)
+    {
+        reason = "protocol stack changed";
+    }
+    else if (tlsConfig != m_tlsConfigJson)
+    {
+        reason = "TLS configuration changed";
+    }
+
+    if (reason)
+    {
+        Tase2Utility::log_info ("Rebuilding the server, reason: %s", reason);
+
+        m_modelReplayed = replayed;
+
+        rebuildServer (next, nextModel, protocolStack, tlsConfig);
+        return;
+    }
+
+    updateServer (*next);
+
+    discardModel (next, nextModel);
+}
+
+void
+TASE2Server::rebuildServer (TASE2Config* config, Tase2_DataModel model,
+                            const std::string& stackConfig,
+                            const std::string& tlsConfig)
+{
+    bool started = m_started;
+
+    /* drops the client associations, publishes what is still queued */
+    stopLocked ();
+
+    removeAllOutstandingCommands ();
+
+    delete m_ingestQueue;
+    delete m_coalescer;
+    delete m_commandQueue;
+
+    m_ingestQueue = nullptr;
+    m_coalescer = nullptr;
+    m_commandQueue = nullptr;
+
+    if (m_tlsConfig)
+    {
+        TLSConfiguration_destroy (m_tlsConfig);
+        m_tlsConfig = nullptr;
+    }
+
+    /* stop has destroyed the model */
+    discardModel (m_config, nullptr);
+
+    m_config = config;
+    m_model = model;
+
+    createServer (stackConfig, tlsConfig);
+
+    if (started)
+    {
+        start ();
+    }
+}
+
+void
+TASE2Server::updateServer (const TASE2Config& config)
+{
+    size_t points = m_config->updatePointOptions (config);
+
+    /* the command handlers take the buckets under this lock */
+    m_outstandingCommandsLock.lock ();
+
+    size_t rateLimits = m_config->updateCommandRateLimits (config);
+
+    const TASE2RateLimit& global = m_config->GlobalCommandRateLimit ();
+    TASE2RateLimit current = m_commandRate.getLimit ();
+    TASE2RateLimit applied = TASE2TokenBucket (global).getLimit ();
+
+    if (current.rate != applied.rate || current.burst != applied.burst)
+    {
+        m_commandRate.configure (global);
+        rateLimits++;
+    }
+
+    m_outstandingCommandsLock.unlock ();
+
+    std::vector<Tase2_BilateralTable> added;
+    std::vector<Tase2_BilateralTable> removed;
+
+    m_config->updateBilateralTables (config, added, removed);
+
+    /* clients of the other tables keep their associations */
+    m_connectionLock.lock ();
+
+    for (Tase2_BilateralTable blt : removed)
+    {
+        Tase2_Server_removeBilateralTable (m_server, blt);
+    }
+
+    for (Tase2_BilateralTable blt : added)
+    {
+        Tase2Utility::log_debug ("Adding Bilateral Table '%s' to the server",
+                                 Tase2_BilateralTable_getID (blt));
+        Tase2_Server_addBilateralTable (m_server, blt);
+    }
+
+    m_connectionLock.unlock ();
+
+    for (Tase2_BilateralTable blt : removed)
+    {
+        Tase2_BilateralTable_destroy (blt);
+    }
+
+    Tase2Utility::log_info (
+        "Reconfigured without restart: %zu datapoints, %zu rate limits "
+        "changed, %zu bilateral tables added, %zu removed",
+        points, rateLimits, added.size (), removed.size ());
+}
+
 void
 TASE2Server::registerControl (
     int (*operation) (char* operation, int paramCount, char* names[],
@@ -0,0 +1,31 @@
+#include "tase2_backoff.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+TASE2Backoff::TASE2Backoff (uint64_t minInterval, uint64_t maxInterval)
+    : m_minInterval (std::max<uint64_t> (minInterval, 1)),
+      m_maxInterval (std::max (maxInterval, m_minInterval)),
+      m_interval (m_minInterval),
+      m_random (static_cast<std::minstd_rand::result_type> (
+          std::chrono::steady_clock::now ().time_since_epoch ().count ()))
+{
+}
+
+uint64_t
+TASE2Backoff::next ()
+{
+    uint64_t interval = m_interval;
+
+    m_interval = std::min (m_interval * 2, m_maxInterval);
+
+    uint64_t half = interval / 2;
+
+    return interval - half + m_random () % (half + 1);
+}
+
+void
+TASE2Backoff::reset ()
+{
+    m_interval = m_minInterval;
+}
@@ -0,0 +1,67 @@
+#include "tase2_coalescer.hpp"
+
+TASE2UpdateCoalescer::TASE2UpdateCoalescer (size_t pointCount)
+    : m_dirty ((pointCount + 63) / 64, 0)
+{
+}
+
+bool
+TASE2UpdateCoalescer::testAndSet (uint32_t id)
+{
+    uint64_t& word = m_dirty[id / 64];
+    uint64_t bit = 1ULL << (id % 64);
+
+    bool isSet = (word & bit) != 0;
+
+    word |= bit;
+
+    return isSet;
+}
+
+void
+TASE2UpdateCoalescer::clear (uint32_t id)
+{
+    m_dirty[id / 64] &= ~(1ULL << (id % 64));
+}
+
+void
+TASE2UpdateCoalescer::coalesce (std::vector<TASE2PointUpdate>& updates)
+{
+    if (updates.size () < 2)
+    {
+        return;
+    }
+
+    /* walk backwards so the first update seen for a point is its newest
+     * one, survivors are packed towards the end of the vector */
+    size_t keep = updates.size ();
+
+    for (size_t i = updates.size (); i-- > 0;)
+    {
+        TASE2Datapoint* point = updates[i].point;
+        uint32_t id = point->getPointId ();
+
+        if (!point->isCoalesceExempt () && id / 64 < m_dirty.size ()
+            && testAndSet (id))
+        {
+            continue;
+        }
+
+        updates[--keep] = updates[i];
+    }
+
+    /* the bits of the survivors are the only ones set */
+    for (size_t i = keep; i < updates.size (); i++)
+    {
+        uint32_t id = updates[i].point->getPointId ();
+
+        if (id / 64 < m_dirty.size ())
+        {
+            clear (id);
+        }
+    }
+
+    m_coalesced += keep;
+
+    updates.erase (updates.begin (), updates.begin () + keep);
+}
@@ -0,0 +1,72 @@
+#include "tase2_command_params.hpp"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+char* TASE2CommandParams::s_names[CMD_PARAMETER_COUNT]
+    = { (char*)"co_type", (char*)"co_scope", (char*)"co_domain",
+        (char*)"co_name", (char*)"co_value", (char*)"co_se",
+        (char*)"co_ts" };
+
+TASE2CommandParams::TASE2CommandParams (const std::string& domain,
+                                        const std::string& name,
+                                        Tase2_ControlPointType type)
+    : m_scope (domain == "vcc" ? "vcc" : "domain"), m_domain (domain),
+      m_name (name), m_type (type)
+{
+    switch (type)
+    {
+    case TASE2_CONTROL_TYPE_SETPOINT_DESCRETE:
+        m_parameters[CMD_TYPE] = (char*)"SetPointDiscrete";
+        break;
+    case TASE2_CONTROL_TYPE_SETPOINT_REAL:
+        m_parameters[CMD_TYPE] = (char*)"SetPointReal";
+        break;
+    default:
+        m_parameters[CMD_TYPE] = (char*)"Command";
+        break;
+    }
+
+    m_parameters[CMD_SCOPE] = (char*)m_scope.c_str ();
+    m_parameters[CMD_DOMAIN] = (char*)m_domain.c_str ();
+    m_parameters[CMD_NAME] = (char*)m_name.c_str ();
+    m_parameters[CMD_VALUE] = nullptr;
+    m_parameters[CMD_SELECT] = nullptr;
+    m_parameters[CMD_TS] = nullptr;
+}
+
+void
+TASE2CommandParams::build (char* parameters[CMD_PARAMETER_COUNT],
+                           const Tase2_OperateValue* value, bool select,
+                           uint64_t ts, char* valueBuffer,
+                           char* tsBuffer) const
+{
+    memcpy (parameters, m_parameters, sizeof (m_parameters));
+
+    valueBuffer[0] = '\0';
+
+    if (!select && value)
+    {
+        switch (m_type)
+        {
+        case TASE2_CONTROL_TYPE_COMMAND:
+            snprintf (valueBuffer, TASE2_COMMAND_VALUE_SIZE, "%d",
+                      (int)value->commandValue);
+            break;
+        case TASE2_CONTROL_TYPE_SETPOINT_DESCRETE:
+            snprintf (valueBuffer, TASE2_COMMAND_VALUE_SIZE, "%d",
+                      (int)value->discreteValue);
+            break;
+        case TASE2_CONTROL_TYPE_SETPOINT_REAL:
+            snprintf (valueBuffer, TASE2_COMMAND_VALUE_SIZE, "%f",
+                      value->realValue);
+            break;
+        }
+    }
+
+    snprintf (tsBuffer, TASE2_COMMAND_TS_SIZE, "%" PRIu64, ts);
+
+    parameters[CMD_VALUE] = valueBuffer;
+    parameters[CMD_SELECT] = (char*)(select ? "1" : "0");
+    parameters[CMD_TS] = tsBuffer;
+}
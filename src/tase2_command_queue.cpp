@@ -0,0 +1,63 @@
+#include "tase2_command_queue.hpp"
+
+TASE2CommandQueue::TASE2CommandQueue (size_t capacity)
+    : m_capacity (capacity > 0 ? capacity : 1)
+{
+}
+
+bool
+TASE2CommandQueue::push (const TASE2CommandRequest& request)
+{
+    {
+        std::lock_guard<std::mutex> lock (m_lock);
+
+        if (m_closed || m_requests.size () >= m_capacity)
+        {
+            return false;
+        }
+
+        m_requests.push_back (request);
+    }
+
+    m_condition.notify_one ();
+
+    return true;
+}
+
+bool
+TASE2CommandQueue::pop (TASE2CommandRequest& request)
+{
+    std::unique_lock<std::mutex> lock (m_lock);
+
+    m_condition.wait (lock,
+                      [this] { return m_closed || !m_requests.empty (); });
+
+    if (m_requests.empty ())
+    {
+        return false;
+    }
+
+    request = m_requests.front ();
+    m_requests.pop_front ();
+
+    return true;
+}
+
+void
+TASE2CommandQueue::close ()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_lock);
+        m_closed = true;
+    }
+
+    m_condition.notify_all ();
+}
+
+size_t
+TASE2CommandQueue::size ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    return m_requests.size ();
+}
@@ -1,11 +1,15 @@
 #include <arpa/inet.h>
 
+#include <cstdio>
 #include <memory>
 #include <string>
 
 #include "tase2.hpp"
 #include "tase2_config.hpp"
 #include "tase2_datapoint.hpp"
+#include "tase2_import_pool.hpp"
+#include "tase2_model_reader.hpp"
+#include "tase2_model_snapshot.hpp"
 
 using namespace rapidjson;
 
@@ -13,30 +17,1010 @@ using namespace rapidjson;
 #define JSON_DATAPOINTS "datapoints"
 #define JSON_PROTOCOLS "protocols"
 #define JSON_LABEL "label"
+#define JSON_PIVOT_ID "pivot_id"
 
 #define PROTOCOL_TASE2 "tase2"
 #define JSON_PROT_NAME "name"
 #define JSON_PROT_REF "ref"
 #define JSON_PROT_CDC "cdc"
 
+#define FNV_PRIME 0x100000001b3ULL
+
 TASE2Config::TASE2Config () = default;
 
-TASE2Config::~TASE2Config () = default;
+TASE2Config::~TASE2Config () = default;
+
+bool
+TASE2Config::isValidIPAddress (const std::string& addrStr)
+{
+    // see
+    // https://stackoverflow.com/questions/318236/how-do-you-validate-that-a-string-is-a-valid-ipv4-address-in-c
+    struct sockaddr_in sa;
+    int result = inet_pton (AF_INET, addrStr.c_str (), &(sa.sin_addr));
+
+    return (result == 1);
+}
+
+TASE2IndicationOptions
+TASE2Config::importIndicationOptions (const Value& datapoint,
+                                      const std::string& label, DPTYPE type)
+{
+    bool soe = false;
+
+    if (datapoint.HasMember ("soe"))
+    {
+        if (datapoint["soe"].IsBool ())
+        {
+            soe = datapoint["soe"].GetBool ();
+        }
+        else
+        {
+            Tase2Utility::log_warn ("Invalid soe attribute for %s -> ignore",
+                                    label.c_str ());
+        }
+    }
+
+    TASE2IndicationOptions options;
+
+    options.coalesceExempt = datapoint["hasCOV"].GetBool () || soe;
+
+    double deadband = 0.0;
+    double deadbandPercent = 0.0;
+    bool suppressIdentical = false;
+
+    /* deadbands only make sense for analog values */
+    bool isAnalog = type <= REALQTIMEEXT
+                    || (type >= DISCRETE && type <= DISCRETEQTIMEEXT);
+
+    if (datapoint.HasMember ("deadband"))
+    {
+        if (isAnalog && datapoint["deadband"].IsNumber ()
+            && datapoint["deadband"].GetDouble () >= 0.0)
+        {
+            deadband = datapoint["deadband"].GetDouble ();
+        }
+        else
+        {
+            Tase2Utility::log_warn ("Invalid deadband for %s -> ignore",
+                                    label.c_str ());
+        }
+    }
+
+    if (datapoint.HasMember ("deadband_percent"))
+    {
+        if (isAnalog && datapoint["deadband_percent"].IsNumber ()
+            && datapoint["deadband_percent"].GetDouble () >= 0.0)
+        {
+            deadbandPercent = datapoint["deadband_percent"].GetDouble ();
+        }
+        else
+        {
+            Tase2Utility::log_warn (
+                "Invalid deadband_percent for %s -> ignore",
+                label.c_str ());
+        }
+    }
+
+    if (datapoint.HasMember ("suppress_identical"))
+    {
+        if (datapoint["suppress_identical"].IsBool ())
+        {
+            suppressIdentical = datapoint["suppress_identical"].GetBool ();
+        }
+        else
+        {
+            Tase2Utility::log_warn (
+                "Invalid suppress_identical for %s -> ignore",
+                label.c_str ());
+        }
+    }
+
+    options.deadband = deadband;
+    options.deadbandPercent = deadbandPercent;
+    options.suppressIdentical = suppressIdentical;
+
+    return options;
+}
+
+bool
+TASE2Config::importRateLimit (const Value& value, const char* what,
+                              TASE2RateLimit& limit)
+{
+    if (!value.IsObject () || !value.HasMember ("rate")
+        || !value["rate"].IsNumber () || value["rate"].GetDouble () < 0.0)
+    {
+        Tase2Utility::log_warn ("Invalid rate limit for %s -> ignore", what);
+        return false;
+    }
+
+    limit.rate = value["rate"].GetDouble ();
+    limit.burst = limit.rate;
+
+    if (value.HasMember ("burst"))
+    {
+        if (value["burst"].IsNumber () && value["burst"].GetDouble () >= 1.0)
+        {
+            limit.burst = value["burst"].GetDouble ();
+        }
+        else
+        {
+            Tase2Utility::log_warn ("Invalid burst for %s -> using rate",
+                                    what);
+        }
+    }
+
+    return true;
+}
+
+std::string
+TASE2PointRange::name (uint32_t index) const
+{
+    char number[16];
+
+    snprintf (number, sizeof (number), "%0*u", digits, index);
+
+    return prefix + number;
+}
+
+bool
+TASE2Config::importPointRange (const Value& value, TASE2PointRange& range)
+{
+    if (!value.HasMember ("prefix") || !value["prefix"].IsString ())
+    {
+        Tase2Utility::log_error ("RANGE HAS NO prefix");
+        return false;
+    }
+
+    if (!value.HasMember ("range") || !value["range"].IsArray ()
+        || value["range"].Size () != 2)
+    {
+        Tase2Utility::log_error ("RANGE OF %s NOT [ first, last ]",
+                                 value["prefix"].GetString ());
+        return false;
+    }
+
+    const Value& bounds = value["range"];
+
+    if (!bounds[0u].IsUint () || !bounds[1u].IsUint ())
+    {
+        Tase2Utility::log_error ("RANGE OF %s NOT [ first, last ]",
+                                 value["prefix"].GetString ());
+        return false;
+    }
+
+    range.prefix = value["prefix"].GetString ();
+    range.first = bounds[0u].GetUint ();
+    range.last = bounds[1u].GetUint ();
+    range.digits = 0;
+
+    if (range.first > range.last
+        || range.last - range.first >= TASE2_RANGE_MAX_POINTS)
+    {
+        Tase2Utility::log_error ("Invalid range %u-%u of %s", range.first,
+                                 range.last, range.prefix.c_str ());
+        return false;
+    }
+
+    if (value.HasMember ("digits"))
+    {
+        if (!value["digits"].IsInt () || value["digits"].GetInt () < 0
+            || value["digits"].GetInt () > 10)
+        {
+            Tase2Utility::log_error ("Invalid digits for range of %s",
+                                     range.prefix.c_str ());
+            return false;
+        }
+
+        range.digits = value["digits"].GetInt ();
+    }
+
+    return true;
+}
+
+void
+TASE2Config::selectDatapoints (const std::string& domain,
+                               const Value& selector,
+                               std::vector<std::string>& names) const
+{
+    if (!selector.IsObject ())
+    {
+        Tase2Utility::log_error ("DATAPOINT NOT AN OBJECT");
+        return;
+    }
+
+    if (selector.HasMember ("name") && selector["name"].IsString ())
+    {
+        names.push_back (selector["name"].GetString ());
+        return;
+    }
+
+    if (selector.HasMember ("prefix"))
+    {
+        TASE2PointRange range;
+
+        if (!importPointRange (selector, range))
+        {
+            return;
+        }
+
+        for (uint32_t i = 0; i <= range.last - range.first; i++)
+        {
+            names.push_back (range.name (range.first + i));
+        }
+
+        return;
+    }
+
+    if (selector.HasMember ("tag") && selector["tag"].IsString ())
+    {
+        auto domainTags = m_tags.find (domain);
+
+        if (domainTags != m_tags.end ())
+        {
+            auto tag = domainTags->second.find (selector["tag"].GetString ());
+
+            if (tag != domainTags->second.end ())
+            {
+                for (TASE2Datapoint* t2dp : tag->second)
+                {
+                    names.push_back (t2dp->getLabel ());
+                }
+
+                return;
+            }
+        }
+
+        Tase2Utility::log_warn ("No datapoint with tag %s in domain %s",
+                                selector["tag"].GetString (),
+                                domain.c_str ());
+        return;
+    }
+
+    Tase2Utility::log_error ("DATAPOINT HAS NO NAME");
+}
+
+TASE2RateLimit
+TASE2Config::importControlOptions (const Value& datapoint,
+                                   const std::string& label) const
+{
+    TASE2RateLimit limit = m_pointCommandRateLimit;
+
+    if (datapoint.HasMember ("rate_limit"))
+    {
+        importRateLimit (datapoint["rate_limit"], label.c_str (), limit);
+    }
+
+    return limit;
+}
+
+void
+TASE2Config::importCommandRateLimits (const Value& rateLimit)
+{
+    TASE2RateLimit global = m_globalCommandRateLimit;
+    TASE2RateLimit point = m_pointCommandRateLimit;
+
+    if (rateLimit.HasMember ("global"))
+    {
+        importRateLimit (rateLimit["global"], "all control points", global);
+    }
+
+    if (rateLimit.HasMember ("point"))
+    {
+        importRateLimit (rateLimit["point"], "control points", point);
+    }
+
+    setCommandRateLimits (global, point);
+}
+
+void
+TASE2Config::setCommandRateLimits (const TASE2RateLimit& global,
+                                   const TASE2RateLimit& point)
+{
+    m_globalCommandRateLimit = global;
+    m_pointCommandRateLimit = point;
+
+    if (m_snapshot)
+    {
+        m_snapshot->addRateLimits (global, point);
+    }
+}
+
+Tase2_Domain
+TASE2Config::importDomain (const std::string& name, Tase2_DataModel model)
+{
+    Tase2_Domain icc = Tase2_DataModel_addDomain (model, name.c_str ());
+
+    m_domains[name] = icc;
+
+    addToModelShape (name);
+
+    if (m_snapshot)
+    {
+        m_snapshot->addDomain (name);
+    }
+
+    return icc;
+}
+
+bool
+TASE2Config::importDatapoint (const Value& datapoint,
+                              const std::string& domainName,
+                              Tase2_Domain domain)
+{
+    std::vector<TASE2PreparedPoint> points;
+
+    TASE2PrepareResult result = prepareDatapoints (datapoint, points);
+
+    for (const TASE2PreparedPoint& point : points)
+    {
+        commitDatapoint (domainName, domain, point);
+    }
+
+    return result != PREPARE_STOP;
+}
+
+/* one point, or one per name of a range */
+TASE2PrepareResult
+TASE2Config::prepareDatapoints (const Value& datapoint,
+                                std::vector<TASE2PreparedPoint>& points) const
+{
+    TASE2PreparedPoint point;
+    TASE2PrepareResult result = prepareDatapoint (datapoint, point);
+
+    if (result != PREPARE_POINT)
+    {
+        return result;
+    }
+
+    if (!datapoint.HasMember ("prefix"))
+    {
+        points.push_back (std::move (point));
+        return PREPARE_POINT;
+    }
+
+    TASE2PointRange range;
+
+    if (!importPointRange (datapoint, range))
+    {
+        return PREPARE_STOP;
+    }
+
+    points.reserve (points.size () + range.last - range.first + 1);
+
+    for (uint32_t i = 0; i <= range.last - range.first; i++)
+    {
+        points.push_back (point);
+        points.back ().name = range.name (range.first + i);
+    }
+
+    return PREPARE_POINT;
+}
+
+TASE2PrepareResult
+TASE2Config::prepareDatapoint (const Value& datapoint,
+                               TASE2PreparedPoint& point) const
+{
+    if (!datapoint.IsObject ())
+    {
+        Tase2Utility::log_error ("DATAPOINT NOT AN OBJECT");
+        return PREPARE_STOP;
+    }
+    /* a range is named by its prefix until it is expanded */
+    const char* nameMember
+        = datapoint.HasMember ("prefix") ? "prefix" : "name";
+
+    if (!datapoint.HasMember (nameMember)
+        || !datapoint[nameMember].IsString ())
+    {
+        Tase2Utility::log_error ("DATAPOINT HAS NO NAME");
+        return PREPARE_STOP;
+    }
+    if (!datapoint.HasMember ("type") || !datapoint["type"].IsString ())
+    {
+        Tase2Utility::log_error ("DATAPOINT HAS NO TYPE");
+        return PREPARE_STOP;
+    }
+
+    DPTYPE type
+        = TASE2Datapoint::getDpTypeFromString (datapoint["type"].GetString ());
+
+    if (type == DP_TYPE_UNKNOWN)
+    {
+        Tase2Utility::log_error ("Invalid dp type %s",
+                                 datapoint["type"].GetString ());
+        return PREPARE_SKIP;
+    }
+
+    point.name = datapoint[nameMember].GetString ();
+    point.type = type;
+
+    if (datapoint.HasMember ("tag"))
+    {
+        if (!datapoint["tag"].IsString ())
+        {
+            Tase2Utility::log_error ("Invalid tag of datapoint %s",
+                                     point.name.c_str ());
+            return PREPARE_SKIP;
+        }
+
+        point.tag = datapoint["tag"].GetString ();
+    }
+
+    if (TASE2Datapoint::isCommand (type))
+    {
+        if (!datapoint.HasMember ("mode") || !datapoint["mode"].IsString ())
+        {
+            Tase2Utility::log_error ("CONTROL POINT HAS NO mode attribute ");
+            return PREPARE_SKIP;
+        }
+        if (!datapoint.HasMember ("hasTag") || !datapoint["hasTag"].IsBool ())
+        {
+            Tase2Utility::log_error ("CONTROL POINT HAS NO hasTag attribute ");
+            return PREPARE_SKIP;
+        }
+
+        if (!datapoint.HasMember ("checkBackId")
+            || !datapoint["checkBackId"].IsInt ())
+        {
+            Tase2Utility::log_error (
+                "CONTROL POINT HAS NO checkBackId attribute ");
+            return PREPARE_SKIP;
+        }
+
+        point.deviceClass = static_cast<Tase2_DeviceClass> (
+            strcmp (datapoint["mode"].GetString (), "sbo") != 0);
+
+        Tase2Utility::log_debug ("Device class is %d", point.deviceClass);
+
+        point.hasTag = datapoint["hasTag"].GetBool ();
+        point.checkBackId = (int16_t)datapoint["checkBackId"].GetInt ();
+        point.limit = importControlOptions (datapoint, point.name);
+    }
+    else
+    {
+        if (!datapoint.HasMember ("hasCOV") || !datapoint["hasCOV"].IsBool ())
+        {
+            Tase2Utility::log_error (
+                "INDICATION POINT HAS NO hasCOV attribute ");
+            return PREPARE_STOP;
+        }
+
+        point.hasCOV = datapoint["hasCOV"].GetBool ();
+        point.options = importIndicationOptions (datapoint, point.name, type);
+    }
+
+    return PREPARE_POINT;
+}
+
+TASE2Datapoint*
+TASE2Config::commitDatapoint (const std::string& domainName,
+                              Tase2_Domain domain,
+                              const TASE2PreparedPoint& point)
+{
+    TASE2Datapoint* t2dp;
+
+    if (TASE2Datapoint::isCommand (point.type))
+    {
+        t2dp = addControlPoint (domainName, domain, point.name, point.type,
+                                point.deviceClass, point.hasTag,
+                                point.checkBackId, point.limit);
+    }
+    else
+    {
+        t2dp = addIndicationPoint (domainName, domain, point.name,
+                                   point.type, point.hasCOV, point.options);
+    }
+
+    /* a duplicate, skipped */
+    if (!t2dp)
+    {
+        return nullptr;
+    }
+
+    if (!point.tag.empty ())
+    {
+        m_tags[domainName][point.tag].push_back (t2dp);
+    }
+
+    Tase2Utility::log_debug (
+        "Add datapoint %s to domain %s, %zu datapoints present",
+        t2dp->getLabel ().c_str (), domainName.c_str (), m_points.size ());
+
+    return t2dp;
+}
+
+void
+TASE2Config::prepareIcc (const Value& iccValue, TASE2PreparedIcc& icc) const
+{
+    icc.hasName = iccValue.IsObject () && iccValue.HasMember ("name")
+                  && iccValue["name"].IsString ();
+
+    /* nothing of this ICC is imported */
+    if (!icc.hasName)
+    {
+        return;
+    }
+
+    icc.name = iccValue["name"].GetString ();
+    icc.hasDatapoints = iccValue.HasMember ("datapoints")
+                        && iccValue["datapoints"].IsArray ();
+
+    if (!icc.hasDatapoints)
+    {
+        return;
+    }
+
+    const Value& iccDatapoints = iccValue["datapoints"];
+
+    icc.points.reserve (iccDatapoints.Size ());
+
+    for (const Value& datapoint : iccDatapoints.GetArray ())
+    {
+        if (!prepareIccPoint (datapoint, icc))
+        {
+            return;
+        }
+    }
+}
+
+bool
+TASE2Config::prepareIccPoint (const Value& datapoint,
+                              TASE2PreparedIcc& icc) const
+{
+    if (prepareDatapoints (datapoint, icc.points) == PREPARE_STOP)
+    {
+        icc.stop = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool
+TASE2Config::commitIcc (const TASE2PreparedIcc& icc, Tase2_DataModel model)
+{
+    if (!icc.hasName)
+    {
+        Tase2Utility::log_error ("ICC MISSING NAME");
+        return false;
+    }
+
+    Tase2_Domain domain = importDomain (icc.name, model);
+
+    if (!icc.hasDatapoints)
+    {
+        Tase2Utility::log_error ("ICC MISSING DATAPOINTS");
+        return false;
+    }
+
+    for (const TASE2PreparedPoint& point : icc.points)
+    {
+        commitDatapoint (icc.name, domain, point);
+    }
+
+    return !icc.stop;
+}
+
+TASE2Datapoint*
+TASE2Config::addIndicationPoint (const std::string& domainName,
+                                 Tase2_Domain domain, const std::string& name,
+                                 DPTYPE type, bool hasCOV,
+                                 const TASE2IndicationOptions& options)
+{
+    TASE2Datapoint* t2dp = m_points.insert (domainName, name, type);
+
+    /* before anything is added to the model */
+    if (!t2dp)
+    {
+        Tase2Utility::log_error ("Duplicate datapoint %s in domain %s",
+                                 name.c_str (), domainName.c_str ());
+        return nullptr;
+    }
+
+    Tase2_QualityClass qClass = TASE2Datapoint::getQualityClass (type);
+    Tase2_TimeStampClass tsClass = TASE2Datapoint::getTimeStampClass (type);
+    Tase2_IndicationPointType indType
+        = TASE2Datapoint::toIndicationPointType (type);
+
+    t2dp->setIndicationPoint (Tase2_Domain_addIndicationPoint (
+        domain, name.c_str (), indType, qClass, tsClass, hasCOV, true));
+
+    t2dp->setCoalesceExempt (options.coalesceExempt);
+    t2dp->setChangeFilter (options.deadband, options.deadbandPercent,
+                           options.suppressIdentical);
+
+    addToModelShape (domain == m_vcc);
+    addToModelShape (domainName);
+    addToModelShape (name);
+    addToModelShape (type);
+    addToModelShape (hasCOV);
+
+    if (m_snapshot)
+    {
+        m_snapshot->addIndicationPoint (domain == m_vcc, domainName, name,
+                                        type, hasCOV, options);
+    }
+
+    return t2dp;
+}
+
+TASE2Datapoint*
+TASE2Config::addControlPoint (const std::string& domainName,
+                              Tase2_Domain domain, const std::string& name,
+                              DPTYPE type, Tase2_DeviceClass deviceClass,
+                              bool hasTag, int16_t checkBackId,
+                              const TASE2RateLimit& limit)
+{
+    TASE2Datapoint* t2dp = m_points.insert (domainName, name, type);
+
+    /* before anything is added to the model */
+    if (!t2dp)
+    {
+        Tase2Utility::log_error ("Duplicate datapoint %s in domain %s",
+                                 name.c_str (), domainName.c_str ());
+        return nullptr;
+    }
+
+    Tase2_ControlPointType contType
+        = TASE2Datapoint::toControlPointType (type);
+
+    t2dp->setControlPoint (Tase2_Domain_addControlPoint (
+        domain, name.c_str (), contType, deviceClass, hasTag, checkBackId));
+
+    t2dp->createCommandParams (domainName);
+    t2dp->setCommandRateLimit (limit);
+    t2dp->setControlIndex ((uint32_t)m_controlPoints.size ());
+    m_controlPoints[t2dp->getControlPoint ()] = t2dp;
+
+    t2dp->setCheckBackId (checkBackId);
+
+    addToModelShape (domain == m_vcc);
+    addToModelShape (domainName);
+    addToModelShape (name);
+    addToModelShape (type);
+    addToModelShape (deviceClass);
+    addToModelShape (hasTag);
+    addToModelShape (checkBackId);
+
+    if (m_snapshot)
+    {
+        m_snapshot->addControlPoint (domain == m_vcc, domainName, name, type,
+                                     deviceClass, hasTag, checkBackId,
+                                     limit);
+    }
+
+    return t2dp;
+}
+
+bool
+TASE2Config::importBilateralTable (const Value& bltValue)
+{
+    if (!bltValue.HasMember ("name") || !bltValue["name"].IsString ())
+    {
+        Tase2Utility::log_error ("BILATERAL TABLE MISSING NAME");
+        return false;
+    }
+
+    if (!bltValue.HasMember ("icc") || !bltValue["icc"].IsString ())
+    {
+        Tase2Utility::log_error ("BILATERAL TABLE MISSING 'icc'");
+        return false;
+    }
+
+    if (!bltValue.HasMember ("apTitle") || !bltValue["apTitle"].IsString ())
+    {
+        Tase2Utility::log_error ("BILATERAL TABLE MISSING 'apTitle'");
+        return false;
+    }
+
+    if (!bltValue.HasMember ("aeQualifier")
+        || !bltValue["aeQualifier"].IsInt ())
+    {
+        Tase2Utility::log_error ("BILATERAL TABLE MISSING 'aeQualifier'");
+        return false;
+    }
+
+    if (!bltValue.HasMember ("datapoints")
+        || !bltValue["datapoints"].IsArray ())
+    {
+        Tase2Utility::log_error ("BILATERAL TABLE MISSING 'datapoints'");
+        return false;
+    }
+
+    auto it = m_domains.find (bltValue["icc"].GetString ());
+
+    if (it == m_domains.end ())
+    {
+        Tase2Utility::log_error ("ICC not found for bilateral table");
+        return false;
+    }
+
+    Tase2_Domain icc = it->second;
+
+    Tase2_BilateralTable blt = addBilateralTable (
+        bltValue["name"].GetString (), it->first, icc,
+        bltValue["apTitle"].GetString (), bltValue["aeQualifier"].GetInt ());
+
+    const Value& bltDatapoints = bltValue["datapoints"];
+    std::vector<std::string> names;
+
+    /* an entry names one point, a range or a tag */
+    for (const Value& datapoint : bltDatapoints.GetArray ())
+    {
+        selectDatapoints (it->first, datapoint, names);
+    }
+
+    for (const std::string& name : names)
+    {
+        TASE2Datapoint* t2dp = findDatapoint (it->first, name);
+
+        if (!t2dp)
+        {
+            Tase2Utility::log_debug ("Data point '%s' not found in "
+                                     "exchange definitions for ICC '%s'",
+                                     name.c_str (),
+                                     bltValue["icc"].GetString ());
+            continue;
+        }
+
+        addBilateralTablePoint (blt, t2dp);
+
+        Tase2Utility::log_debug ("Added %s '%s' to Bilateral Table '%s'",
+                                 TASE2Datapoint::isCommand (t2dp->getType ())
+                                     ? "Control Point"
+                                     : "Data Point",
+                                 t2dp->getLabel ().c_str (),
+                                 bltValue["name"].GetString ());
+    }
+
+    return true;
+}
+
+Tase2_BilateralTable
+TASE2Config::addBilateralTable (const std::string& name,
+                                const std::string& iccName, Tase2_Domain icc,
+                                const std::string& apTitle, int aeQualifier)
+{
+    Tase2_BilateralTable blt = Tase2_BilateralTable_create (
+        name.c_str (), icc, apTitle.c_str (), aeQualifier);
+
+    m_bilateral_tables.push_back (blt);
+
+    TASE2BilateralTableDef definition;
+
+    definition.name = name;
+    definition.icc = iccName;
+    definition.apTitle = apTitle;
+    definition.aeQualifier = aeQualifier;
+
+    m_bilateralTableDefs.push_back (definition);
+
+    if (m_snapshot)
+    {
+        m_snapshot->addBilateralTable (name, iccName, apTitle, aeQualifier);
+    }
+
+    return blt;
+}
+
+void
+TASE2Config::addBilateralTablePoint (Tase2_BilateralTable blt,
+                                     TASE2Datapoint* t2dp)
+{
+    if (TASE2Datapoint::isCommand (t2dp->getType ()))
+    {
+        Tase2_BilateralTable_addControlPoint (
+            blt, t2dp->getControlPoint (), t2dp->getCheckBackId (), true,
+            true, true, true);
+    }
+    else
+    {
+        Tase2_BilateralTable_addDataPoint (
+            blt, (Tase2_DataPoint)t2dp->getIndicationPoint (), true, false);
+    }
+
+    /* points are only added to the table created last */
+    m_bilateralTableDefs.back ().points.push_back (t2dp->getPointId ());
+
+    if (m_snapshot)
+    {
+        m_snapshot->addBilateralTablePoint (t2dp->getPointId ());
+    }
+}
+
+
+bool
+TASE2Config::importDSTransferSet (const Value& dts)
+{
+    if (!dts.IsObject ())
+    {
+        Tase2Utility::log_error ("DATASET TRANSFER SET NOT AN OBJECT");
+        return false;
+    }
+    if (!dts.HasMember ("name") || !dts["name"].IsString ())
+    {
+        Tase2Utility::log_error ("DATASET TRANSFER SET HAS NO NAME");
+        return false;
+    }
+    if (!dts.HasMember ("domain") || !dts["domain"].IsString ())
+    {
+        Tase2Utility::log_error ("DATASET TRANSFER SET HAS NO DOMAIN");
+        return false;
+    }
+
+    std::string dtsDomainName = dts["domain"].GetString ();
+
+    auto itD = m_domains.find (dtsDomainName);
+    if (itD == m_domains.end ())
+    {
+        Tase2Utility::log_warn ("Invalid Domain %s", dtsDomainName.c_str ());
+        return true;
+    }
+
+    Tase2_Domain dtsDomain = itD->second;
+
+    addDSTransferSet (dtsDomainName, dtsDomain, dts["name"].GetString ());
+
+    return true;
+}
+
+void
+TASE2Config::addDSTransferSet (const std::string& domainName,
+                               Tase2_Domain domain, const std::string& name)
+{
+    Tase2_Domain_addDSTransferSet (domain, name.c_str ());
+
+    addToModelShape (domainName);
+    addToModelShape (name);
+
+    if (m_snapshot)
+    {
+        m_snapshot->addDSTransferSet (domainName, name);
+    }
+}
+
+void
+TASE2Config::importDataset (const Value& ds)
+{
+    if (!ds.IsObject ())
+    {
+        Tase2Utility::log_error ("DATASET TRANSFER SET NOT AN OBJECT");
+        return;
+    }
+    if (!ds.HasMember ("name") || !ds["name"].IsString ())
+    {
+        Tase2Utility::log_error ("DATASET TRANSFER SET HAS NO NAME");
+        return;
+    }
+    if (!ds.HasMember ("domain") || !ds["domain"].IsString ())
+    {
+        Tase2Utility::log_error ("DATASET TRANSFER SET HAS NO DOMAIN");
+        return;
+    }
+
+    std::string dsDomainName = ds["domain"].GetString ();
 
-bool
-TASE2Config::isValidIPAddress (const std::string& addrStr)
+    auto itD = m_domains.find (dsDomainName);
+    if (itD == m_domains.end ())
+    {
+        Tase2Utility::log_warn ("Invalid Domain %s", dsDomainName.c_str ());
+        return;
+    }
+
+    Tase2_Domain dsDomain = itD->second;
+
+    Tase2_DataSet dataSet
+        = addDataset (dsDomainName, dsDomain, ds["name"].GetString ());
+
+    Tase2Utility::log_debug ("Create dataset %s in domain %s",
+                             ds["name"].GetString (),
+                             ds["domain"].GetString ());
+
+    if (!ds.HasMember ("datapoints") || !ds["datapoints"].IsArray ())
+    {
+        Tase2Utility::log_error ("invalid 'datapoints' "
+                                 "array in dataset %s",
+                                 ds["name"].GetString ());
+        return;
+    }
+
+    const Value& datasetDatapoints = ds["datapoints"];
+    std::vector<std::string> names;
+
+    /* a point name, or an object with a range or a tag */
+    for (const Value& dp : datasetDatapoints.GetArray ())
+    {
+        if (dp.IsString ())
+        {
+            names.push_back (dp.GetString ());
+        }
+        else if (!dp.IsObject ())
+        {
+            Tase2Utility::log_error (
+                "Invalid datapoint in dataset %s (not std::string)",
+                ds["name"].GetString ());
+        }
+        else
+        {
+            selectDatapoints (dsDomainName, dp, names);
+        }
+    }
+
+    for (const std::string& name : names)
+    {
+        if (findDatapoint (dsDomainName, name))
+        {
+            addDatasetEntry (dataSet, dsDomain, name);
+
+            Tase2Utility::log_debug ("Add entry %s to dataset %s",
+                                     name.c_str (), ds["name"].GetString ());
+        }
+        else
+        {
+            Tase2Utility::log_error ("datapoint %s not found in dataset %s",
+                                     name.c_str (), ds["name"].GetString ());
+        }
+    }
+}
+
+Tase2_DataSet
+TASE2Config::addDataset (const std::string& domainName, Tase2_Domain domain,
+                         const std::string& name)
 {
-    // see
-    // https://stackoverflow.com/questions/318236/how-do-you-validate-that-a-string-is-a-valid-ipv4-address-in-c
-    struct sockaddr_in sa;
-    int result = inet_pton (AF_INET, addrStr.c_str (), &(sa.sin_addr));
+    Tase2_DataSet dataSet = Tase2_Domain_addDataSet (domain, name.c_str ());
 
-    return (result == 1);
+    addToModelShape (domainName);
+    addToModelShape (name);
+
+    if (m_snapshot)
+    {
+        m_snapshot->addDataset (domainName, name);
+    }
+
+    return dataSet;
 }
 
 void
+TASE2Config::addDatasetEntry (Tase2_DataSet dataSet, Tase2_Domain domain,
+                              const std::string& name)
+{
+    Tase2_DataSet_addEntry (dataSet, domain, name.c_str ());
+
+    addToModelShape (name);
+
+    if (m_snapshot)
+    {
+        m_snapshot->addDatasetEntry (name);
+    }
+}
+
+bool
 TASE2Config::importModelConfig (const std::string& modelConfig,
                                 Tase2_DataModel model)
+{
+    /* a DOM of a large model costs about as much as the model itself */
+    if (modelConfig.size () >= TASE2_MODEL_STREAM_THRESHOLD)
+    {
+        return importModelStream (modelConfig, model);
+    }
+
+    return importModelDocument (modelConfig, model);
+}
+
+bool
+TASE2Config::importModelStream (const std::string& modelConfig,
+                                Tase2_DataModel model)
+{
+    m_vcc = Tase2_DataModel_getVCC (model);
+
+    TASE2ModelReader reader (*this, modelConfig, model);
+
+    return reader.parse ();
+}
+
+bool
+TASE2Config::importModelDocument (const std::string& modelConfig,
+                                  Tase2_DataModel model)
 {
     Document document;
     if (document.Parse (const_cast<char*> (modelConfig.c_str ()))
@@ -44,13 +1028,13 @@ TASE2Config::importModelConfig (const std::string& modelConfig,
     {
         Tase2Utility::log_fatal ("Parsing error in model configuration");
         Tase2Utility::log_debug ("Parsing error in model configuration\n");
-        return;
+        return false;
     }
 
     if (!document.IsObject ())
     {
         Tase2Utility::log_error ("Model configuration is not an object");
-        return;
+        return false;
     }
 
     if (!document.HasMember ("model_conf")
@@ -58,16 +1042,24 @@ TASE2Config::importModelConfig (const std::string& modelConfig,
     {
         Tase2Utility::log_error (
             "Missing or invalid 'model_conf' object in model configuration");
-        return;
+        return false;
     }
 
     const Value& modelConf = document["model_conf"];
 
+    /* { "global": {"rate", "burst"}, "point": {"rate", "burst"} }, the
+     * point limit applies to every control point without a rate_limit */
+    if (modelConf.HasMember ("command_rate_limit")
+        && modelConf["command_rate_limit"].IsObject ())
+    {
+        importCommandRateLimits (modelConf["command_rate_limit"]);
+    }
+
     if (!modelConf.HasMember ("vcc") || !modelConf["vcc"].IsObject ())
     {
         Tase2Utility::log_error (
             "Missing or invalid 'vcc' object in 'model_conf'");
-        return;
+        return false;
     }
 
     const Value& vccValue = modelConf["vcc"];
@@ -77,499 +1069,519 @@ TASE2Config::importModelConfig (const std::string& modelConfig,
     {
         Tase2Utility::log_error (
             "Missing or invalid 'datapoints' array in 'vcc'");
-        return;
+        return false;
     }
 
     const Value& vccDatapoints = vccValue["datapoints"];
-    Tase2_Domain vcc = Tase2_DataModel_getVCC (model);
+    m_vcc = Tase2_DataModel_getVCC (model);
 
     for (const Value& datapoint : vccDatapoints.GetArray ())
     {
-        if (!datapoint.IsObject ())
+        if (!importDatapoint (datapoint, "vcc", m_vcc))
         {
-            Tase2Utility::log_error ("DATAPOINT NOT AN OBJECT");
-            return;
-        }
-        if (!datapoint.HasMember ("name") || !datapoint["name"].IsString ())
-        {
-            Tase2Utility::log_error ("DATAPOINT HAS NO NAME");
-            return;
-        }
-        if (!datapoint.HasMember ("type") || !datapoint["type"].IsString ())
-        {
-            Tase2Utility::log_error ("DATAPOINT HAS NO TYPE");
-            return;
+            return false;
         }
+    }
 
-        DPTYPE type = TASE2Datapoint::getDpTypeFromString (
-            datapoint["type"].GetString ());
+    if (!modelConf.HasMember ("icc") || !modelConf["icc"].IsArray ())
+    {
+        Tase2Utility::log_error (
+            "Missing or invalid 'icc' array in 'model_conf'");
+        return false;
+    }
 
-        if (type == DP_TYPE_UNKNOWN)
-        {
-            Tase2Utility::log_error ("Invalid dp type %s",
-                                     datapoint["type"].GetString ());
-            continue;
-        }
+    const Value& iccArray = modelConf["icc"];
 
-        auto t2dp = std::make_shared<TASE2Datapoint> (
-            datapoint["name"].GetString (),
-            TASE2Datapoint::getDpTypeFromString (
-                datapoint["type"].GetString ()));
+    /* the ICCs are validated in parallel, then added to the model in
+     * their order, so the model does not depend on the thread count */
+    std::vector<TASE2PreparedIcc> iccs (iccArray.Size ());
 
-        if (TASE2Datapoint::isCommand (t2dp->getType ()))
-        {
-            if (!datapoint.HasMember ("mode")
-                || !datapoint["mode"].IsString ())
-            {
-                Tase2Utility::log_error (
-                    "CONTROL POINT HAS NO mode attribute ");
-                continue;
-            }
-            if (!datapoint.HasMember ("hasTag")
-                || !datapoint["hasTag"].IsBool ())
-            {
-                Tase2Utility::log_error (
-                    "CONTROL POINT HAS NO hasTag attribute ");
-                continue;
-            }
+    {
+        TASE2ImportPool pool (TASE2ImportPool::threadsFor (iccs.size ()));
 
-            if (!datapoint.HasMember ("checkBackId")
-                || !datapoint["checkBackId"].IsInt ())
-            {
-                Tase2Utility::log_error (
-                    "CONTROL POINT HAS NO checkBackId attribute ");
-                continue;
-            }
+        for (SizeType i = 0; i < iccArray.Size (); i++)
+        {
+            pool.submit ([this, &iccArray, &iccs, i] {
+                prepareIcc (iccArray[i], iccs[i]);
+            });
+        }
 
-            auto deviceClass = static_cast<Tase2_DeviceClass> (
-                datapoint["mode"].GetString () == "sbo");
+        pool.wait ();
+    }
 
-            bool hasTag = datapoint["hasTag"].GetBool ();
+    size_t pointCount = m_points.size ();
 
-            auto checkBackId = (int16_t)datapoint["checkBackId"].GetInt ();
+    for (const TASE2PreparedIcc& icc : iccs)
+    {
+        pointCount += icc.points.size ();
+    }
 
-            Tase2_ControlPointType contType
-                = TASE2Datapoint::toControlPointType (t2dp->getType ());
+    m_points.reserve (pointCount);
 
-            t2dp->setControlPoint (Tase2_Domain_addControlPoint (
-                vcc, t2dp->getLabel ().c_str (), contType, deviceClass, hasTag,
-                checkBackId));
-        }
-        else
+    for (const TASE2PreparedIcc& icc : iccs)
+    {
+        if (!commitIcc (icc, model))
         {
-            if (!datapoint.HasMember ("hasCOV")
-                || !datapoint["hasCOV"].IsBool ())
-            {
-                Tase2Utility::log_error (
-                    "INDICATION POINT HAS NO hasCOV attribute ");
-                return;
-            }
-
-            bool hasCOV = datapoint["hasCOV"].GetBool ();
-            Tase2_QualityClass qClass
-                = TASE2Datapoint::getQualityClass (t2dp->getType ());
-            Tase2_TimeStampClass tsClass
-                = TASE2Datapoint::getTimeStampClass (t2dp->getType ());
-            Tase2_IndicationPointType indType
-                = TASE2Datapoint::toIndicationPointType (t2dp->getType ());
-            t2dp->setIndicationPoint (Tase2_Domain_addIndicationPoint (
-                vcc, t2dp->getLabel ().c_str (), indType, qClass, tsClass,
-                hasCOV, true));
+            return false;
         }
-        m_modelEntries["vcc"][t2dp->getLabel ()] = t2dp;
-
-        Tase2Utility::log_debug (
-            "Add datapoint %s to vcc, %d datapoints present",
-            t2dp->getLabel ().c_str (), m_modelEntries.size ());
     }
 
-    if (!modelConf.HasMember ("icc") || !modelConf["icc"].IsArray ())
+    if (!modelConf.HasMember ("bilateral_tables")
+        || !modelConf["bilateral_tables"].IsArray ())
     {
         Tase2Utility::log_error (
-            "Missing or invalid 'icc' array in 'model_conf'");
-        return;
+            "Missing or invalid 'bilateral_tables' array in 'model_conf'");
+        return false;
     }
 
-    const Value& iccArray = modelConf["icc"];
+    const Value& bltArray = modelConf["bilateral_tables"];
 
-    for (const Value& iccValue : iccArray.GetArray ())
+    for (const Value& bltValue : bltArray.GetArray ())
     {
-        if (!iccValue.HasMember ("name") || !iccValue["name"].IsString ())
+        if (!importBilateralTable (bltValue))
         {
-            Tase2Utility::log_error ("ICC MISSING NAME");
-            return;
+            return false;
         }
+    }
 
-        Tase2_Domain icc
-            = Tase2_DataModel_addDomain (model, iccValue["name"].GetString ());
-
-        m_domains[iccValue["name"].GetString ()] = icc;
-
-        if (!iccValue.HasMember ("datapoints")
-            || !iccValue["datapoints"].IsArray ())
+    if (modelConf.HasMember ("dataset_transfer_sets"))
+    {
+        if (!modelConf["dataset_transfer_sets"].IsArray ())
         {
-            Tase2Utility::log_error ("ICC MISSING DATAPOINTS");
-            return;
+            Tase2Utility::log_error ("invalid 'dataset_transfer_sets' "
+                                     "array in 'model_conf'");
+            return false;
         }
 
-        const Value& iccDatapoints = iccValue["datapoints"];
+        const Value& dtsArray = modelConf["dataset_transfer_sets"];
 
-        for (const Value& datapoint : iccDatapoints.GetArray ())
+        for (const Value& dts : dtsArray.GetArray ())
         {
-            if (!datapoint.IsObject ())
-            {
-                Tase2Utility::log_error ("DATAPOINT NOT AN OBJECT");
-                return;
-            }
-            if (!datapoint.HasMember ("name")
-                || !datapoint["name"].IsString ())
-            {
-                Tase2Utility::log_error ("DATAPOINT HAS NO NAME");
-                return;
-            }
-            if (!datapoint.HasMember ("type")
-                || !datapoint["type"].IsString ())
+            if (!importDSTransferSet (dts))
             {
-                Tase2Utility::log_error ("DATAPOINT HAS NO TYPE");
-                return;
+                return false;
             }
+        }
+    }
 
-            DPTYPE type = TASE2Datapoint::getDpTypeFromString (
-                datapoint["type"].GetString ());
-
-            if (type == DP_TYPE_UNKNOWN)
-            {
-                Tase2Utility::log_error ("Invalid dp type %s",
-                                         datapoint["type"].GetString ());
-                continue;
-            }
+    if (modelConf.HasMember ("datasets"))
+    {
+        if (!modelConf["datasets"].IsArray ())
+        {
+            Tase2Utility::log_error ("invalid 'datasets' "
+                                     "array in 'model_conf'");
+            return false;
+        }
 
-            auto t2dp = std::make_shared<TASE2Datapoint> (
-                datapoint["name"].GetString (),
-                TASE2Datapoint::getDpTypeFromString (
-                    datapoint["type"].GetString ()));
+        const Value& dsArray = modelConf["datasets"];
 
-            if (TASE2Datapoint::isCommand (t2dp->getType ()))
-            {
-                if (!datapoint.HasMember ("mode")
-                    || !datapoint["mode"].IsString ())
-                {
-                    Tase2Utility::log_error (
-                        "CONTROL POINT HAS NO mode attribute ");
-                    continue;
-                }
-                if (!datapoint.HasMember ("hasTag")
-                    || !datapoint["hasTag"].IsBool ())
-                {
-                    Tase2Utility::log_error (
-                        "CONTROL POINT HAS NO hasTag attribute ");
-                    continue;
-                }
+        for (const Value& ds : dsArray.GetArray ())
+        {
+            importDataset (ds);
+        }
+    }
 
-                if (!datapoint.HasMember ("checkBackId")
-                    || !datapoint["checkBackId"].IsInt ())
-                {
-                    Tase2Utility::log_error (
-                        "CONTROL POINT HAS NO checkBackId attribute ");
-                    continue;
-                }
+    return true;
+}
 
-                auto deviceClass = static_cast<Tase2_DeviceClass> (
-                    strcmp (datapoint["mode"].GetString (), "sbo") != 0);
+void
+TASE2Config::addToModelShape (const std::string& str)
+{
+    /* with the nul, so that "ab" + "c" differs from "a" + "bc" */
+    for (size_t i = 0; i <= str.size (); i++)
+    {
+        m_modelShape ^= (unsigned char)str.c_str ()[i];
+        m_modelShape *= FNV_PRIME;
+    }
+}
 
-                Tase2Utility::log_debug ("Device class is %d", deviceClass);
+void
+TASE2Config::addToModelShape (int value)
+{
+    for (size_t i = 0; i < sizeof (value); i++)
+    {
+        m_modelShape ^= ((unsigned int)value >> (8 * i)) & 0xff;
+        m_modelShape *= FNV_PRIME;
+    }
+}
 
-                bool hasTag = datapoint["hasTag"].GetBool ();
+size_t
+TASE2Config::updatePointOptions (const TASE2Config& next)
+{
+    size_t changed = 0;
 
-                auto checkBackId = (int16_t)datapoint["checkBackId"].GetInt ();
+    for (uint32_t pointId = 0; pointId < m_points.size (); pointId++)
+    {
+        TASE2Datapoint* point = m_points.point (pointId);
+        TASE2Datapoint* nextPoint = next.findPoint (pointId);
 
-                Tase2_ControlPointType contType
-                    = TASE2Datapoint::toControlPointType (t2dp->getType ());
+        // LCOV_EXCL_START
+        if (!nextPoint)
+        {
+            continue;
+        }
+        // LCOV_EXCL_STOP
+
+        if (point->inExchangedDefinitions ()
+                == nextPoint->inExchangedDefinitions ()
+            && point->isCoalesceExempt () == nextPoint->isCoalesceExempt ()
+            && point->getDeadband () == nextPoint->getDeadband ()
+            && point->getDeadbandPercent ()
+                   == nextPoint->getDeadbandPercent ()
+            && point->getSuppressIdentical ()
+                   == nextPoint->getSuppressIdentical ())
+        {
+            continue;
+        }
 
-                t2dp->setControlPoint (Tase2_Domain_addControlPoint (
-                    icc, t2dp->getLabel ().c_str (), contType, deviceClass,
-                    hasTag, checkBackId));
+        point->setInExchangedDefinitions (
+            nextPoint->inExchangedDefinitions ());
+        point->setCoalesceExempt (nextPoint->isCoalesceExempt ());
 
-                t2dp->setCheckBackId (checkBackId);
-            }
-            else
-            {
-                if (!datapoint.HasMember ("hasCOV")
-                    || !datapoint["hasCOV"].IsBool ())
-                {
-                    Tase2Utility::log_error (
-                        "INDICATION POINT HAS NO hasCOV attribute ");
-                    return;
-                }
+        /* the last applied value stays, it is compared with the new
+         * deadband */
+        point->setChangeFilter (nextPoint->getDeadband (),
+                                nextPoint->getDeadbandPercent (),
+                                nextPoint->getSuppressIdentical ());
+        changed++;
+    }
 
-                bool hasCOV = datapoint["hasCOV"].GetBool ();
-                Tase2_QualityClass qClass
-                    = TASE2Datapoint::getQualityClass (t2dp->getType ());
-                Tase2_TimeStampClass tsClass
-                    = TASE2Datapoint::getTimeStampClass (t2dp->getType ());
-                Tase2_IndicationPointType indType
-                    = TASE2Datapoint::toIndicationPointType (t2dp->getType ());
-                t2dp->setIndicationPoint (Tase2_Domain_addIndicationPoint (
-                    icc, t2dp->getLabel ().c_str (), indType, qClass, tsClass,
-                    hasCOV, true));
-            }
+    /* the asset names of next, resolved to the points of this model */
+    m_assetIndex.clear ();
 
-            m_modelEntries[iccValue["name"].GetString ()][t2dp->getLabel ()]
-                = t2dp;
+    for (const auto& asset : next.m_assetIndex)
+    {
+        /* same model shape, so the same point types */
+        TASE2AssetEntry entry
+            = { asset.second.domain,
+                findPoint (asset.second.point->getPointId ()),
+                asset.second.traits };
 
-            Tase2Utility::log_debug (
-                "Add datapoint %s to domain %s, %d datapoints present",
-                t2dp->getLabel ().c_str (), iccValue["name"].GetString (),
-                m_modelEntries.size ());
+        if (entry.point)
+        {
+            m_assetIndex.insert ({ asset.first, entry });
         }
     }
 
-    if (!modelConf.HasMember ("bilateral_tables")
-        || !modelConf["bilateral_tables"].IsArray ())
-    {
-        Tase2Utility::log_error (
-            "Missing or invalid 'bilateral_tables' array in 'model_conf'");
-        return;
-    }
+    return changed;
+}
 
-    const Value& bltArray = modelConf["bilateral_tables"];
+size_t
+TASE2Config::updateCommandRateLimits (const TASE2Config& next)
+{
+    m_globalCommandRateLimit = next.m_globalCommandRateLimit;
+    m_pointCommandRateLimit = next.m_pointCommandRateLimit;
 
-    for (const Value& bltValue : bltArray.GetArray ())
+    size_t changed = 0;
+
+    for (const auto& controlPoint : m_controlPoints)
     {
-        if (!bltValue.HasMember ("name") || !bltValue["name"].IsString ())
+        TASE2Datapoint* point = controlPoint.second;
+        TASE2Datapoint* nextPoint = next.findPoint (point->getPointId ());
+
+        // LCOV_EXCL_START
+        if (!nextPoint)
         {
-            Tase2Utility::log_error ("BILATERAL TABLE MISSING NAME");
-            return;
+            continue;
         }
+        // LCOV_EXCL_STOP
 
-        if (!bltValue.HasMember ("icc") || !bltValue["icc"].IsString ())
+        const TASE2TokenBucket* rate = point->getCommandRate ();
+        const TASE2TokenBucket* nextRate = nextPoint->getCommandRate ();
+
+        TASE2RateLimit limit = rate ? rate->getLimit () : TASE2RateLimit{};
+        TASE2RateLimit nextLimit
+            = nextRate ? nextRate->getLimit () : TASE2RateLimit{};
+
+        if (limit.rate == nextLimit.rate && limit.burst == nextLimit.burst)
         {
-            Tase2Utility::log_error ("BILATERAL TABLE MISSING 'icc'");
-            return;
+            continue;
         }
 
-        if (!bltValue.HasMember ("apTitle")
-            || !bltValue["apTitle"].IsString ())
+        point->setCommandRateLimit (nextLimit);
+        changed++;
+    }
+
+    return changed;
+}
+
+void
+TASE2Config::updateBilateralTables (const TASE2Config& next,
+                                    std::vector<Tase2_BilateralTable>& added,
+                                    std::vector<Tase2_BilateralTable>& removed)
+{
+    std::vector<Tase2_BilateralTable> tables;
+    std::vector<TASE2BilateralTableDef> definitions;
+
+    tables.swap (m_bilateral_tables);
+    definitions.swap (m_bilateralTableDefs);
+
+    std::vector<bool> kept (tables.size (), false);
+
+    for (const TASE2BilateralTableDef& definition : next.m_bilateralTableDefs)
+    {
+        auto it = std::find (definitions.begin (), definitions.end (),
+                             definition);
+
+        while (it != definitions.end () && kept[it - definitions.begin ()])
         {
-            Tase2Utility::log_error ("BILATERAL TABLE MISSING 'apTitle'");
-            return;
+            it = std::find (it + 1, definitions.end (), definition);
         }
 
-        if (!bltValue.HasMember ("aeQualifier")
-            || !bltValue["aeQualifier"].IsInt ())
+        /* unchanged tables stay with the server, so do their clients */
+        if (it != definitions.end ())
         {
-            Tase2Utility::log_error ("BILATERAL TABLE MISSING 'aeQualifier'");
-            return;
+            kept[it - definitions.begin ()] = true;
+
+            m_bilateral_tables.push_back (tables[it - definitions.begin ()]);
+            m_bilateralTableDefs.push_back (*it);
+            continue;
+        }
+
+        Tase2_BilateralTable blt = addBilateralTable (
+            definition.name, definition.icc,
+            findDomain (false, definition.icc), definition.apTitle,
+            definition.aeQualifier);
+
+        for (uint32_t pointId : definition.points)
+        {
+            addBilateralTablePoint (blt, findPoint (pointId));
         }
 
-        if (!bltValue.HasMember ("datapoints")
-            || !bltValue["datapoints"].IsArray ())
+        added.push_back (blt);
+    }
+
+    for (size_t i = 0; i < tables.size (); i++)
+    {
+        if (!kept[i])
         {
-            Tase2Utility::log_error ("BILATERAL TABLE MISSING 'datapoints'");
-            return;
+            removed.push_back (tables[i]);
         }
+    }
+}
+
+Tase2_Domain
+TASE2Config::findDomain (bool vcc, const std::string& name) const
+{
+    if (vcc)
+    {
+        return m_vcc;
+    }
+
+    auto it = m_domains.find (name);
+
+    return it == m_domains.end () ? nullptr : it->second;
+}
 
-        auto it = m_domains.find (bltValue["icc"].GetString ());
+TASE2Datapoint*
+TASE2Config::findPoint (uint32_t pointId) const
+{
+    return pointId < m_points.size () ? m_points.point (pointId) : nullptr;
+}
 
-        if (it == m_domains.end ())
-        {
-            Tase2Utility::log_error ("ICC not found for bilateral table");
-            return;
-        }
+bool
+TASE2Config::importModelSnapshot (const std::string& path, uint64_t hash,
+                                  Tase2_DataModel model)
+{
+    TASE2SnapshotReader reader;
+
+    if (!reader.open (path, hash))
+    {
+        return false;
+    }
 
-        Tase2_Domain icc = it->second;
+    m_vcc = Tase2_DataModel_getVCC (model);
 
-        Tase2_BilateralTable blt
-            = Tase2_BilateralTable_create (bltValue["name"].GetString (), icc,
-                                           bltValue["apTitle"].GetString (),
-                                           bltValue["aeQualifier"].GetInt ());
+    /* tables and datasets the following entries belong to */
+    Tase2_BilateralTable blt = nullptr;
+    Tase2_DataSet dataSet = nullptr;
+    Tase2_Domain dataSetDomain = nullptr;
 
-        const Value& bltDatapoints = bltValue["datapoints"];
+    TASE2SnapshotRecord record;
 
-        for (const Value& datapoint : bltDatapoints.GetArray ())
+    while (reader.next (record))
+    {
+        switch (record)
         {
-            if (!datapoint.IsObject ())
-            {
-                Tase2Utility::log_error ("DATAPOINT NOT AN OBJECT");
-                continue;
-            }
-            if (!datapoint.HasMember ("name")
-                || !datapoint["name"].IsString ())
-            {
-                Tase2Utility::log_error ("DATAPOINT HAS NO NAME");
-                continue;
-            }
+            case SNAPSHOT_RATE_LIMITS: {
+                TASE2RateLimit global;
+                TASE2RateLimit point;
 
-            auto it1 = m_modelEntries[bltValue["icc"].GetString ()].find (
-                datapoint["name"].GetString ());
+                global.rate = reader.getDouble ();
+                global.burst = reader.getDouble ();
+                point.rate = reader.getDouble ();
+                point.burst = reader.getDouble ();
 
-            if (it1 == m_modelEntries[bltValue["icc"].GetString ()].end ())
-            {
-                Tase2Utility::log_debug ("Data point '%s' not found in "
-                                         "exchange definitions for ICC '%s'",
-                                         datapoint["name"].GetString (),
-                                         bltValue["icc"].GetString ());
-                continue;
+                setCommandRateLimits (global, point);
+                break;
             }
 
-            std::shared_ptr<TASE2Datapoint> t2dp = it1->second;
+            case SNAPSHOT_DOMAIN: {
+                std::string name = reader.getString ();
 
-            if (TASE2Datapoint::isCommand (t2dp->getType ()))
-            {
-                Tase2_BilateralTable_addControlPoint (
-                    blt, t2dp->getControlPoint (), t2dp->getCheckBackId (),
-                    true, true, true, true);
-                Tase2Utility::log_debug (
-                    "Added Control Point '%s' to Bilateral Table '%s'",
-                    t2dp->getLabel ().c_str (), bltValue["name"].GetString ());
-            }
-            else
-            {
-                Tase2_BilateralTable_addDataPoint (
-                    blt, (Tase2_DataPoint)t2dp->getIndicationPoint (), true,
-                    false);
-                Tase2Utility::log_debug (
-                    "Added Data Point '%s' to Bilateral Table '%s'",
-                    t2dp->getLabel ().c_str (), bltValue["name"].GetString ());
+                if (!reader.ok ())
+                {
+                    return false;
+                }
+
+                importDomain (name, model);
+                break;
             }
-        }
-        m_bilateral_tables.push_back (blt);
-    }
 
-    if (modelConf.HasMember ("dataset_transfer_sets"))
-    {
-        if (!modelConf["dataset_transfer_sets"].IsArray ())
-        {
-            Tase2Utility::log_error ("invalid 'dataset_transfer_sets' "
-                                     "array in 'model_conf'");
-            return;
-        }
+            case SNAPSHOT_INDICATION: {
+                bool vcc = reader.getU8 ();
+                std::string domainName = reader.getString ();
+                std::string name = reader.getString ();
+                auto type = static_cast<DPTYPE> (reader.getU8 ());
+                bool hasCOV = reader.getU8 ();
 
-        const Value& dtsArray = modelConf["dataset_transfer_sets"];
+                TASE2IndicationOptions options;
 
-        for (const Value& dts : dtsArray.GetArray ())
-        {
-            if (!dts.IsObject ())
-            {
-                Tase2Utility::log_error ("DATASET TRANSFER SET NOT AN OBJECT");
-                return;
-            }
-            if (!dts.HasMember ("name") || !dts["name"].IsString ())
-            {
-                Tase2Utility::log_error ("DATASET TRANSFER SET HAS NO NAME");
-                return;
-            }
-            if (!dts.HasMember ("domain") || !dts["domain"].IsString ())
-            {
-                Tase2Utility::log_error ("DATASET TRANSFER SET HAS NO DOMAIN");
-                return;
-            }
+                options.coalesceExempt = reader.getU8 ();
+                options.deadband = reader.getDouble ();
+                options.deadbandPercent = reader.getDouble ();
+                options.suppressIdentical = reader.getU8 ();
 
-            std::string dtsDomainName = dts["domain"].GetString ();
+                Tase2_Domain domain = findDomain (vcc, domainName);
 
-            auto itD = m_domains.find (dtsDomainName);
-            if (itD == m_domains.end ())
-            {
-                Tase2Utility::log_warn ("Invalid Domain %s",
-                                        dtsDomainName.c_str ());
-                continue;
+                if (!reader.ok () || !domain || type >= COMMAND)
+                {
+                    return false;
+                }
+
+                if (!addIndicationPoint (domainName, domain, name, type,
+                                         hasCOV, options))
+                {
+                    return false;
+                }
+                break;
             }
 
-            Tase2_Domain dtsDomain = itD->second;
+            case SNAPSHOT_CONTROL: {
+                bool vcc = reader.getU8 ();
+                std::string domainName = reader.getString ();
+                std::string name = reader.getString ();
+                auto type = static_cast<DPTYPE> (reader.getU8 ());
+                auto deviceClass
+                    = static_cast<Tase2_DeviceClass> (reader.getU8 ());
+                bool hasTag = reader.getU8 ();
+                int16_t checkBackId = reader.getI16 ();
 
-            Tase2_Domain_addDSTransferSet (dtsDomain,
-                                           dts["name"].GetString ());
-        }
-    }
+                TASE2RateLimit limit;
 
-    if (modelConf.HasMember ("datasets"))
-    {
-        if (!modelConf["datasets"].IsArray ())
-        {
-            Tase2Utility::log_error ("invalid 'datasets' "
-                                     "array in 'model_conf'");
-            return;
-        }
+                limit.rate = reader.getDouble ();
+                limit.burst = reader.getDouble ();
 
-        const Value& dsArray = modelConf["datasets"];
+                Tase2_Domain domain = findDomain (vcc, domainName);
 
-        for (const Value& ds : dsArray.GetArray ())
-        {
-            if (!ds.IsObject ())
-            {
-                Tase2Utility::log_error ("DATASET TRANSFER SET NOT AN OBJECT");
-                continue;
-            }
-            if (!ds.HasMember ("name") || !ds["name"].IsString ())
-            {
-                Tase2Utility::log_error ("DATASET TRANSFER SET HAS NO NAME");
-                continue;
+                if (!reader.ok () || !domain
+                    || !TASE2Datapoint::isCommand (type))
+                {
+                    return false;
+                }
+
+                if (!addControlPoint (domainName, domain, name, type,
+                                      deviceClass, hasTag, checkBackId,
+                                      limit))
+                {
+                    return false;
+                }
+                break;
             }
-            if (!ds.HasMember ("domain") || !ds["domain"].IsString ())
-            {
-                Tase2Utility::log_error ("DATASET TRANSFER SET HAS NO DOMAIN");
-                continue;
+
+            case SNAPSHOT_BLT: {
+                std::string name = reader.getString ();
+                std::string iccName = reader.getString ();
+                std::string apTitle = reader.getString ();
+                int aeQualifier = reader.getI32 ();
+
+                Tase2_Domain icc = findDomain (false, iccName);
+
+                if (!reader.ok () || !icc)
+                {
+                    return false;
+                }
+
+                blt = addBilateralTable (name, iccName, icc, apTitle,
+                                         aeQualifier);
+                break;
             }
 
-            std::string dsDomainName = ds["domain"].GetString ();
+            case SNAPSHOT_BLT_POINT: {
+                TASE2Datapoint* t2dp = findPoint (reader.getU32 ());
 
-            auto itD = m_domains.find (dsDomainName);
-            if (itD == m_domains.end ())
-            {
-                Tase2Utility::log_warn ("Invalid Domain %s",
-                                        dsDomainName.c_str ());
-                continue;
+                if (!reader.ok () || !blt || !t2dp)
+                {
+                    return false;
+                }
+
+                addBilateralTablePoint (blt, t2dp);
+                break;
             }
 
-            Tase2_Domain dsDomain = itD->second;
+            case SNAPSHOT_DSTS: {
+                std::string domainName = reader.getString ();
+                std::string name = reader.getString ();
 
-            Tase2_DataSet dataSet
-                = Tase2_Domain_addDataSet (dsDomain, ds["name"].GetString ());
+                Tase2_Domain domain = findDomain (false, domainName);
 
-            Tase2Utility::log_debug ("Create dataset %s in domain %s",
-                                     ds["name"].GetString (),
-                                     ds["domain"].GetString ());
+                if (!reader.ok () || !domain)
+                {
+                    return false;
+                }
 
-            if (!ds.HasMember ("datapoints") || !ds["datapoints"].IsArray ())
-            {
-                Tase2Utility::log_error ("invalid 'datapoints' "
-                                         "array in dataset %s",
-                                         ds["name"].GetString ());
-                continue;
+                addDSTransferSet (domainName, domain, name);
+                break;
             }
 
-            const Value& datasetDatapoints = ds["datapoints"];
+            case SNAPSHOT_DATASET: {
+                std::string domainName = reader.getString ();
+                std::string name = reader.getString ();
 
-            for (const Value& dp : datasetDatapoints.GetArray ())
-            {
-                if (!dp.IsString ())
+                dataSetDomain = findDomain (false, domainName);
+
+                if (!reader.ok () || !dataSetDomain)
                 {
-                    Tase2Utility::log_error (
-                        "Invalid datapoint in dataset %s (not std::string)",
-                        ds["name"].GetString ());
-                    continue;
+                    return false;
                 }
 
-                if (getDatapointByReference (ds["domain"].GetString (),
-                                             dp.GetString ()))
-                {
-                    Tase2_DataSet_addEntry (dataSet, dsDomain,
-                                            dp.GetString ());
+                dataSet = addDataset (domainName, dataSetDomain, name);
+                break;
+            }
 
-                    Tase2Utility::log_debug ("Add entry %s to dataset %s",
-                                             dp.GetString (),
-                                             ds["name"].GetString ());
+            case SNAPSHOT_DATASET_ENTRY: {
+                std::string name = reader.getString ();
+
+                if (!reader.ok () || !dataSet)
+                {
+                    return false;
                 }
-                else
+
+                addDatasetEntry (dataSet, dataSetDomain, name);
+                break;
+            }
+
+            case SNAPSHOT_EXCHANGE: {
+                TASE2Datapoint* t2dp = findPoint (reader.getU32 ());
+                std::string domain = reader.getString ();
+                std::string label = reader.getString ();
+                std::string pivotId = reader.getString ();
+
+                if (!reader.ok () || !t2dp)
                 {
-                    Tase2Utility::log_error (
-                        "datapoint %s not found in dataset %s",
-                        dp.GetString (), ds["name"].GetString ());
-                    continue;
+                    return false;
                 }
+
+                addExchangedPoint (t2dp, domain, label, pivotId);
+                break;
             }
+
+            default:
+                return false;
         }
     }
+
+    return reader.ok ();
 }
 
 void
@@ -682,6 +1694,43 @@ TASE2Config::importProtocolConfig (const std::string& protocolConfig)
         }
     }
 
+    if (transportLayer.HasMember ("reconnect_min_interval"))
+    {
+        if (transportLayer["reconnect_min_interval"].IsInt ()
+            && transportLayer["reconnect_min_interval"].GetInt () > 0)
+        {
+            m_reconnectMinInterval
+                = transportLayer["reconnect_min_interval"].GetInt ();
+        }
+        else
+        {
+            Tase2Utility::log_warn ("transport_layer.reconnect_min_interval "
+                                    "is invalid -> using default");
+        }
+    }
+
+    if (transportLayer.HasMember ("reconnect_max_interval"))
+    {
+        if (transportLayer["reconnect_max_interval"].IsInt ()
+            && transportLayer["reconnect_max_interval"].GetInt () > 0)
+        {
+            m_reconnectMaxInterval
+                = transportLayer["reconnect_max_interval"].GetInt ();
+        }
+        else
+        {
+            Tase2Utility::log_warn ("transport_layer.reconnect_max_interval "
+                                    "is invalid -> using default");
+        }
+    }
+
+    if (m_reconnectMaxInterval < m_reconnectMinInterval)
+    {
+        Tase2Utility::log_warn ("reconnect_max_interval is lower than "
+                                "reconnect_min_interval -> using minimum");
+        m_reconnectMaxInterval = m_reconnectMinInterval;
+    }
+
     if (transportLayer.HasMember ("localApTitle"))
     {
         if (transportLayer["localApTitle"].IsString ())
@@ -747,14 +1796,171 @@ TASE2Config::importProtocolConfig (const std::string& protocolConfig)
             }
         }
     }
+
+    if (protocolStack.HasMember ("application_layer")
+        && protocolStack["application_layer"].IsObject ())
+    {
+        const Value& applicationLayer = protocolStack["application_layer"];
+
+        if (applicationLayer.HasMember ("cmd_exec_timeout"))
+        {
+            if (applicationLayer["cmd_exec_timeout"].IsInt ()
+                && applicationLayer["cmd_exec_timeout"].GetInt () > 0)
+            {
+                m_cmdExecTimeout
+                    = applicationLayer["cmd_exec_timeout"].GetInt ();
+            }
+            else
+            {
+                Tase2Utility::log_warn ("cmd_exec_timeout is invalid -> "
+                                        "using default timeout");
+            }
+        }
+
+        if (applicationLayer.HasMember ("select_timeout"))
+        {
+            if (applicationLayer["select_timeout"].IsInt ()
+                && applicationLayer["select_timeout"].GetInt () > 0)
+            {
+                m_selectTimeout = applicationLayer["select_timeout"].GetInt ();
+            }
+            else
+            {
+                Tase2Utility::log_warn ("select_timeout is invalid -> "
+                                        "using default timeout");
+            }
+        }
+
+        if (applicationLayer.HasMember ("command_dispatch")
+            && applicationLayer["command_dispatch"].IsString ())
+        {
+            std::string mode
+                = applicationLayer["command_dispatch"].GetString ();
+
+            if (mode == "async")
+            {
+                m_asyncCommands = true;
+            }
+            else if (mode != "sync")
+            {
+                Tase2Utility::log_warn ("Invalid command dispatch %s -> "
+                                        "dispatching synchronously",
+                                        mode.c_str ());
+            }
+        }
+
+        if (applicationLayer.HasMember ("command_queue_size"))
+        {
+            if (applicationLayer["command_queue_size"].IsInt ()
+                && applicationLayer["command_queue_size"].GetInt () > 0)
+            {
+                m_commandQueueSize
+                    = applicationLayer["command_queue_size"].GetInt ();
+            }
+            else
+            {
+                Tase2Utility::log_warn ("command_queue_size is invalid -> "
+                                        "using default queue size");
+            }
+        }
+    }
+
+    if (protocolStack.HasMember ("ingest"))
+    {
+        const Value& ingest = protocolStack["ingest"];
+
+        if (!ingest.IsObject ())
+        {
+            Tase2Utility::log_warn (
+                "ingest has invalid type -> using synchronous ingest");
+            return;
+        }
+
+        if (ingest.HasMember ("mode") && ingest["mode"].IsString ())
+        {
+            std::string mode = ingest["mode"].GetString ();
+
+            if (mode == "async")
+            {
+                m_asyncIngest = true;
+            }
+            else if (mode != "sync")
+            {
+                Tase2Utility::log_warn (
+                    "Invalid ingest mode %s -> using synchronous ingest",
+                    mode.c_str ());
+            }
+        }
+
+        if (ingest.HasMember ("queue_size"))
+        {
+            if (ingest["queue_size"].IsInt ()
+                && ingest["queue_size"].GetInt () > 0)
+            {
+                m_ingestQueueSize = ingest["queue_size"].GetInt ();
+            }
+            else
+            {
+                Tase2Utility::log_warn ("ingest.queue_size is invalid -> "
+                                        "using default queue size");
+            }
+        }
+
+        if (ingest.HasMember ("overflow") && ingest["overflow"].IsString ())
+        {
+            IngestOverflowPolicy policy
+                = TASE2IngestQueue::getPolicyFromString (
+                    ingest["overflow"].GetString ());
+
+            if (policy != INGEST_OVERFLOW_UNKNOWN)
+            {
+                m_ingestOverflow = policy;
+            }
+            else
+            {
+                Tase2Utility::log_warn (
+                    "Invalid ingest overflow policy %s -> blocking",
+                    ingest["overflow"].GetString ());
+            }
+        }
+
+        if (ingest.HasMember ("coalesce"))
+        {
+            if (ingest["coalesce"].IsBool ())
+            {
+                m_coalesceUpdates = ingest["coalesce"].GetBool ();
+            }
+            else
+            {
+                Tase2Utility::log_warn (
+                    "ingest.coalesce has invalid type -> not coalescing");
+            }
+        }
+
+        if (ingest.HasMember ("coalesce_window"))
+        {
+            if (ingest["coalesce_window"].IsInt ()
+                && ingest["coalesce_window"].GetInt () >= 0)
+            {
+                m_coalesceWindow = ingest["coalesce_window"].GetInt ();
+            }
+            else
+            {
+                Tase2Utility::log_warn ("ingest.coalesce_window is invalid "
+                                        "-> coalescing per batch");
+            }
+        }
+    }
 }
 
-void
+bool
 TASE2Config::importExchangeConfig (const std::string& exchangeConfig,
                                    Tase2_DataModel model)
 {
     m_exchangeConfigComplete = false;
 
+    m_assetIndex.clear ();
+
     Document document;
 
     if (document.Parse (const_cast<char*> (exchangeConfig.c_str ()))
@@ -763,16 +1969,16 @@ TASE2Config::importExchangeConfig (const std::string& exchangeConfig,
         Tase2Utility::log_fatal (
             "Parsing error in data exchange configuration");
 
-        return;
+        return false;
     }
 
     if (!document.IsObject ())
-        return;
+        return false;
 
     if (!document.HasMember (JSON_EXCHANGED_DATA)
         || !document[JSON_EXCHANGED_DATA].IsObject ())
     {
-        return;
+        return false;
     }
 
     const Value& exchangeData = document[JSON_EXCHANGED_DATA];
@@ -780,7 +1986,7 @@ TASE2Config::importExchangeConfig (const std::string& exchangeConfig,
     if (!exchangeData.HasMember (JSON_DATAPOINTS)
         || !exchangeData[JSON_DATAPOINTS].IsArray ())
     {
-        return;
+        return false;
     }
 
     const Value& datapoints = exchangeData[JSON_DATAPOINTS];
@@ -789,30 +1995,38 @@ TASE2Config::importExchangeConfig (const std::string& exchangeConfig,
     {
 
         if (!datapoint.IsObject ())
-            return;
+            return false;
 
         if (!datapoint.HasMember (JSON_LABEL)
             || !datapoint[JSON_LABEL].IsString ())
-            return;
+            return false;
 
         std::string label = datapoint[JSON_LABEL].GetString ();
 
+        std::string pivotId;
+
+        if (datapoint.HasMember (JSON_PIVOT_ID)
+            && datapoint[JSON_PIVOT_ID].IsString ())
+        {
+            pivotId = datapoint[JSON_PIVOT_ID].GetString ();
+        }
+
         if (!datapoint.HasMember (JSON_PROTOCOLS)
             || !datapoint[JSON_PROTOCOLS].IsArray ())
-            return;
+            return false;
 
         for (const Value& protocol : datapoint[JSON_PROTOCOLS].GetArray ())
         {
 
             if (!protocol.HasMember (JSON_PROT_NAME)
                 || !protocol[JSON_PROT_NAME].IsString ())
-                return;
+                return false;
 
             std::string protocolName = protocol[JSON_PROT_NAME].GetString ();
 
             if (!protocol.HasMember (JSON_PROT_REF)
                 || !protocol[JSON_PROT_REF].IsString ())
-                return;
+                return false;
 
             std::string protocolRef = protocol[JSON_PROT_REF].GetString ();
 
@@ -823,20 +2037,15 @@ TASE2Config::importExchangeConfig (const std::string& exchangeConfig,
                 std::string domainRef = protocolRef.substr (0, colonPos);
                 std::string dpRef = protocolRef.substr (colonPos + 1);
 
-                auto itD = m_modelEntries.find (domainRef);
-                if (itD == m_modelEntries.end ())
+                if (!m_points.hasDomain (domainRef))
                 {
                     Tase2Utility::log_warn ("Invalid Domain %s",
                                             domainRef.c_str ());
                     continue;
                 }
 
-                std::unordered_map<std::string,
-                                   std::shared_ptr<TASE2Datapoint> >
-                    domain = itD->second;
-
-                auto itDP = domain.find (dpRef);
-                if (itDP == domain.end ())
+                TASE2Datapoint* t2dp = findDatapoint (domainRef, dpRef);
+                if (!t2dp)
                 {
                     Tase2Utility::log_warn ("Invalid Datapoint ref %s:%s",
                                             domainRef.c_str(), dpRef.c_str ());
@@ -846,7 +2055,7 @@ TASE2Config::importExchangeConfig (const std::string& exchangeConfig,
                 Tase2Utility::log_debug ("Add dp to Exchange Def %s %s",
                                             domainRef.c_str (), dpRef.c_str());
 
-                itDP->second->setInExchangedDefinitions (true);
+                addExchangedPoint (t2dp, domainRef, label, pivotId);
             }
             else
             {
@@ -856,6 +2065,39 @@ TASE2Config::importExchangeConfig (const std::string& exchangeConfig,
             }
         }
     }
+
+    m_exchangeConfigComplete = true;
+
+    return true;
+}
+
+void
+TASE2Config::addExchangedPoint (TASE2Datapoint* t2dp,
+                                const std::string& domain,
+                                const std::string& label,
+                                const std::string& pivotId)
+{
+    t2dp->setInExchangedDefinitions (true);
+
+    /* readings are addressed by label, pivot id as fallback. A label
+     * always takes its entry, the last definition of a label wins; a pivot
+     * id never overwrites an existing entry. The update traits of the
+     * point type are resolved here once, not for every reading */
+    TASE2AssetEntry entry
+        = { domain, t2dp, TASE2UpdateTable::get (t2dp->getType ()) };
+
+    m_assetIndex[label] = entry;
+
+    if (!pivotId.empty ())
+    {
+        m_assetIndex.insert ({ pivotId, entry });
+    }
+
+    if (m_snapshot)
+    {
+        m_snapshot->addExchangedPoint (t2dp->getPointId (), domain, label,
+                                       pivotId);
+    }
 }
 
 void
@@ -958,25 +2200,4 @@ TASE2Config::ServerIp ()
     {
         return m_ip;
     }
-}
-
-std::shared_ptr<TASE2Datapoint>
-TASE2Config::getDatapointByReference (const std::string& domainRef,
-                                      const std::string& name)
-{
-    auto itDomain = m_modelEntries.find (domainRef);
-    if (itDomain == m_modelEntries.end ())
-    {
-        return nullptr;
-    }
-
-    auto domain = itDomain->second;
-    auto itDp = domain.find (name);
-
-    if (itDp == domain.end ())
-    {
-        return nullptr;
-    }
-
-    return itDp->second;
 }
\ No newline at end of file
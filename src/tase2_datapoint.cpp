@@ -1,4 +1,6 @@
 #include "tase2_datapoint.hpp"
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
 
 const static std::unordered_map<std::string, DPTYPE> dpTypeMap
@@ -34,8 +36,69 @@ TASE2Datapoint::getDpTypeFromString (const std::string& type)
 }
 
 TASE2Datapoint::TASE2Datapoint (const std::string& label, DPTYPE type)
-    : m_label (label), m_type (type)
+    : m_type (type), m_label (label)
 {
 }
 
-TASE2Datapoint::~TASE2Datapoint () = default;
\ No newline at end of file
+TASE2Datapoint::~TASE2Datapoint ()
+{
+    delete m_commandLatency.load (std::memory_order_relaxed);
+}
+
+TASE2CommandLatency*
+TASE2Datapoint::createCommandLatency ()
+{
+    TASE2CommandLatency* latency
+        = m_commandLatency.load (std::memory_order_acquire);
+
+    if (latency)
+    {
+        return latency;
+    }
+
+    TASE2CommandLatency* created = new TASE2CommandLatency ();
+
+    /* another thread may have been first, its histograms are kept */
+    if (m_commandLatency.compare_exchange_strong (latency, created,
+                                                  std::memory_order_acq_rel))
+    {
+        return created;
+    }
+
+    delete created;
+
+    return latency;
+}
+
+bool
+TASE2Datapoint::checkChange (long intValue, double floatValue, bool isFloat,
+                             Tase2_DataFlags flags) const
+{
+    if (!m_hasValue.load (std::memory_order_acquire)
+        || flags != m_flags.load (std::memory_order_relaxed))
+    {
+        return true;
+    }
+
+    /* Real points are stored as float by the model, compare them in the
+     * same precision */
+    double last = m_lastValue.load (std::memory_order_relaxed);
+    double delta = isFloat ? std::fabs ((float)floatValue - (float)last)
+                           : std::fabs ((double)intValue - last);
+
+    double limit = std::max (getDeadband (),
+                             std::fabs (last) * getDeadbandPercent () / 100.0);
+
+    return !(limit > 0.0 ? delta <= limit
+                         : delta == 0.0 && getSuppressIdentical ());
+}
+
+void
+TASE2Datapoint::commitChange (long intValue, double floatValue, bool isFloat,
+                              Tase2_DataFlags flags)
+{
+    m_lastValue.store (isFloat ? (double)(float)floatValue : (double)intValue,
+                       std::memory_order_relaxed);
+    m_flags.store (flags, std::memory_order_relaxed);
+    m_hasValue.store (true, std::memory_order_release);
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "tase2_import_pool.hpp"
+
+#include <algorithm>
+
+TASE2ImportPool::TASE2ImportPool (size_t threads)
+{
+    for (size_t i = 0; i < threads; i++)
+    {
+        m_threads.emplace_back (&TASE2ImportPool::run, this);
+    }
+}
+
+TASE2ImportPool::~TASE2ImportPool ()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_lock);
+
+        m_closed = true;
+    }
+
+    m_taskCond.notify_all ();
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join ();
+    }
+}
+
+size_t
+TASE2ImportPool::threadsFor (size_t tasks)
+{
+    size_t cores = std::thread::hardware_concurrency ();
+
+    size_t threads = std::min (std::min (cores, tasks),
+                               (size_t)TASE2_IMPORT_MAX_THREADS);
+
+    /* a single thread would only add the hand-over */
+    return threads > 1 ? threads : 0;
+}
+
+void
+TASE2ImportPool::submit (std::function<void ()> task)
+{
+    if (m_threads.empty ())
+    {
+        task ();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock (m_lock);
+
+        m_tasks.push_back (std::move (task));
+        m_pending++;
+    }
+
+    m_taskCond.notify_one ();
+}
+
+void
+TASE2ImportPool::wait ()
+{
+    std::unique_lock<std::mutex> lock (m_lock);
+
+    m_doneCond.wait (lock, [this] { return m_pending == 0; });
+}
+
+void
+TASE2ImportPool::run ()
+{
+    std::unique_lock<std::mutex> lock (m_lock);
+
+    while (true)
+    {
+        m_taskCond.wait (lock,
+                         [this] { return m_closed || !m_tasks.empty (); });
+
+        if (m_tasks.empty ())
+        {
+            return;
+        }
+
+        std::function<void ()> task = std::move (m_tasks.front ());
+        m_tasks.pop_front ();
+
+        lock.unlock ();
+
+        task ();
+
+        lock.lock ();
+
+        if (--m_pending == 0)
+        {
+            m_doneCond.notify_all ();
+        }
+    }
+}
@@ -0,0 +1,300 @@
+#include "tase2_ingest_queue.hpp"
+
+#include <chrono>
+
+TASE2IngestQueue::TASE2IngestQueue (size_t capacity,
+                                    IngestOverflowPolicy policy)
+    : m_policy (policy)
+{
+    size_t slotCount = 2;
+
+    while (slotCount < capacity)
+    {
+        slotCount *= 2;
+    }
+
+    m_slots.reset (new Slot[slotCount]);
+    m_mask = slotCount - 1;
+
+    for (size_t i = 0; i < slotCount; i++)
+    {
+        m_slots[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+IngestOverflowPolicy
+TASE2IngestQueue::getPolicyFromString (const std::string& policy)
+{
+    if (policy == "block")
+        return INGEST_OVERFLOW_BLOCK;
+    if (policy == "drop_oldest")
+        return INGEST_OVERFLOW_DROP_OLDEST;
+    if (policy == "coalesce")
+        return INGEST_OVERFLOW_COALESCE;
+
+    return INGEST_OVERFLOW_UNKNOWN;
+}
+
+bool
+TASE2IngestQueue::tryPush (const TASE2PointUpdate& update)
+{
+    size_t pos = m_tail.load (std::memory_order_relaxed);
+    Slot& slot = m_slots[pos & m_mask];
+
+    /* the slot is free once the reader of the previous round released it */
+    if (slot.sequence.load (std::memory_order_acquire) != pos)
+    {
+        return false;
+    }
+
+    slot.update = update;
+    slot.sequence.store (pos + 1, std::memory_order_release);
+    m_tail.store (pos + 1, std::memory_order_release);
+
+    return true;
+}
+
+bool
+TASE2IngestQueue::tryPop (TASE2PointUpdate& update)
+{
+    size_t pos = m_head.load (std::memory_order_relaxed);
+
+    while (true)
+    {
+        Slot& slot = m_slots[pos & m_mask];
+        size_t sequence = slot.sequence.load (std::memory_order_acquire);
+
+        if (sequence == pos + 1)
+        {
+            if (m_head.compare_exchange_weak (pos, pos + 1,
+                                              std::memory_order_relaxed))
+            {
+                update = slot.update;
+                slot.sequence.store (pos + m_mask + 1,
+                                     std::memory_order_release);
+                return true;
+            }
+        }
+        else if (sequence == pos)
+        {
+            /* not written yet, the ring is empty */
+            return false;
+        }
+        else
+        {
+            pos = m_head.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+void
+TASE2IngestQueue::wakeUp (std::atomic<bool>& waiting)
+{
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+
+    if (waiting.load (std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock (m_waitLock);
+        m_waitCondition.notify_all ();
+    }
+}
+
+void
+TASE2IngestQueue::coalesce (const TASE2PointUpdate& update)
+{
+    std::lock_guard<std::mutex> lock (m_overflowLock);
+
+    auto it = m_overflowIndex.find (update.point);
+
+    if (it != m_overflowIndex.end ())
+    {
+        m_overflow[it->second] = update;
+        m_coalesced++;
+    }
+    else
+    {
+        m_overflowIndex[update.point] = m_overflow.size ();
+        m_overflow.push_back (update);
+    }
+
+    m_overflowPending.store (true, std::memory_order_release);
+}
+
+bool
+TASE2IngestQueue::push (const TASE2PointUpdate& update)
+{
+    if (isClosed ())
+    {
+        return false;
+    }
+
+    m_pushed++;
+
+    /* while updates are parked in the overflow area newer ones have to go
+     * there as well, the publisher would apply them out of order otherwise */
+    if (m_overflowPending.load (std::memory_order_acquire))
+    {
+        coalesce (update);
+        wakeUp (m_consumerWaiting);
+        return true;
+    }
+
+    bool blocked = false;
+
+    while (!tryPush (update))
+    {
+        switch (m_policy)
+        {
+        case INGEST_OVERFLOW_DROP_OLDEST: {
+            TASE2PointUpdate oldest;
+
+            if (tryPop (oldest))
+            {
+                m_dropped++;
+            }
+            break; // LCOV_EXCL_LINE
+        }
+        case INGEST_OVERFLOW_COALESCE: {
+            coalesce (update);
+            wakeUp (m_consumerWaiting);
+            return true;
+        }
+        default: {
+            if (!blocked)
+            {
+                blocked = true;
+                m_blocked++;
+            }
+
+            std::unique_lock<std::mutex> lock (m_waitLock);
+
+            m_producerWaiting.store (true, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_seq_cst);
+
+            /* the timeout covers a wake up that raced with the check */
+            if (!isClosed () && size () > m_mask)
+            {
+                m_waitCondition.wait_for (lock,
+                                          std::chrono::milliseconds (10));
+            }
+
+            m_producerWaiting.store (false, std::memory_order_relaxed);
+
+            if (isClosed ())
+            {
+                return false;
+            }
+            break; // LCOV_EXCL_LINE
+        }
+        }
+    }
+
+    size_t occupancy = size ();
+
+    if (occupancy > m_highWatermark.load (std::memory_order_relaxed))
+    {
+        m_highWatermark.store (occupancy, std::memory_order_relaxed);
+    }
+
+    wakeUp (m_consumerWaiting);
+
+    return true;
+}
+
+size_t
+TASE2IngestQueue::pop (std::vector<TASE2PointUpdate>& batch,
+                       size_t maxCount, int timeoutMs)
+{
+    size_t count = 0;
+    TASE2PointUpdate update;
+
+    for (int attempt = 0; attempt < 2 && count == 0; attempt++)
+    {
+        while (count < maxCount && tryPop (update))
+        {
+            batch.push_back (update);
+            count++;
+        }
+
+        if (count < maxCount
+            && m_overflowPending.load (std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock (m_overflowLock);
+
+            /* everything still in the ring is older than the overflow */
+            while (tryPop (update))
+            {
+                batch.push_back (update);
+                count++;
+            }
+
+            batch.insert (batch.end (), m_overflow.begin (),
+                          m_overflow.end ());
+            count += m_overflow.size ();
+
+            m_overflow.clear ();
+            m_overflowIndex.clear ();
+            m_overflowPending.store (false, std::memory_order_release);
+        }
+
+        if (count == 0 && attempt == 0 && timeoutMs > 0)
+        {
+            std::unique_lock<std::mutex> lock (m_waitLock);
+
+            m_consumerWaiting.store (true, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_seq_cst);
+
+            if (!isClosed () && size () == 0
+                && !m_overflowPending.load (std::memory_order_acquire))
+            {
+                m_waitCondition.wait_for (
+                    lock, std::chrono::milliseconds (timeoutMs));
+            }
+
+            m_consumerWaiting.store (false, std::memory_order_relaxed);
+        }
+    }
+
+    if (count > 0)
+    {
+        m_published += count;
+        wakeUp (m_producerWaiting);
+    }
+
+    return count;
+}
+
+void
+TASE2IngestQueue::close ()
+{
+    m_closed.store (true, std::memory_order_release);
+
+    std::lock_guard<std::mutex> lock (m_waitLock);
+    m_waitCondition.notify_all ();
+}
+
+size_t
+TASE2IngestQueue::size () const
+{
+    size_t tail = m_tail.load (std::memory_order_acquire);
+    size_t head = m_head.load (std::memory_order_acquire);
+
+    return tail > head ? tail - head : 0;
+}
+
+TASE2IngestStats
+TASE2IngestQueue::getStats () const
+{
+    TASE2IngestStats stats;
+
+    stats.capacity = capacity ();
+    stats.occupancy = size ();
+    stats.highWatermark = m_highWatermark.load ();
+    stats.pushed = m_pushed.load ();
+    stats.published = m_published.load ();
+    stats.dropped = m_dropped.load ();
+    stats.coalesced = m_coalesced.load ();
+    stats.blocked = m_blocked.load ();
+
+    return stats;
+}
@@ -0,0 +1,109 @@
+#include "tase2_latency.hpp"
+
+const size_t TASE2LatencyHistogram::SUB_BUCKETS;
+const size_t TASE2LatencyHistogram::BUCKETS;
+
+TASE2LatencyHistogram::TASE2LatencyHistogram ()
+{
+    for (auto& bucket : m_buckets)
+    {
+        bucket.store (0, std::memory_order_relaxed);
+    }
+}
+
+size_t
+TASE2LatencyHistogram::bucketIndex (uint64_t valueUs)
+{
+    if (valueUs < SUB_BUCKETS)
+    {
+        return valueUs;
+    }
+
+    if (valueUs >= (1ULL << TASE2_LATENCY_MAX_EXPONENT))
+    {
+        return BUCKETS - 1;
+    }
+
+    int exponent = 63 - __builtin_clzll (valueUs);
+    int shift = exponent - TASE2_LATENCY_SUB_BUCKET_BITS;
+
+    size_t subBucket = (valueUs >> shift) & (SUB_BUCKETS - 1);
+
+    return (shift + 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t
+TASE2LatencyHistogram::bucketUpperBound (size_t index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    int shift = (int)(index / SUB_BUCKETS) - 1;
+    uint64_t subBucket = index % SUB_BUCKETS;
+
+    return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+void
+TASE2LatencyHistogram::record (uint64_t valueUs)
+{
+    m_buckets[bucketIndex (valueUs)].fetch_add (1, std::memory_order_relaxed);
+
+    m_count.fetch_add (1, std::memory_order_relaxed);
+    m_sum.fetch_add (valueUs, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load (std::memory_order_relaxed);
+
+    while (valueUs > max
+           && !m_max.compare_exchange_weak (max, valueUs,
+                                            std::memory_order_relaxed))
+    {
+    }
+}
+
+double
+TASE2LatencyHistogram::mean () const
+{
+    uint64_t n = count ();
+
+    return n ? (double)m_sum.load (std::memory_order_relaxed) / n : 0.0;
+}
+
+uint64_t
+TASE2LatencyHistogram::percentile (double percent) const
+{
+    uint64_t n = count ();
+
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    /* rank of the value, counted from 1 */
+    uint64_t rank = (uint64_t)(percent / 100.0 * n + 0.5);
+
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < BUCKETS; i++)
+    {
+        seen += m_buckets[i].load (std::memory_order_relaxed);
+
+        if (seen >= rank)
+        {
+            /* the bucket bound can exceed the largest recorded value */
+            uint64_t bound = bucketUpperBound (i);
+            uint64_t largest = max ();
+
+            return bound < largest ? bound : largest;
+        }
+    }
+
+    return max ();
+}
@@ -0,0 +1,519 @@
+#include "tase2_model_reader.hpp"
+#include "tase2.hpp"
+#include "tase2_config.hpp"
+
+using namespace rapidjson;
+
+#define MODEL_CONF_PATH "/model_conf"
+#define ICC_ARRAY_PATH "/model_conf/icc"
+#define ICC_PATH "/model_conf/icc/[]"
+#define ICC_NAME_PATH "/model_conf/icc/[]/name"
+
+/* sections the DOM import requires, reported when missing */
+#define SECTION_MODEL_CONF 0x01
+#define SECTION_VCC 0x02
+#define SECTION_VCC_POINTS 0x04
+#define SECTION_ICC 0x08
+#define SECTION_ICC_POINTS 0x10
+#define SECTION_BLT 0x20
+
+TASE2ModelReader::TASE2ModelReader (TASE2Config& config,
+                                    const std::string& modelConfig,
+                                    Tase2_DataModel model)
+    : m_config (config), m_modelConfig (modelConfig), m_model (model),
+      m_stream (modelConfig.c_str ()),
+      m_vcc (Tase2_DataModel_getVCC (model))
+{
+}
+
+TASE2ModelElement
+TASE2ModelReader::elementAt (const std::string& path)
+{
+    if (path == "/model_conf/icc/[]/datapoints/[]")
+    {
+        return MODEL_ELEMENT_ICC_POINT;
+    }
+    if (path == "/model_conf/vcc/datapoints/[]")
+    {
+        return MODEL_ELEMENT_VCC_POINT;
+    }
+    if (path == "/model_conf/bilateral_tables/[]")
+    {
+        return MODEL_ELEMENT_BLT;
+    }
+    if (path == "/model_conf/dataset_transfer_sets/[]")
+    {
+        return MODEL_ELEMENT_DTS;
+    }
+    if (path == "/model_conf/datasets/[]")
+    {
+        return MODEL_ELEMENT_DATASET;
+    }
+    if (path == "/model_conf/command_rate_limit")
+    {
+        return MODEL_ELEMENT_RATE_LIMIT;
+    }
+
+    return MODEL_ELEMENT_NONE;
+}
+
+bool
+TASE2ModelReader::parse ()
+{
+    Reader reader;
+
+    ParseResult result = reader.Parse<kParseDefaultFlags> (m_stream, *this);
+
+    if (result.IsError ())
+    {
+        /* the handler has logged why it stopped */
+        if (result.Code () != kParseErrorTermination)
+        {
+            Tase2Utility::log_fatal ("Parsing error in model configuration");
+            Tase2Utility::log_debug (
+                "Parsing error in model configuration at %zu: %s\n",
+                result.Offset (), GetParseError_En (result.Code ()));
+        }
+
+        return false;
+    }
+
+    if (!(m_sections & SECTION_MODEL_CONF))
+    {
+        Tase2Utility::log_error (
+            "Missing or invalid 'model_conf' object in model configuration");
+        return false;
+    }
+
+    return true;
+}
+
+/* scalars are only looked at inside the elements */
+bool
+TASE2ModelReader::Default ()
+{
+    if (m_elementDepth > 0)
+    {
+        return true;
+    }
+
+    if (m_frames.empty ())
+    {
+        Tase2Utility::log_error ("Model configuration is not an object");
+        return false;
+    }
+
+    return invalidElement (elementAt (m_path));
+}
+
+bool
+TASE2ModelReader::String (const char* str, SizeType length, bool copy)
+{
+    if (m_elementDepth == 0 && m_path == ICC_NAME_PATH)
+    {
+        return beginIcc (str, length);
+    }
+
+    return Default ();
+}
+
+bool
+TASE2ModelReader::StartObject ()
+{
+    if (m_elementDepth > 0)
+    {
+        m_elementDepth++;
+        return true;
+    }
+
+    m_element = elementAt (m_path);
+
+    if (m_element != MODEL_ELEMENT_NONE)
+    {
+        /* the reader has just taken the opening brace */
+        m_elementBegin = m_stream.Tell () - 1;
+        m_elementDepth = 1;
+        return true;
+    }
+
+    if (m_path == MODEL_CONF_PATH)
+    {
+        m_sections |= SECTION_MODEL_CONF;
+    }
+    else if (m_path == "/model_conf/vcc")
+    {
+        m_sections |= SECTION_VCC;
+    }
+    else if (m_path == ICC_PATH)
+    {
+        m_iccHasName = false;
+        m_iccName.clear ();
+        m_iccPoints.clear ();
+        m_sections &= ~SECTION_ICC_POINTS;
+    }
+
+    m_frames.push_back (m_path.size ());
+
+    return true;
+}
+
+bool
+TASE2ModelReader::Key (const char* str, SizeType length, bool copy)
+{
+    if (m_elementDepth > 0)
+    {
+        return true;
+    }
+
+    m_path.resize (m_frames.back ());
+    m_path += '/';
+    m_path.append (str, length);
+
+    return true;
+}
+
+bool
+TASE2ModelReader::EndObject (SizeType memberCount)
+{
+    if (m_elementDepth > 0)
+    {
+        if (--m_elementDepth > 0)
+        {
+            return true;
+        }
+
+        TASE2ModelSpan span = { m_element, m_elementBegin, m_stream.Tell () };
+
+        return importElement (span);
+    }
+
+    m_path.resize (m_frames.back ());
+    m_frames.pop_back ();
+
+    if (m_path == ICC_PATH)
+    {
+        return endIcc ();
+    }
+
+    if (m_path == MODEL_CONF_PATH)
+    {
+        return endModelConf ();
+    }
+
+    return true;
+}
+
+bool
+TASE2ModelReader::StartArray ()
+{
+    if (m_elementDepth > 0)
+    {
+        m_elementDepth++;
+        return true;
+    }
+
+    if (m_frames.empty ())
+    {
+        Tase2Utility::log_error ("Model configuration is not an object");
+        return false;
+    }
+
+    TASE2ModelElement element = elementAt (m_path);
+
+    if (element != MODEL_ELEMENT_NONE)
+    {
+        /* skipped like an element, without importing it */
+        m_element = MODEL_ELEMENT_NONE;
+        m_elementDepth = 1;
+
+        return invalidElement (element);
+    }
+
+    if (m_path == "/model_conf/vcc/datapoints")
+    {
+        m_sections |= SECTION_VCC_POINTS;
+    }
+    else if (m_path == ICC_ARRAY_PATH)
+    {
+        m_sections |= SECTION_ICC;
+        m_pool.reset (new TASE2ImportPool (
+            TASE2ImportPool::threadsFor (TASE2_IMPORT_MAX_THREADS)));
+    }
+    else if (m_path == "/model_conf/icc/[]/datapoints")
+    {
+        m_sections |= SECTION_ICC_POINTS;
+    }
+    else if (m_path == "/model_conf/bilateral_tables")
+    {
+        m_sections |= SECTION_BLT;
+    }
+
+    m_frames.push_back (m_path.size ());
+    m_path += "/[]";
+
+    return true;
+}
+
+bool
+TASE2ModelReader::EndArray (SizeType elementCount)
+{
+    if (m_elementDepth > 0)
+    {
+        m_elementDepth--;
+        return true;
+    }
+
+    m_path.resize (m_frames.back ());
+    m_frames.pop_back ();
+
+    if (m_path == ICC_ARRAY_PATH)
+    {
+        if (!commitIccs (true))
+        {
+            return false;
+        }
+
+        m_iccComplete = true;
+
+        return importPending (m_deferred);
+    }
+
+    return true;
+}
+
+/* a scalar or an array where the DOM import expects an object */
+bool
+TASE2ModelReader::invalidElement (TASE2ModelElement element)
+{
+    switch (element)
+    {
+        case MODEL_ELEMENT_VCC_POINT:
+            Tase2Utility::log_error ("DATAPOINT NOT AN OBJECT");
+            return false;
+
+        /* the points before it are still imported */
+        case MODEL_ELEMENT_ICC_POINT:
+            Tase2Utility::log_error ("DATAPOINT NOT AN OBJECT");
+            m_iccPoints.push_back ({ MODEL_ELEMENT_NONE, 0, 0 });
+            return true;
+
+        case MODEL_ELEMENT_BLT:
+            Tase2Utility::log_error ("BILATERAL TABLE MISSING NAME");
+            return false;
+
+        case MODEL_ELEMENT_DTS:
+            Tase2Utility::log_error ("DATASET TRANSFER SET NOT AN OBJECT");
+            return false;
+
+        case MODEL_ELEMENT_DATASET:
+            Tase2Utility::log_error ("DATASET TRANSFER SET NOT AN OBJECT");
+            return true;
+
+        default:
+            return true;
+    }
+}
+
+bool
+TASE2ModelReader::importElement (const TASE2ModelSpan& span)
+{
+    switch (span.element)
+    {
+        case MODEL_ELEMENT_ICC_POINT:
+            m_iccPoints.push_back (span);
+            return true;
+
+        case MODEL_ELEMENT_BLT:
+        case MODEL_ELEMENT_DTS:
+        case MODEL_ELEMENT_DATASET:
+            if (!m_iccComplete)
+            {
+                m_deferred.push_back (span);
+                return true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    /* the reader has validated the text of the element already */
+    Document element;
+
+    element.Parse (m_modelConfig.c_str () + span.begin,
+                   span.end - span.begin);
+
+    switch (span.element)
+    {
+        case MODEL_ELEMENT_RATE_LIMIT:
+            if (!m_config.m_controlPoints.empty ())
+            {
+                Tase2Utility::log_warn ("'command_rate_limit' after control "
+                                        "points, not applied to them");
+            }
+
+            m_config.importCommandRateLimits (element);
+            return true;
+
+        case MODEL_ELEMENT_VCC_POINT:
+            return m_config.importDatapoint (element, "vcc", m_vcc);
+
+        case MODEL_ELEMENT_BLT:
+            return m_config.importBilateralTable (element);
+
+        case MODEL_ELEMENT_DTS:
+            return m_config.importDSTransferSet (element);
+
+        case MODEL_ELEMENT_DATASET:
+            m_config.importDataset (element);
+            return true;
+
+        default:
+            return true;
+    }
+}
+
+bool
+TASE2ModelReader::importPending (std::vector<TASE2ModelSpan>& spans)
+{
+    std::vector<TASE2ModelSpan> pending;
+
+    pending.swap (spans);
+
+    for (const TASE2ModelSpan& span : pending)
+    {
+        if (!importElement (span))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+TASE2ModelReader::beginIcc (const char* name, size_t length)
+{
+    m_iccName.assign (name, length);
+    m_iccHasName = true;
+
+    return true;
+}
+
+bool
+TASE2ModelReader::endIcc ()
+{
+    m_iccs.emplace_back ();
+
+    TASE2StreamIcc& icc = m_iccs.back ();
+
+    icc.prepared.name = m_iccName;
+    icc.prepared.hasName = m_iccHasName;
+    icc.prepared.hasDatapoints = (m_sections & SECTION_ICC_POINTS) != 0;
+    icc.points.swap (m_iccPoints);
+
+    /* otherwise the commit reports what is missing */
+    if (icc.prepared.hasName && icc.prepared.hasDatapoints)
+    {
+        m_pool->submit ([this, &icc] { prepareIcc (icc); });
+    }
+    else
+    {
+        icc.done.store (true, std::memory_order_release);
+    }
+
+    /* prepared points are not kept longer than needed */
+    return commitIccs (false);
+}
+
+void
+TASE2ModelReader::prepareIcc (TASE2StreamIcc& icc)
+{
+    icc.prepared.points.reserve (icc.points.size ());
+
+    for (const TASE2ModelSpan& span : icc.points)
+    {
+        if (span.element == MODEL_ELEMENT_NONE)
+        {
+            icc.prepared.stop = true;
+            break;
+        }
+
+        /* the reader has validated the text of the point already */
+        Document point;
+
+        point.Parse (m_modelConfig.c_str () + span.begin,
+                     span.end - span.begin);
+
+        if (!m_config.prepareIccPoint (point, icc.prepared))
+        {
+            break;
+        }
+    }
+
+    /* the spans are not needed any more */
+    std::vector<TASE2ModelSpan> ().swap (icc.points);
+
+    icc.done.store (true, std::memory_order_release);
+}
+
+/* ICCs are committed in order, wait for the ones still being prepared
+ * or stop at the first of them */
+bool
+TASE2ModelReader::commitIccs (bool wait)
+{
+    if (wait)
+    {
+        m_pool->wait ();
+    }
+
+    while (!m_iccs.empty ()
+           && m_iccs.front ().done.load (std::memory_order_acquire))
+    {
+        if (!m_config.commitIcc (m_iccs.front ().prepared, m_model))
+        {
+            return false;
+        }
+
+        m_iccs.pop_front ();
+    }
+
+    return true;
+}
+
+/* the elements are imported by now, only report what is missing */
+bool
+TASE2ModelReader::endModelConf ()
+{
+    m_iccComplete = true;
+
+    if (!importPending (m_deferred))
+    {
+        return false;
+    }
+
+    if (!(m_sections & SECTION_VCC))
+    {
+        Tase2Utility::log_error (
+            "Missing or invalid 'vcc' object in 'model_conf'");
+    }
+    else if (!(m_sections & SECTION_VCC_POINTS))
+    {
+        Tase2Utility::log_error (
+            "Missing or invalid 'datapoints' array in 'vcc'");
+    }
+
+    if (!(m_sections & SECTION_ICC))
+    {
+        Tase2Utility::log_error (
+            "Missing or invalid 'icc' array in 'model_conf'");
+    }
+
+    if (!(m_sections & SECTION_BLT))
+    {
+        Tase2Utility::log_error (
+            "Missing or invalid 'bilateral_tables' array in 'model_conf'");
+    }
+
+    return true;
+}
@@ -0,0 +1,377 @@
+#include "tase2_model_snapshot.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <version.h>
+
+#define SNAPSHOT_MAGIC "TASE2MDL"
+#define SNAPSHOT_MAGIC_SIZE 8
+
+/* reads back differently on a host of the other byte order */
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+
+/* the records depend on the code that wrote them, not only on the format
+ * version: a snapshot is only replayed by the build that wrote it */
+#define SNAPSHOT_BUILD VERSION " " __DATE__ " " __TIME__
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+struct TASE2SnapshotHeader
+{
+    char magic[SNAPSHOT_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t hash;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+static uint64_t
+fnv1a (uint64_t hash, const char* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint64_t
+TASE2ModelSnapshot::hash (const std::string& modelConfig,
+                          const std::string& exchangeConfig)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    /* the nul keeps "ab" + "c" apart from "a" + "bc" */
+    hash = fnv1a (hash, SNAPSHOT_BUILD, sizeof (SNAPSHOT_BUILD));
+    hash = fnv1a (hash, modelConfig.c_str (), modelConfig.size () + 1);
+    hash = fnv1a (hash, exchangeConfig.c_str (), exchangeConfig.size () + 1);
+
+    return hash;
+}
+
+void
+TASE2ModelSnapshot::put (const void* data, size_t size)
+{
+    m_records.append ((const char*)data, size);
+}
+
+void
+TASE2ModelSnapshot::putString (const std::string& str)
+{
+    put<uint32_t> ((uint32_t)str.size ());
+    put (str.c_str (), str.size () + 1);
+}
+
+void
+TASE2ModelSnapshot::addRateLimits (const TASE2RateLimit& global,
+                                   const TASE2RateLimit& point)
+{
+    put<uint8_t> (SNAPSHOT_RATE_LIMITS);
+    put<double> (global.rate);
+    put<double> (global.burst);
+    put<double> (point.rate);
+    put<double> (point.burst);
+}
+
+void
+TASE2ModelSnapshot::addDomain (const std::string& name)
+{
+    put<uint8_t> (SNAPSHOT_DOMAIN);
+    putString (name);
+}
+
+void
+TASE2ModelSnapshot::addIndicationPoint (bool vcc, const std::string& domain,
+                                        const std::string& name, DPTYPE type,
+                                        bool hasCOV,
+                                        const TASE2IndicationOptions& options)
+{
+    put<uint8_t> (SNAPSHOT_INDICATION);
+    put<uint8_t> (vcc);
+    putString (domain);
+    putString (name);
+    put<uint8_t> ((uint8_t)type);
+    put<uint8_t> (hasCOV);
+    put<uint8_t> (options.coalesceExempt);
+    put<double> (options.deadband);
+    put<double> (options.deadbandPercent);
+    put<uint8_t> (options.suppressIdentical);
+}
+
+void
+TASE2ModelSnapshot::addControlPoint (bool vcc, const std::string& domain,
+                                     const std::string& name, DPTYPE type,
+                                     Tase2_DeviceClass deviceClass,
+                                     bool hasTag, int16_t checkBackId,
+                                     const TASE2RateLimit& limit)
+{
+    put<uint8_t> (SNAPSHOT_CONTROL);
+    put<uint8_t> (vcc);
+    putString (domain);
+    putString (name);
+    put<uint8_t> ((uint8_t)type);
+    put<uint8_t> ((uint8_t)deviceClass);
+    put<uint8_t> (hasTag);
+    put<int16_t> (checkBackId);
+    put<double> (limit.rate);
+    put<double> (limit.burst);
+}
+
+void
+TASE2ModelSnapshot::addBilateralTable (const std::string& name,
+                                       const std::string& icc,
+                                       const std::string& apTitle,
+                                       int aeQualifier)
+{
+    put<uint8_t> (SNAPSHOT_BLT);
+    putString (name);
+    putString (icc);
+    putString (apTitle);
+    put<int32_t> (aeQualifier);
+}
+
+void
+TASE2ModelSnapshot::addBilateralTablePoint (uint32_t pointId)
+{
+    put<uint8_t> (SNAPSHOT_BLT_POINT);
+    put<uint32_t> (pointId);
+}
+
+void
+TASE2ModelSnapshot::addDSTransferSet (const std::string& domain,
+                                      const std::string& name)
+{
+    put<uint8_t> (SNAPSHOT_DSTS);
+    putString (domain);
+    putString (name);
+}
+
+void
+TASE2ModelSnapshot::addDataset (const std::string& domain,
+                                const std::string& name)
+{
+    put<uint8_t> (SNAPSHOT_DATASET);
+    putString (domain);
+    putString (name);
+}
+
+void
+TASE2ModelSnapshot::addDatasetEntry (const std::string& name)
+{
+    put<uint8_t> (SNAPSHOT_DATASET_ENTRY);
+    putString (name);
+}
+
+void
+TASE2ModelSnapshot::addExchangedPoint (uint32_t pointId,
+                                       const std::string& domain,
+                                       const std::string& label,
+                                       const std::string& pivotId)
+{
+    put<uint8_t> (SNAPSHOT_EXCHANGE);
+    put<uint32_t> (pointId);
+    putString (domain);
+    putString (label);
+    putString (pivotId);
+}
+
+bool
+TASE2ModelSnapshot::save (const std::string& path) const
+{
+    TASE2SnapshotHeader header;
+
+    memset (&header, 0, sizeof (header));
+    memcpy (header.magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    header.version = TASE2_SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.hash = m_hash;
+    header.size = m_records.size ();
+    header.checksum
+        = fnv1a (FNV_OFFSET_BASIS, m_records.data (), m_records.size ());
+
+    /* a reader never sees a partly written file */
+    std::string tmpPath = path + ".tmp";
+
+    FILE* file = fopen (tmpPath.c_str (), "wb");
+
+    if (!file)
+    {
+        return false;
+    }
+
+    bool written
+        = fwrite (&header, sizeof (header), 1, file) == 1
+          && (m_records.empty ()
+              || fwrite (m_records.data (), m_records.size (), 1, file) == 1);
+
+    if (fclose (file) != 0 || !written
+        || rename (tmpPath.c_str (), path.c_str ()) != 0)
+    {
+        unlink (tmpPath.c_str ());
+        return false;
+    }
+
+    return true;
+}
+
+bool
+TASE2ModelSnapshot::remove (const std::string& path)
+{
+    return unlink (path.c_str ()) == 0 || errno == ENOENT;
+}
+
+TASE2SnapshotReader::~TASE2SnapshotReader ()
+{
+    unmap ();
+}
+
+void
+TASE2SnapshotReader::unmap ()
+{
+    if (m_mapping)
+    {
+        munmap (m_mapping, m_mappingSize);
+        m_mapping = nullptr;
+    }
+
+    m_pos = m_end = nullptr;
+}
+
+bool
+TASE2SnapshotReader::open (const std::string& path, uint64_t hash)
+{
+    unmap ();
+
+    int fd = ::open (path.c_str (), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat (fd, &st) != 0
+        || (size_t)st.st_size < sizeof (TASE2SnapshotHeader))
+    {
+        close (fd);
+        return false;
+    }
+
+    void* mapping
+        = mmap (nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close (fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_mappingSize = (size_t)st.st_size;
+
+    TASE2SnapshotHeader header;
+
+    memcpy (&header, mapping, sizeof (header));
+
+    const char* records = (const char*)mapping + sizeof (header);
+
+    if (memcmp (header.magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0
+        || header.version != TASE2_SNAPSHOT_VERSION
+        || header.byteOrder != SNAPSHOT_BYTE_ORDER || header.hash != hash
+        || header.size != m_mappingSize - sizeof (header)
+        || header.checksum != fnv1a (FNV_OFFSET_BASIS, records, header.size))
+    {
+        return false;
+    }
+
+    m_pos = records;
+    m_end = records + header.size;
+    m_error = false;
+
+    return true;
+}
+
+bool
+TASE2SnapshotReader::next (TASE2SnapshotRecord& record)
+{
+    if (m_error || m_pos == m_end)
+    {
+        return false;
+    }
+
+    record = static_cast<TASE2SnapshotRecord> (getU8 ());
+
+    return !m_error;
+}
+
+void
+TASE2SnapshotReader::get (void* data, size_t size)
+{
+    if (m_error || (size_t)(m_end - m_pos) < size)
+    {
+        m_error = true;
+        memset (data, 0, size);
+        return;
+    }
+
+    memcpy (data, m_pos, size);
+    m_pos += size;
+}
+
+uint8_t
+TASE2SnapshotReader::getU8 ()
+{
+    return get<uint8_t> ();
+}
+
+int16_t
+TASE2SnapshotReader::getI16 ()
+{
+    return get<int16_t> ();
+}
+
+int32_t
+TASE2SnapshotReader::getI32 ()
+{
+    return get<int32_t> ();
+}
+
+uint32_t
+TASE2SnapshotReader::getU32 ()
+{
+    return get<uint32_t> ();
+}
+
+double
+TASE2SnapshotReader::getDouble ()
+{
+    return get<double> ();
+}
+
+const char*
+TASE2SnapshotReader::getString ()
+{
+    uint32_t length = getU32 ();
+
+    if (m_error || (size_t)(m_end - m_pos) <= length || m_pos[length] != 0)
+    {
+        m_error = true;
+        return "";
+    }
+
+    const char* str = m_pos;
+    m_pos += length + 1;
+
+    return str;
+}
@@ -1,18 +1,194 @@
-#include "tase2.hpp"
+#include "tase2_outstanding_command.hpp"
 
-TASE2OutstandingCommand::TASE2OutstandingCommand (const std::string& domain,
-                                                  const std::string& name,
-                                                  int cmdExecTimeout,
-                                                  bool isSelect)
-    : m_domain (domain), m_name (name), m_cmdExecTimeout (cmdExecTimeout),
-      m_state (1)
+bool
+TASE2OutstandingCommand::select (uint64_t id, uint64_t now, int selectTimeout,
+                                 uint64_t receivedUs)
+{
+    if (!canSelect ())
+    {
+        return false;
+    }
+
+    m_state = COMMAND_SELECTED;
+    m_selectConfirmed = false;
+    m_id = id;
+    m_deadline = now + (uint64_t)selectTimeout * 1000;
+    m_receivedUs = receivedUs;
+
+    return true;
+}
+
+bool
+TASE2OutstandingCommand::operate (uint64_t id, uint64_t now,
+                                  int cmdExecTimeout, uint64_t receivedUs)
+{
+    if (!canOperate ())
+    {
+        return false;
+    }
+
+    m_state = COMMAND_OPERATING;
+    m_id = id;
+    m_deadline = now + (uint64_t)cmdExecTimeout * 1000;
+    m_receivedUs = receivedUs;
+
+    return true;
+}
+
+bool
+TASE2OutstandingCommand::confirm ()
+{
+    if (m_state == COMMAND_OPERATING)
+    {
+        m_state = COMMAND_CONFIRMED;
+        return true;
+    }
+
+    if (m_state == COMMAND_SELECTED && !m_selectConfirmed)
+    {
+        m_selectConfirmed = true;
+        return true;
+    }
+
+    return false;
+}
+
+bool
+TASE2OutstandingCommand::expire (uint64_t id)
+{
+    if (!isActive () || id != m_id)
+    {
+        return false;
+    }
+
+    m_state = COMMAND_IDLE;
+
+    return true;
+}
+
+void
+TASE2OutstandingCommand::cancel ()
+{
+    m_state = COMMAND_IDLE;
+}
+
+void
+TASE2OutstandingCommands::init (
+    const std::unordered_map<Tase2_ControlPoint, TASE2Datapoint*>&
+        controlPoints)
+{
+    clear ();
+
+    m_slots.assign (controlPoints.size (), TASE2OutstandingCommand ());
+
+    for (const auto& entry : controlPoints)
+    {
+        size_t index = entry.second->getControlIndex ();
+
+        if (index < m_slots.size ())
+        {
+            m_slots[index].m_controlPoint = entry.second;
+        }
+    }
+}
+
+void
+TASE2OutstandingCommands::track (TASE2OutstandingCommand& command,
+                                 bool wasActive)
 {
-    m_commandRcvdTime = Hal_getTimeInMs ();
-    m_nextTimeout = m_commandRcvdTime + (m_cmdExecTimeout * 1000);
+    if (command.isActive () == wasActive)
+    {
+        return;
+    }
+
+    if (wasActive)
+    {
+        m_active--;
+        command.m_controlPoint->removeOutstandingCommand ();
+    }
+    else
+    {
+        m_active++;
+        command.m_controlPoint->addOutstandingCommand ();
+    }
 }
 
 bool
-TASE2OutstandingCommand::hasTimedOut (uint64_t currentTime)
+TASE2OutstandingCommands::select (TASE2OutstandingCommand& command,
+                                  uint64_t now, int selectTimeout,
+                                  uint64_t receivedUs)
+{
+    bool wasActive = command.isActive ();
+
+    if (!command.select (m_nextId, now, selectTimeout, receivedUs))
+    {
+        return false;
+    }
+
+    m_nextId++;
+    track (command, wasActive);
+
+    return true;
+}
+
+bool
+TASE2OutstandingCommands::operate (TASE2OutstandingCommand& command,
+                                   uint64_t now, int cmdExecTimeout,
+                                   uint64_t receivedUs)
+{
+    bool wasActive = command.isActive ();
+
+    if (!command.operate (m_nextId, now, cmdExecTimeout, receivedUs))
+    {
+        return false;
+    }
+
+    m_nextId++;
+    track (command, wasActive);
+
+    return true;
+}
+
+bool
+TASE2OutstandingCommands::confirm (TASE2OutstandingCommand& command)
+{
+    bool wasActive = command.isActive ();
+
+    bool confirmed = command.confirm ();
+
+    track (command, wasActive);
+
+    return confirmed;
+}
+
+bool
+TASE2OutstandingCommands::expire (TASE2OutstandingCommand& command,
+                                  uint64_t id)
+{
+    bool wasActive = command.isActive ();
+
+    bool expired = command.expire (id);
+
+    track (command, wasActive);
+
+    return expired;
+}
+
+void
+TASE2OutstandingCommands::cancel (TASE2OutstandingCommand& command)
+{
+    bool wasActive = command.isActive ();
+
+    command.cancel ();
+
+    track (command, wasActive);
+}
+
+void
+TASE2OutstandingCommands::clear ()
 {
-    return (currentTime > m_nextTimeout);
+    for (auto& command : m_slots)
+    {
+        cancel (command);
+    }
 }
@@ -0,0 +1,237 @@
+#include "tase2_pivot.hpp"
+
+#include <cstring>
+#include <vector>
+
+template <size_t N>
+static bool
+equals (const std::string& value, const char (&literal)[N])
+{
+    return value.size () == N - 1
+           && memcmp (value.data (), literal, N - 1) == 0;
+}
+
+static bool
+copyIdentifier (const DatapointValue& value, char* buffer)
+{
+    if (value.getType () != DatapointValue::T_STRING)
+    {
+        return false;
+    }
+
+    std::string id = value.toStringValue ();
+
+    if (id.size () > TASE2_PIVOT_MAX_ID_LENGTH)
+    {
+        return false;
+    }
+
+    memcpy (buffer, id.data (), id.size ());
+    buffer[id.size ()] = '\0';
+
+    return true;
+}
+
+PivotAttribute
+TASE2PivotDecoder::getAttribute (const std::string& name)
+{
+    /* all pivot attribute names share the "do_" prefix, the length and the
+     * first character after it are enough to tell them apart */
+    switch (hash (name.data (), name.size (), 3))
+    {
+    case key ("do_domain", 3):
+        return equals (name, "do_domain") ? PIVOT_ATTR_DOMAIN
+                                          : PIVOT_ATTR_UNKNOWN;
+    case key ("do_name", 3):
+        return equals (name, "do_name") ? PIVOT_ATTR_NAME : PIVOT_ATTR_UNKNOWN;
+    case key ("do_type", 3):
+        return equals (name, "do_type") ? PIVOT_ATTR_TYPE : PIVOT_ATTR_UNKNOWN;
+    case key ("do_value", 3):
+        return equals (name, "do_value") ? PIVOT_ATTR_VALUE
+                                         : PIVOT_ATTR_UNKNOWN;
+    case key ("do_validity", 3):
+        return equals (name, "do_validity") ? PIVOT_ATTR_VALIDITY
+                                            : PIVOT_ATTR_UNKNOWN;
+    case key ("do_cs", 3):
+        return equals (name, "do_cs") ? PIVOT_ATTR_CS : PIVOT_ATTR_UNKNOWN;
+    case key ("do_quality_normal_value", 3):
+        return equals (name, "do_quality_normal_value")
+                   ? PIVOT_ATTR_NORMAL_VALUE
+                   : PIVOT_ATTR_UNKNOWN;
+    case key ("do_ts", 3):
+        return equals (name, "do_ts") ? PIVOT_ATTR_TS : PIVOT_ATTR_UNKNOWN;
+    case key ("do_ts_validity", 3):
+        return equals (name, "do_ts_validity") ? PIVOT_ATTR_TS_VALIDITY
+                                               : PIVOT_ATTR_UNKNOWN;
+    default:
+        return PIVOT_ATTR_UNKNOWN;
+    }
+}
+
+Tase2_DataFlags
+TASE2PivotDecoder::getValidityFlags (const std::string& validity)
+{
+    switch (hash (validity.data (), validity.size (), 0))
+    {
+    case key ("valid", 0):
+        return equals (validity, "valid") ? TASE2_DATA_FLAGS_VALIDITY_VALID
+                                          : 0;
+    case key ("held", 0):
+        return equals (validity, "held") ? TASE2_DATA_FLAGS_VALIDITY_HELD : 0;
+    case key ("suspect", 0):
+        return equals (validity, "suspect") ? TASE2_DATA_FLAGS_VALIDITY_SUSPECT
+                                            : 0;
+    case key ("invalid", 0):
+        return equals (validity, "invalid")
+                   ? TASE2_DATA_FLAGS_VALIDITY_NOTVALID
+                   : 0;
+    default:
+        return 0;
+    }
+}
+
+Tase2_DataFlags
+TASE2PivotDecoder::getCurrentSourceFlags (const std::string& currentSource)
+{
+    switch (hash (currentSource.data (), currentSource.size (), 0))
+    {
+    case key ("telemetered", 0):
+        return equals (currentSource, "telemetered")
+                   ? TASE2_DATA_FLAGS_CURRENT_SOURCE_TELEMETERED
+                   : 0;
+    case key ("entered", 0):
+        return equals (currentSource, "entered")
+                   ? TASE2_DATA_FLAGS_CURRENT_SOURCE_ENTERED
+                   : 0;
+    case key ("calculated", 0):
+        return equals (currentSource, "calculated")
+                   ? TASE2_DATA_FLAGS_CURRENT_SOURCE_CALCULATED
+                   : 0;
+    case key ("estimated", 0):
+        return equals (currentSource, "estimated")
+                   ? TASE2_DATA_FLAGS_CURRENT_SOURCE_ESTIMATED
+                   : 0;
+    default:
+        return 0;
+    }
+}
+
+bool
+TASE2PivotDecoder::decode (Datapoint* dataObject, TASE2PivotRecord& record,
+                           bool identifiers)
+{
+    record.domain[0] = '\0';
+    record.name[0] = '\0';
+    record.type = DP_TYPE_UNKNOWN;
+    record.valueKind = PIVOT_VALUE_NONE;
+    record.intValue = 0;
+    record.floatValue = 0.0;
+    record.dataFlags = 0;
+    record.hasTs = false;
+    record.timestamp = 0;
+    record.tsValid = true;
+
+    DatapointValue& dpv = dataObject->getData ();
+
+    if (dpv.getType () != DatapointValue::T_DP_DICT
+        && dpv.getType () != DatapointValue::T_DP_LIST)
+    {
+        return false;
+    }
+
+    std::vector<Datapoint*>* attributes = dpv.getDpVec ();
+
+    if (!attributes)
+    {
+        return false;
+    }
+
+    bool success = true;
+
+    for (Datapoint* attribute : *attributes)
+    {
+        DatapointValue& attrVal = attribute->getData ();
+
+        switch (getAttribute (attribute->getName ()))
+        {
+        case PIVOT_ATTR_DOMAIN:
+            if (identifiers)
+            {
+                success = copyIdentifier (attrVal, record.domain) && success;
+            }
+            break;
+
+        case PIVOT_ATTR_NAME:
+            if (identifiers)
+            {
+                success = copyIdentifier (attrVal, record.name) && success;
+            }
+            break;
+
+        case PIVOT_ATTR_TYPE:
+            if (identifiers && attrVal.getType () == DatapointValue::T_STRING)
+            {
+                record.type = TASE2Datapoint::getDpTypeFromString (
+                    attrVal.toStringValue ());
+            }
+            break;
+
+        case PIVOT_ATTR_VALUE:
+            if (attrVal.getType () == DatapointValue::T_INTEGER)
+            {
+                record.valueKind = PIVOT_VALUE_INTEGER;
+                record.intValue = attrVal.toInt ();
+            }
+            else if (attrVal.getType () == DatapointValue::T_FLOAT)
+            {
+                record.valueKind = PIVOT_VALUE_FLOAT;
+                record.floatValue = attrVal.toDouble ();
+            }
+            else
+            {
+                record.valueKind = PIVOT_VALUE_OTHER;
+            }
+            break;
+
+        case PIVOT_ATTR_VALIDITY:
+            if (attrVal.getType () == DatapointValue::T_STRING)
+            {
+                record.dataFlags
+                    |= getValidityFlags (attrVal.toStringValue ());
+            }
+            break;
+
+        case PIVOT_ATTR_CS:
+            if (attrVal.getType () == DatapointValue::T_STRING)
+            {
+                record.dataFlags
+                    |= getCurrentSourceFlags (attrVal.toStringValue ());
+            }
+            break;
+
+        case PIVOT_ATTR_NORMAL_VALUE:
+            if (attrVal.getType () == DatapointValue::T_STRING
+                && equals (attrVal.toStringValue (), "normal"))
+            {
+                record.dataFlags |= TASE2_DATA_FLAGS_NORMAL_VALUE;
+            }
+            break;
+
+        case PIVOT_ATTR_TS:
+            record.timestamp = (uint64_t)attrVal.toInt ();
+            record.hasTs = true;
+            break;
+
+        case PIVOT_ATTR_TS_VALIDITY:
+            record.tsValid
+                = !(attrVal.getType () == DatapointValue::T_STRING
+                    && equals (attrVal.toStringValue (), "invalid"));
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return success;
+}
@@ -0,0 +1,225 @@
+#include "tase2_point_index.hpp"
+
+#include <algorithm>
+#include <new>
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static uint64_t
+fnv1a (uint64_t hash, const char* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<uint8_t> (data[i]);
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint64_t
+TASE2PointIndex::hash (TASE2StringRef domain, TASE2StringRef name)
+{
+    uint64_t h = fnv1a (FNV_OFFSET_BASIS, domain.data, domain.size);
+
+    /* separator, so that "ab" + "c" and "a" + "bc" do not collide */
+    h ^= 0xff;
+    h *= FNV_PRIME;
+
+    return fnv1a (h, name.data, name.size);
+}
+
+TASE2PointIndex::~TASE2PointIndex ()
+{
+    clear ();
+}
+
+void
+TASE2PointIndex::clear ()
+{
+    for (uint32_t pointId = 0; pointId < size (); pointId++)
+    {
+        point (pointId)->~TASE2Datapoint ();
+    }
+
+    m_hashes.clear ();
+    m_domainIds.clear ();
+    m_chunks.clear ();
+    m_slots.clear ();
+    m_domainNames.clear ();
+}
+
+void
+TASE2PointIndex::reserve (size_t count)
+{
+    m_hashes.reserve (count);
+    m_domainIds.reserve (count);
+    m_chunks.reserve ((count + TASE2_POINT_CHUNK - 1) / TASE2_POINT_CHUNK);
+
+    size_t slotCount = 16;
+
+    while (slotCount < count * 2)
+    {
+        slotCount *= 2;
+    }
+
+    if (slotCount > m_slots.size ())
+    {
+        rehash (slotCount);
+    }
+}
+
+size_t
+TASE2PointIndex::findSlot (TASE2StringRef domain, TASE2StringRef name,
+                           uint64_t hash, size_t* probes) const
+{
+    size_t mask = m_slots.size () - 1;
+    size_t slot = hash & mask;
+
+    if (probes)
+    {
+        *probes = 1;
+    }
+
+    /* linear probing, the load factor is kept below 1/2 */
+    while (m_slots[slot] != 0)
+    {
+        uint32_t pointId = m_slots[slot] - 1;
+
+        if (m_hashes[pointId] == hash
+            && domain == m_domainNames[m_domainIds[pointId]]
+            && name == point (pointId)->getLabel ())
+        {
+            break;
+        }
+
+        slot = (slot + 1) & mask;
+
+        if (probes)
+        {
+            (*probes)++;
+        }
+    }
+
+    return slot;
+}
+
+void
+TASE2PointIndex::rehash (size_t slotCount)
+{
+    m_slots.assign (slotCount, 0);
+
+    size_t mask = slotCount - 1;
+
+    for (size_t i = 0; i < m_hashes.size (); i++)
+    {
+        size_t slot = m_hashes[i] & mask;
+
+        while (m_slots[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        m_slots[slot] = static_cast<uint32_t> (i + 1);
+    }
+}
+
+TASE2Datapoint*
+TASE2PointIndex::insert (const std::string& domain, const std::string& name,
+                         DPTYPE type)
+{
+    if ((size () + 1) * 2 > m_slots.size ())
+    {
+        rehash (std::max<size_t> (16, m_slots.size () * 2));
+    }
+
+    uint64_t h = hash (domain, name);
+    size_t slot = findSlot (domain, name, h);
+
+    /* the point may be referred to already, by control point maps and
+     * outstanding commands, it is never replaced */
+    if (m_slots[slot] != 0)
+    {
+        return nullptr;
+    }
+
+    uint32_t pointId = static_cast<uint32_t> (size ());
+
+    if (pointId / TASE2_POINT_CHUNK == m_chunks.size ())
+    {
+        m_chunks.emplace_back (new PointStorage[TASE2_POINT_CHUNK]);
+    }
+
+    TASE2Datapoint* t2dp = new (point (pointId)) TASE2Datapoint (name, type);
+
+    t2dp->setPointId (pointId);
+
+    m_hashes.push_back (h);
+    m_domainIds.push_back (internDomain (domain));
+    m_slots[slot] = pointId + 1;
+
+    return t2dp;
+}
+
+TASE2Datapoint*
+TASE2PointIndex::find (TASE2StringRef domain, TASE2StringRef name) const
+{
+    if (m_slots.empty ())
+    {
+        return nullptr;
+    }
+
+    size_t slot = findSlot (domain, name, hash (domain, name));
+
+    if (m_slots[slot] == 0)
+    {
+        return nullptr;
+    }
+
+    return point (m_slots[slot] - 1);
+}
+
+size_t
+TASE2PointIndex::probes (TASE2StringRef domain, TASE2StringRef name) const
+{
+    size_t probes = 0;
+
+    if (!m_slots.empty ())
+    {
+        findSlot (domain, name, hash (domain, name), &probes);
+    }
+
+    return probes;
+}
+
+uint32_t
+TASE2PointIndex::internDomain (const std::string& domain)
+{
+    /* only a handful of domains (VCC and the ICCs), not on the hot path */
+    for (size_t i = 0; i < m_domainNames.size (); i++)
+    {
+        if (m_domainNames[i] == domain)
+        {
+            return static_cast<uint32_t> (i);
+        }
+    }
+
+    m_domainNames.push_back (domain);
+
+    return static_cast<uint32_t> (m_domainNames.size () - 1);
+}
+
+bool
+TASE2PointIndex::hasDomain (TASE2StringRef domain) const
+{
+    for (const std::string& name : m_domainNames)
+    {
+        if (domain == name)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
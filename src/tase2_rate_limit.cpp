@@ -0,0 +1,48 @@
+#include "tase2_rate_limit.hpp"
+#include <algorithm>
+
+TASE2TokenBucket::TASE2TokenBucket (const TASE2RateLimit& limit)
+{
+    configure (limit);
+}
+
+void
+TASE2TokenBucket::configure (const TASE2RateLimit& limit)
+{
+    m_rate = std::max (limit.rate, 0.0);
+
+    /* a bucket has to hold at least one command */
+    m_burst = std::max (limit.burst, 1.0);
+
+    /* starts full, the first burst is accepted */
+    m_tokens = m_burst;
+    m_lastUs = 0;
+}
+
+bool
+TASE2TokenBucket::refill (uint64_t nowUs)
+{
+    if (!isLimited ())
+    {
+        return true;
+    }
+
+    if (m_lastUs != 0 && nowUs > m_lastUs)
+    {
+        m_tokens = std::min (m_burst,
+                             m_tokens + (nowUs - m_lastUs) * m_rate / 1e6);
+    }
+
+    m_lastUs = nowUs;
+
+    return m_tokens >= 1.0;
+}
+
+void
+TASE2TokenBucket::take ()
+{
+    if (isLimited ())
+    {
+        m_tokens -= 1.0;
+    }
+}
@@ -0,0 +1,3 @@
+#include "tase2_update_traits.hpp"
+
+constexpr TASE2UpdateTraits TASE2UpdateTable::s_table[COMMAND];
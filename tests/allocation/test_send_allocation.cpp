@@ -0,0 +1,267 @@
+#include "tase2.hpp"
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+#include <reading.h>
+
+using namespace std;
+
+/*
+ * Built into its own executable (RunAllocationTests): the replaced global
+ * operator new counts every allocation of the process, it must not be
+ * linked into RunTests.
+ *
+ * The send path of known assets allocates nothing itself. The only heap
+ * copies left are those made by Fledge accessors returning names by
+ * value, they are measured separately and are the upper bound.
+ */
+
+#define SEND_POINTS 16
+#define SEND_ROUNDS 100
+
+/* allocation counter for the calling thread, enabled only inside the
+ * measured sections */
+static thread_local bool countAllocations = false;
+static thread_local size_t allocationCount = 0;
+
+void*
+operator new (size_t size)
+{
+    if (countAllocations)
+        allocationCount++;
+
+    void* p = malloc (size ? size : 1);
+
+    if (p == nullptr)
+        throw std::bad_alloc ();
+
+    return p;
+}
+
+void
+operator delete (void* p) noexcept
+{
+    free (p);
+}
+
+static string protocol_stack = QUOTE ({
+    "protocol_stack" : {
+        "name" : "tase2north",
+        "version" : "1.0",
+        "transport_layer" : {
+            "srv_ip" : "0.0.0.0",
+            "port" : 10002,
+            "passive" : true,
+            "localApTitle" : "1.1.1.999:12",
+            "remoteApTitle" : "1.1.1.998:12"
+        }
+    }
+});
+
+/* identifiers and asset names longer than the std::string small buffer */
+static string
+pointName (int i)
+{
+    return "measurementWithAVeryLongName" + to_string (i);
+}
+
+static string
+assetLabel (int i)
+{
+    return "TM_MEASUREMENT_" + to_string (i);
+}
+
+static string
+createModelConfig ()
+{
+    string config = "{\"model_conf\":{\"vcc\":{\"datapoints\":[]},"
+                    "\"icc\":[{\"name\":\"icc1\",\"datapoints\":[";
+
+    for (int i = 0; i < SEND_POINTS; i++)
+    {
+        if (i > 0)
+        {
+            config += ",";
+        }
+
+        config += "{\"name\":\"" + pointName (i)
+                  + "\",\"type\":\""
+                  + (i % 2 ? "RealQTime" : "DiscreteQTime")
+                  + "\",\"hasCOV\":false,\"suppress_identical\":true}";
+    }
+
+    return config + "]}],\"bilateral_tables\":[]}}";
+}
+
+static string
+createExchangedData ()
+{
+    string config = "{\"exchanged_data\":{\"datapoints\":[";
+
+    for (int i = 0; i < SEND_POINTS; i++)
+    {
+        if (i > 0)
+        {
+            config += ",";
+        }
+
+        config += "{\"pivot_id\":\"" + assetLabel (i) + "\",\"label\":\""
+                  + assetLabel (i)
+                  + "\",\"protocols\":[{\"name\":\"tase2\",\"ref\":\"icc1:"
+                  + pointName (i) + "\"}]}";
+    }
+
+    return config + "]}}";
+}
+
+template <class T>
+static Datapoint*
+createDatapoint (const std::string& dataname, const T value)
+{
+    DatapointValue dp_value = DatapointValue (value);
+    return new Datapoint (dataname, dp_value);
+}
+
+static Reading*
+createReading (int i, int offset)
+{
+    auto* attributes = new vector<Datapoint*>;
+
+    attributes->push_back (
+        createDatapoint ("do_type", i % 2 ? "RealQTime" : "DiscreteQTime"));
+    attributes->push_back (createDatapoint ("do_domain", "icc1"));
+    attributes->push_back (createDatapoint ("do_name", pointName (i)));
+
+    if (i % 2)
+    {
+        attributes->push_back (
+            createDatapoint ("do_value", 0.5 * i + offset));
+    }
+    else
+    {
+        attributes->push_back (
+            createDatapoint ("do_value", (long)(i + offset)));
+    }
+
+    attributes->push_back (createDatapoint ("do_validity", "held"));
+    attributes->push_back (createDatapoint ("do_cs", "telemetered"));
+    attributes->push_back (
+        createDatapoint ("do_quality_normal_value", "normal"));
+    attributes->push_back (createDatapoint ("do_ts", (long)123456));
+    attributes->push_back (createDatapoint ("do_ts_validity", "valid"));
+
+    DatapointValue dpv (attributes, true);
+
+    vector<Datapoint*> dataObjects;
+    dataObjects.push_back (new Datapoint ("data_object", dpv));
+
+    return new Reading (assetLabel (i), dataObjects);
+}
+
+/*
+ * Allocations of the Fledge accessors called by the send path for the
+ * batch. The asset and datapoint names are returned by value, a name
+ * longer than the small buffer ("do_quality_normal_value") is copied to
+ * the heap by Fledge itself on every call.
+ */
+static size_t
+accessorAllocations (const vector<Reading*>& readings)
+{
+    size_t length = 0;
+
+    allocationCount = 0;
+    countAllocations = true;
+
+    for (Reading* reading : readings)
+    {
+        length += reading->getAssetName ().size ();
+
+        for (Datapoint* dp : reading->getReadingData ())
+        {
+            length += dp->getName ().size ();
+
+            for (Datapoint* attribute : *dp->getData ().getDpVec ())
+            {
+                length += attribute->getName ().size ();
+            }
+        }
+    }
+
+    countAllocations = false;
+
+    EXPECT_GT (length, 0);
+
+    return allocationCount;
+}
+
+TEST (SendAllocationTest, KnownBatchAllocatesOnlyInFledge)
+{
+    TASE2Server* tase2Server = new TASE2Server ();
+
+    tase2Server->setJsonConfig (protocol_stack, createExchangedData (), "",
+                                createModelConfig ());
+    tase2Server->start ();
+
+    /* the batches alternate, every update passes the identical value
+     * filter and reaches the model */
+    vector<Reading*> first;
+    vector<Reading*> second;
+
+    for (int i = 0; i < SEND_POINTS; i++)
+    {
+        first.push_back (createReading (i, 0));
+        second.push_back (createReading (i, 1));
+    }
+
+    /* warm up: sizes the pending update vector */
+    ASSERT_EQ (tase2Server->send (first), SEND_POINTS);
+    ASSERT_EQ (tase2Server->send (second), SEND_POINTS);
+
+    size_t accessors = accessorAllocations (first)
+                       + accessorAllocations (second);
+
+    allocationCount = 0;
+    countAllocations = true;
+
+    uint32_t sent = 0;
+
+    for (int round = 0; round < SEND_ROUNDS; round++)
+    {
+        sent += tase2Server->send (first);
+        sent += tase2Server->send (second);
+    }
+
+    countAllocations = false;
+
+    /* the plugin adds none of its own */
+    ASSERT_LE (allocationCount, accessors * SEND_ROUNDS);
+    ASSERT_EQ (sent, 2 * SEND_POINTS * SEND_ROUNDS);
+    ASSERT_EQ (tase2Server->getSuppressedUpdates (), 0);
+
+    Tase2_DataFlags flags = TASE2_DATA_FLAGS_VALIDITY_HELD
+                            | TASE2_DATA_FLAGS_CURRENT_SOURCE_TELEMETERED;
+
+    /* the values of the second batch are the ones committed last */
+    for (int i = 0; i < SEND_POINTS; i++)
+    {
+        TASE2Datapoint* point = tase2Server->getConfig ()->findDatapoint (
+            "icc1", pointName (i));
+
+        ASSERT_NE (point, nullptr);
+        ASSERT_FALSE (
+            point->checkChange (i + 1, 0.5 * i + 1, i % 2, flags));
+    }
+
+    for (Reading* reading : first)
+    {
+        delete reading;
+    }
+
+    for (Reading* reading : second)
+    {
+        delete reading;
+    }
+
+    tase2Server->stop ();
+    delete tase2Server;
+}
@@ -0,0 +1,133 @@
+#ifndef TASE2_TEST_MODEL_H
+#define TASE2_TEST_MODEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tase2.hpp"
+
+/* what a model import built, the model itself is already destroyed */
+struct ImportResult
+{
+    /* "domain:label" in point id order */
+    std::vector<std::string> points;
+    size_t controlPoints;
+    size_t bilateralTables;
+    std::vector<TASE2BilateralTableDef> tables;
+    uint64_t shape;
+};
+
+static inline ImportResult
+importModel (const std::string& config, bool stream)
+{
+    TASE2Config* tase2Config = new TASE2Config ();
+    Tase2_DataModel model = Tase2_DataModel_create ();
+
+    if (stream)
+    {
+        tase2Config->importModelStream (config, model);
+    }
+    else
+    {
+        tase2Config->importModelDocument (config, model);
+    }
+
+    ImportResult result;
+
+    const TASE2PointIndex& points = tase2Config->getPointIndex ();
+
+    for (uint32_t pointId = 0; pointId < points.size (); pointId++)
+    {
+        result.points.push_back (points.domain (pointId) + ":"
+                                 + points.point (pointId)->getLabel ());
+    }
+
+    result.controlPoints = tase2Config->getControlPoints ().size ();
+    result.bilateralTables = tase2Config->getBilateralTables ().size ();
+    result.tables = tase2Config->getBilateralTableDefs ();
+    result.shape = tase2Config->getModelShape ();
+
+    /* not owned by the model */
+    for (Tase2_BilateralTable blt : tase2Config->getBilateralTables ())
+    {
+        Tase2_BilateralTable_destroy (blt);
+    }
+
+    delete tase2Config;
+    Tase2_DataModel_destroy (model);
+
+    return result;
+}
+
+/*
+ * ICCs icc0, icc1, ... with the given number of points each, every 100th
+ * point a command, with a bilateral table per ICC listing all its points
+ * when tables is set.
+ */
+static inline std::string
+createTestModelConfig (const std::vector<int>& iccSizes, bool tables)
+{
+    std::string config
+        = "{\"model_conf\":{\"vcc\":{\"datapoints\":[]},\"icc\":[";
+    std::string bltConfig;
+
+    for (size_t icc = 0; icc < iccSizes.size (); icc++)
+    {
+        std::string name = "icc" + std::to_string (icc);
+        std::string points;
+        std::string blt;
+
+        for (int i = 0; i < iccSizes[icc]; i++)
+        {
+            std::string point = "point" + std::to_string (i);
+
+            if (i > 0)
+            {
+                points += ",";
+                blt += ",";
+            }
+
+            if (i % 100 == 0)
+            {
+                points += "{\"name\":\"" + point
+                          + "\",\"type\":\"Command\",\"mode\":\"sbo\","
+                            "\"hasTag\":false,\"checkBackId\":"
+                          + std::to_string (i) + "}";
+            }
+            else
+            {
+                points += "{\"name\":\"" + point
+                          + "\",\"type\":\"DiscreteQTime\","
+                            "\"hasCOV\":false,\"deadband\":1.0}";
+            }
+
+            blt += "{\"name\":\"" + point + "\"}";
+        }
+
+        if (icc > 0)
+        {
+            config += ",";
+        }
+
+        config += "{\"name\":\"" + name + "\",\"datapoints\":[" + points
+                  + "]}";
+
+        if (tables)
+        {
+            if (!bltConfig.empty ())
+            {
+                bltConfig += ",";
+            }
+
+            bltConfig += "{\"name\":\"BLT_" + name + "\",\"icc\":\"" + name
+                         + "\",\"apTitle\":\"1.1.1.998\",\"aeQualifier\":12,"
+                           "\"datapoints\":["
+                         + blt + "]}";
+        }
+    }
+
+    return config + "],\"bilateral_tables\":[" + bltConfig + "]}}";
+}
+
+#endif
@@ -0,0 +1,52 @@
+#include "tase2_backoff.hpp"
+#include <gtest/gtest.h>
+
+TEST (BackoffTest, DoublesUpToMaximum)
+{
+    TASE2Backoff backoff (1000, 8000);
+
+    uint64_t expected[] = { 1000, 2000, 4000, 8000, 8000, 8000 };
+
+    for (uint64_t interval : expected)
+    {
+        uint64_t delay = backoff.next ();
+
+        ASSERT_GE (delay, interval / 2);
+        ASSERT_LE (delay, interval);
+    }
+
+    backoff.reset ();
+
+    ASSERT_LE (backoff.next (), 1000);
+}
+
+TEST (BackoffTest, InvalidLimits)
+{
+    /* maximum below minimum, the minimum wins */
+    TASE2Backoff backoff (2000, 500);
+
+    for (int i = 0; i < 5; i++)
+    {
+        uint64_t delay = backoff.next ();
+
+        ASSERT_GE (delay, 1000);
+        ASSERT_LE (delay, 2000);
+    }
+
+    ASSERT_EQ (backoff.minInterval (), 2000);
+}
+
+TEST (BackoffTest, Jitter)
+{
+    TASE2Backoff backoff (10000, 10000);
+
+    uint64_t first = backoff.next ();
+    bool differs = false;
+
+    for (int i = 0; i < 20 && !differs; i++)
+    {
+        differs = backoff.next () != first;
+    }
+
+    ASSERT_TRUE (differs);
+}
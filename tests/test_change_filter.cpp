@@ -0,0 +1,129 @@
+#include "tase2_ingest_queue.hpp"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+/* what TASE2Server does: checked when decoded, committed when applied */
+static bool
+checkAndCommit (TASE2Datapoint& point, long intValue, double floatValue,
+                bool isFloat, Tase2_DataFlags flags)
+{
+    if (!point.checkChange (intValue, floatValue, isFloat, flags))
+    {
+        return false;
+    }
+
+    point.commitChange (intValue, floatValue, isFloat, flags);
+
+    return true;
+}
+
+TEST (ChangeFilterTest, NoFilterByDefault)
+{
+    TASE2Datapoint point ("datapointReal", REALQ);
+
+    ASSERT_FALSE (point.hasChangeFilter ());
+}
+
+TEST (ChangeFilterTest, SuppressIdentical)
+{
+    TASE2Datapoint point ("datapointState", STATEQ);
+    point.setChangeFilter (0.0, 0.0, true);
+
+    ASSERT_TRUE (point.hasChangeFilter ());
+
+    /* the first value is always applied */
+    ASSERT_TRUE (checkAndCommit (point, 1, 0.0, false, 0));
+    ASSERT_FALSE (checkAndCommit (point, 1, 0.0, false, 0));
+    ASSERT_TRUE (checkAndCommit (point, 2, 0.0, false, 0));
+
+    /* same value with other flags */
+    ASSERT_TRUE (checkAndCommit (point, 2, 0.0, false,
+                                 TASE2_DATA_FLAGS_VALIDITY_HELD));
+    ASSERT_FALSE (checkAndCommit (point, 2, 0.0, false,
+                                  TASE2_DATA_FLAGS_VALIDITY_HELD));
+}
+
+TEST (ChangeFilterTest, AbsoluteDeadband)
+{
+    TASE2Datapoint point ("datapointReal", REAL);
+    point.setChangeFilter (0.5, 0.0, false);
+
+    ASSERT_TRUE (checkAndCommit (point, 0, 10.0, true, 0));
+    ASSERT_FALSE (checkAndCommit (point, 0, 10.0, true, 0));
+    ASSERT_FALSE (checkAndCommit (point, 0, 10.4, true, 0));
+    ASSERT_FALSE (checkAndCommit (point, 0, 9.6, true, 0));
+
+    /* compared with the last applied value, slow drifts are reported */
+    ASSERT_TRUE (checkAndCommit (point, 0, 10.6, true, 0));
+    ASSERT_FALSE (checkAndCommit (point, 0, 10.2, true, 0));
+    ASSERT_TRUE (checkAndCommit (point, 0, 10.0, true, 0));
+}
+
+TEST (ChangeFilterTest, PercentDeadband)
+{
+    TASE2Datapoint point ("datapointDiscrete", DISCRETE);
+    point.setChangeFilter (0.0, 10.0, false);
+
+    ASSERT_TRUE (checkAndCommit (point, 100, 0.0, false, 0));
+    ASSERT_FALSE (checkAndCommit (point, 110, 0.0, false, 0));
+    ASSERT_FALSE (checkAndCommit (point, 91, 0.0, false, 0));
+    ASSERT_TRUE (checkAndCommit (point, 111, 0.0, false, 0));
+
+    /* the band follows the last applied value */
+    ASSERT_FALSE (checkAndCommit (point, 122, 0.0, false, 0));
+    ASSERT_TRUE (checkAndCommit (point, 123, 0.0, false, 0));
+}
+
+TEST (ChangeFilterTest, CheckDoesNotCommit)
+{
+    TASE2Datapoint point ("datapointReal", REAL);
+    point.setChangeFilter (0.5, 0.0, false);
+
+    ASSERT_TRUE (checkAndCommit (point, 0, 10.0, true, 0));
+
+    /* passes the filter, but is never applied */
+    ASSERT_TRUE (point.checkChange (0, 11.0, true, 0));
+
+    /* still compared with 10.0 */
+    ASSERT_FALSE (point.checkChange (0, 10.4, true, 0));
+    ASSERT_TRUE (point.checkChange (0, 10.6, true, 0));
+}
+
+TEST (ChangeFilterTest, DroppedUpdateIsNotTheReference)
+{
+    TASE2Datapoint point ("datapointReal", REAL);
+    TASE2Datapoint other ("datapointOther", DISCRETE);
+    point.setChangeFilter (0.5, 0.0, false);
+
+    TASE2IngestQueue queue (4, INGEST_OVERFLOW_DROP_OLDEST);
+
+    ASSERT_TRUE (checkAndCommit (point, 0, 10.0, true, 0));
+
+    /* 11.0 passes the filter and is queued, then evicted by the overflow */
+    ASSERT_TRUE (point.checkChange (0, 11.0, true, 0));
+
+    TASE2PointUpdate update = { &point, REAL, 0, 11.0, 0, 0 };
+    ASSERT_TRUE (queue.push (update));
+
+    for (long i = 0; i < 4; i++)
+    {
+        TASE2PointUpdate otherUpdate = { &other, DISCRETE, i, 0.0, 0, 0 };
+        ASSERT_TRUE (queue.push (otherUpdate));
+    }
+
+    vector<TASE2PointUpdate> batch;
+
+    ASSERT_EQ (queue.pop (batch, 100, 0), 4);
+    ASSERT_EQ (queue.getStats ().dropped, 1);
+
+    for (const TASE2PointUpdate& published : batch)
+    {
+        ASSERT_NE (published.point, &point);
+    }
+
+    /* within the deadband of the dropped 11.0, but not of the 10.0 the
+     * model still holds */
+    ASSERT_TRUE (checkAndCommit (point, 0, 11.2, true, 0));
+    ASSERT_FALSE (checkAndCommit (point, 0, 11.4, true, 0));
+}
@@ -0,0 +1,92 @@
+#include "tase2_coalescer.hpp"
+#include "tase2_point_index.hpp"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+static TASE2PointUpdate
+createUpdate (TASE2Datapoint* point, long value)
+{
+    TASE2PointUpdate update = { point, point->getType (), value, 0.0, 0, 0 };
+    return update;
+}
+
+class CoalescerTest : public testing::Test
+{
+  protected:
+    void
+    SetUp () override
+    {
+        for (int i = 0; i < 200; i++)
+        {
+            points.push_back (
+                index.insert ("icc1", "point" + to_string (i), DISCRETE));
+        }
+    }
+
+    TASE2PointIndex index;
+    vector<TASE2Datapoint*> points;
+};
+
+TEST_F (CoalescerTest, PointIdsAreDense)
+{
+    for (size_t i = 0; i < points.size (); i++)
+    {
+        ASSERT_EQ (points[i]->getPointId (), i);
+    }
+}
+
+TEST_F (CoalescerTest, KeepNewestPerPoint)
+{
+    TASE2UpdateCoalescer coalescer (index.size ());
+
+    vector<TASE2PointUpdate> updates;
+    updates.push_back (createUpdate (points[0], 1));
+    updates.push_back (createUpdate (points[130], 2));
+    updates.push_back (createUpdate (points[0], 3));
+    updates.push_back (createUpdate (points[5], 4));
+    updates.push_back (createUpdate (points[130], 5));
+    updates.push_back (createUpdate (points[0], 6));
+
+    coalescer.coalesce (updates);
+
+    ASSERT_EQ (updates.size (), 3);
+    ASSERT_EQ (updates[0].point, points[5]);
+    ASSERT_EQ (updates[0].intValue, 4);
+    ASSERT_EQ (updates[1].point, points[130]);
+    ASSERT_EQ (updates[1].intValue, 5);
+    ASSERT_EQ (updates[2].point, points[0]);
+    ASSERT_EQ (updates[2].intValue, 6);
+
+    ASSERT_EQ (coalescer.getCoalesced (), 3);
+
+    /* the bitmap is clean again for the next batch */
+    updates.clear ();
+    updates.push_back (createUpdate (points[0], 7));
+    updates.push_back (createUpdate (points[130], 8));
+
+    coalescer.coalesce (updates);
+
+    ASSERT_EQ (updates.size (), 2);
+    ASSERT_EQ (coalescer.getCoalesced (), 3);
+}
+
+TEST_F (CoalescerTest, ExemptPointsKeepAllUpdates)
+{
+    TASE2UpdateCoalescer coalescer (index.size ());
+
+    points[1]->setCoalesceExempt (true);
+
+    vector<TASE2PointUpdate> updates;
+    updates.push_back (createUpdate (points[1], 1));
+    updates.push_back (createUpdate (points[2], 2));
+    updates.push_back (createUpdate (points[1], 3));
+    updates.push_back (createUpdate (points[2], 4));
+
+    coalescer.coalesce (updates);
+
+    ASSERT_EQ (updates.size (), 3);
+    ASSERT_EQ (updates[0].intValue, 1);
+    ASSERT_EQ (updates[1].intValue, 3);
+    ASSERT_EQ (updates[2].intValue, 4);
+}
@@ -0,0 +1,274 @@
+#include "tase2.hpp"
+#include <gtest/gtest.h>
+#include <libtase2/tase2_client.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+using namespace std;
+
+#define TCP_TEST_PORT 10002
+#define BURST_COMMANDS 50
+
+static string
+createProtocolStack (const string& dispatch)
+{
+    return "{\"protocol_stack\":{\"name\":\"tase2north\",\"version\":\"1.0\","
+           "\"transport_layer\":{\"srv_ip\":\"0.0.0.0\",\"port\":10002,"
+           "\"passive\":true,\"localApTitle\":\"1.1.1.999:12\","
+           "\"remoteApTitle\":\"1.1.1.998:12\"},"
+           "\"application_layer\":{\"command_dispatch\":\""
+           + dispatch + "\"}}}";
+}
+
+static string
+createModelConfig ()
+{
+    string points = "{\"name\":\"datapoint1\",\"type\":\"Real\","
+                    "\"hasCOV\":false}";
+    string blt = "{\"name\":\"datapoint1\"}";
+
+    for (int i = 0; i < BURST_COMMANDS; i++)
+    {
+        string name = "command" + to_string (i);
+
+        points += ",{\"name\":\"" + name
+                  + "\",\"type\":\"Command\",\"mode\":\"direct\","
+                    "\"hasTag\":false,\"checkBackId\":"
+                  + to_string (100 + i) + "}";
+        blt += ",{\"name\":\"" + name + "\"}";
+    }
+
+    return "{\"model_conf\":{\"vcc\":{\"datapoints\":[]},"
+           "\"icc\":[{\"name\":\"icc1\",\"datapoints\":["
+           + points
+           + "]}],\"bilateral_tables\":[{\"name\":\"BLT_MZA_001_V1\","
+             "\"icc\":\"icc1\",\"apTitle\":\"1.1.1.998\",\"aeQualifier\":12,"
+             "\"datapoints\":["
+           + blt + "]}]}}";
+}
+
+static string
+createExchangedData ()
+{
+    string datapoints;
+
+    for (int i = 0; i < BURST_COMMANDS; i++)
+    {
+        string name = "command" + to_string (i);
+
+        if (i > 0)
+        {
+            datapoints += ",";
+        }
+
+        datapoints += "{\"pivot_id\":\"TC" + to_string (i) + "\",\"label\":\""
+                      + name + "\",\"protocols\":[{\"name\":\"tase2\","
+                      + "\"ref\":\"icc1:" + name + "\"}]}";
+    }
+
+    return "{\"exchanged_data\":{\"datapoints\":[" + datapoints + "]}}";
+}
+
+static atomic<int> dispatched (0);
+static atomic<bool> dispatchedInOrder (true);
+static atomic<int> lastCommand (-1);
+
+/* the south service accepts the commands once the gate is open */
+static mutex gateLock;
+static condition_variable gateCond;
+static bool gateOpen = true;
+
+static void
+setGate (bool open)
+{
+    {
+        lock_guard<mutex> lock (gateLock);
+        gateOpen = open;
+    }
+
+    gateCond.notify_all ();
+}
+
+static int
+gatedOperation (char* operation, int paramCount, char* names[],
+                char* parameters[], ControlDestination destination, ...)
+{
+    {
+        unique_lock<mutex> lock (gateLock);
+        gateCond.wait (lock, [] { return gateOpen; });
+    }
+
+    int command = atoi (parameters[CMD_NAME] + strlen ("command"));
+
+    if (command < lastCommand.exchange (command))
+    {
+        dispatchedInOrder = false;
+    }
+
+    dispatched++;
+
+    return 1;
+}
+
+class CommandDispatchTest : public testing::Test
+{
+  protected:
+    void
+    SetUp () override
+    {
+        dispatched = 0;
+        dispatchedInOrder = true;
+        lastCommand = -1;
+        setGate (true);
+    }
+
+    /* a failed assertion must not leave the dispatcher waiting */
+    void
+    TearDown () override
+    {
+        setGate (true);
+    }
+
+    static Tase2_Client
+    createClient ()
+    {
+        Tase2_Client client = Tase2_Client_create (nullptr);
+
+        Tase2_Client_setLocalApTitle (client, "1.1.1.998", 12);
+        Tase2_Client_setRemoteApTitle (client, "1.1.1.999", 12);
+        Tase2_Client_setTcpPort (client, TCP_TEST_PORT);
+
+        return client;
+    }
+
+    static TASE2Server*
+    createServer (const string& dispatch)
+    {
+        TASE2Server* tase2Server = new TASE2Server ();
+
+        tase2Server->setJsonConfig (createProtocolStack (dispatch),
+                                    createExchangedData (), "",
+                                    createModelConfig ());
+        tase2Server->registerControl (gatedOperation);
+        tase2Server->start ();
+
+        Thread_sleep (500);
+
+        return tase2Server;
+    }
+
+    static void
+    sendCommand (Tase2_Client client, int i)
+    {
+        Tase2_ClientError err;
+
+        Tase2_Client_sendCommand (client, &err, "icc1",
+                                  ("command" + to_string (i)).c_str (), 1);
+
+        ASSERT_EQ (err, TASE2_CLIENT_ERROR_OK);
+    }
+};
+
+TEST (CommandQueueTest, FifoAndClose)
+{
+    TASE2CommandQueue queue (2);
+
+    TASE2CommandRequest request = {};
+
+    request.ts = 1;
+    ASSERT_TRUE (queue.push (request));
+    request.ts = 2;
+    ASSERT_TRUE (queue.push (request));
+
+    /* full */
+    ASSERT_FALSE (queue.push (request));
+
+    queue.close ();
+
+    /* closed, the queued requests can still be taken */
+    ASSERT_FALSE (queue.push (request));
+
+    ASSERT_TRUE (queue.pop (request));
+    ASSERT_EQ (request.ts, 1);
+    ASSERT_TRUE (queue.pop (request));
+    ASSERT_EQ (request.ts, 2);
+    ASSERT_FALSE (queue.pop (request));
+}
+
+TEST_F (CommandDispatchTest, SyncHandlerRunsCallback)
+{
+    TASE2Server* tase2Server = createServer ("sync");
+
+    Tase2_Client commander = createClient ();
+
+    Tase2_ClientError err
+        = Tase2_Client_connect (commander, "127.0.0.1", "1.1.1.999", 12);
+    ASSERT_EQ (err, TASE2_CLIENT_ERROR_OK);
+
+    /* the handler returns once the callback accepted the command */
+    for (int i = 0; i < BURST_COMMANDS; i++)
+    {
+        sendCommand (commander, i);
+
+        ASSERT_EQ (dispatched, i + 1);
+    }
+
+    ASSERT_TRUE (dispatchedInOrder);
+
+    Tase2_Client_destroy (commander);
+
+    tase2Server->stop ();
+    delete tase2Server;
+}
+
+TEST_F (CommandDispatchTest, AsyncHandlerReturnsBeforeCallback)
+{
+    TASE2Server* tase2Server = createServer ("async");
+
+    Tase2_Client reader = createClient ();
+    Tase2_Client commander = createClient ();
+
+    Tase2_ClientError err
+        = Tase2_Client_connect (reader, "127.0.0.1", "1.1.1.999", 12);
+    ASSERT_EQ (err, TASE2_CLIENT_ERROR_OK);
+
+    err = Tase2_Client_connect (commander, "127.0.0.1", "1.1.1.999", 12);
+    ASSERT_EQ (err, TASE2_CLIENT_ERROR_OK);
+
+    /* the south service does not accept anything yet, with a handler
+     * waiting for the callback the first command would not return */
+    setGate (false);
+
+    for (int i = 0; i < BURST_COMMANDS; i++)
+    {
+        sendCommand (commander, i);
+    }
+
+    ASSERT_EQ (dispatched, 0);
+
+    /* neither do the reads wait for the callback */
+    Tase2_PointValue value
+        = Tase2_Client_readPointValue (reader, &err, "icc1", "datapoint1");
+
+    ASSERT_EQ (err, TASE2_CLIENT_ERROR_OK);
+
+    if (value)
+    {
+        Tase2_PointValue_destroy (value);
+    }
+
+    Tase2_Client_destroy (commander);
+    Tase2_Client_destroy (reader);
+
+    setGate (true);
+
+    /* stop hands the queued commands over before returning */
+    tase2Server->stop ();
+
+    ASSERT_EQ (dispatched, BURST_COMMANDS);
+    ASSERT_TRUE (dispatchedInOrder);
+
+    delete tase2Server;
+}
@@ -0,0 +1,74 @@
+#include "tase2_command_params.hpp"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+TEST (CommandParamsTest, OperateCommand)
+{
+    TASE2CommandParams params ("icc1", "command1",
+                               TASE2_CONTROL_TYPE_COMMAND);
+
+    char* parameters[CMD_PARAMETER_COUNT];
+    char valueBuffer[TASE2_COMMAND_VALUE_SIZE];
+    char tsBuffer[TASE2_COMMAND_TS_SIZE];
+
+    Tase2_OperateValue value;
+    value.commandValue = 1;
+
+    params.build (parameters, &value, false, 1700000000123ULL, valueBuffer,
+                  tsBuffer);
+
+    ASSERT_STREQ (parameters[CMD_TYPE], "Command");
+    ASSERT_STREQ (parameters[CMD_SCOPE], "domain");
+    ASSERT_STREQ (parameters[CMD_DOMAIN], "icc1");
+    ASSERT_STREQ (parameters[CMD_NAME], "command1");
+    ASSERT_STREQ (parameters[CMD_VALUE], "1");
+    ASSERT_STREQ (parameters[CMD_SELECT], "0");
+    ASSERT_STREQ (parameters[CMD_TS], "1700000000123");
+
+    ASSERT_STREQ (TASE2CommandParams::Names ()[CMD_VALUE], "co_value");
+}
+
+TEST (CommandParamsTest, SetPoints)
+{
+    TASE2CommandParams real ("vcc", "setpoint1",
+                             TASE2_CONTROL_TYPE_SETPOINT_REAL);
+    TASE2CommandParams discrete ("vcc", "setpoint2",
+                                 TASE2_CONTROL_TYPE_SETPOINT_DESCRETE);
+
+    char* parameters[CMD_PARAMETER_COUNT];
+    char valueBuffer[TASE2_COMMAND_VALUE_SIZE];
+    char tsBuffer[TASE2_COMMAND_TS_SIZE];
+
+    Tase2_OperateValue value;
+
+    /* same formatting as std::to_string */
+    value.realValue = 1.5f;
+    real.build (parameters, &value, false, 0, valueBuffer, tsBuffer);
+
+    ASSERT_STREQ (parameters[CMD_TYPE], "SetPointReal");
+    ASSERT_STREQ (parameters[CMD_SCOPE], "vcc");
+    ASSERT_EQ (string (parameters[CMD_VALUE]), to_string (1.5f));
+
+    value.discreteValue = -12;
+    discrete.build (parameters, &value, false, 0, valueBuffer, tsBuffer);
+
+    ASSERT_STREQ (parameters[CMD_TYPE], "SetPointDiscrete");
+    ASSERT_STREQ (parameters[CMD_VALUE], "-12");
+}
+
+TEST (CommandParamsTest, SelectHasNoValue)
+{
+    TASE2CommandParams params ("icc1", "command1",
+                               TASE2_CONTROL_TYPE_COMMAND);
+
+    char* parameters[CMD_PARAMETER_COUNT];
+    char valueBuffer[TASE2_COMMAND_VALUE_SIZE];
+    char tsBuffer[TASE2_COMMAND_TS_SIZE];
+
+    params.build (parameters, nullptr, true, 42, valueBuffer, tsBuffer);
+
+    ASSERT_STREQ (parameters[CMD_VALUE], "");
+    ASSERT_STREQ (parameters[CMD_SELECT], "1");
+    ASSERT_STREQ (parameters[CMD_TS], "42");
+}
@@ -544,6 +544,23 @@ class ControlTest : public testing::Test
 
         return dp;
     }
+
+    /* the ACT-CON of a command, as forwarded by the south side */
+    void
+    sendActCon (const char* label, const char* name)
+    {
+        auto* dataobjects = new vector<Datapoint*>;
+        dataobjects->push_back (
+            createDataObject ("Command", "icc1", name, 1, "valid",
+                              "telemetered", "normal", (uint64_t)123456,
+                              "valid"));
+        auto* reading = new Reading (std::string (label), *dataobjects);
+        vector<Reading*> readings;
+        readings.push_back (reading);
+        plugin_send (handle, readings);
+        delete dataobjects;
+        delete reading;
+    }
 };
 
 TEST_F (ControlTest, SimpleCommand)
@@ -608,6 +625,43 @@ TEST_F (ControlTest, SimpleCommandSBO)
     Tase2_Client_destroy (client);
 }
 
+TEST_F (ControlTest, SelectConfirmationIsNotRecorded)
+{
+    ConfigCategory config;
+    Tase2_Client client;
+
+    setupTest (config, handle, client);
+
+    Tase2_ClientError err
+        = Tase2_Client_connect (client, "127.0.0.1", "1.1.1.999", 12);
+    ASSERT_TRUE (err == TASE2_CLIENT_ERROR_OK);
+
+    const TASE2CommandLatency& latency
+        = ((TASE2Server*)handle)
+              ->getCommandLatency (TASE2_CONTROL_TYPE_COMMAND);
+
+    int checkbackId
+        = Tase2_Client_selectDevice (client, &err, "icc1", "command2");
+
+    ASSERT_EQ (126, checkbackId);
+
+    sendActCon ("TC4", "command2");
+
+    /* the select is confirmed but it is not an operate confirmation */
+    ASSERT_EQ (latency.confirm.count (), 0);
+
+    Tase2_Client_sendCommand (client, &err, "icc1", "command2", 1);
+
+    ASSERT_EQ (err, TASE2_CLIENT_ERROR_OK);
+
+    sendActCon ("TC4", "command2");
+
+    ASSERT_EQ (latency.confirm.count (), 1);
+    ASSERT_EQ (((TASE2Server*)handle)->m_outstandingCommands.size (), 0);
+
+    Tase2_Client_destroy (client);
+}
+
 TEST_F (ControlTest, SimpleCommandSBONoSelect)
 {
     ConfigCategory config;
@@ -0,0 +1,159 @@
+#include "tase2_ingest_queue.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace std;
+
+static TASE2PointUpdate
+createUpdate (TASE2Datapoint* point, long value)
+{
+    TASE2PointUpdate update = { point, point->getType (), value, 0.0, 0, 0 };
+    return update;
+}
+
+TEST (IngestQueueTest, PolicyFromString)
+{
+    ASSERT_EQ (TASE2IngestQueue::getPolicyFromString ("block"),
+               INGEST_OVERFLOW_BLOCK);
+    ASSERT_EQ (TASE2IngestQueue::getPolicyFromString ("drop_oldest"),
+               INGEST_OVERFLOW_DROP_OLDEST);
+    ASSERT_EQ (TASE2IngestQueue::getPolicyFromString ("coalesce"),
+               INGEST_OVERFLOW_COALESCE);
+    ASSERT_EQ (TASE2IngestQueue::getPolicyFromString ("drop"),
+               INGEST_OVERFLOW_UNKNOWN);
+}
+
+TEST (IngestQueueTest, PushPopInOrder)
+{
+    TASE2Datapoint point ("datapoint1", DISCRETE);
+    TASE2IngestQueue queue (5, INGEST_OVERFLOW_BLOCK);
+
+    /* rounded up to a power of two */
+    ASSERT_EQ (queue.capacity (), 8);
+
+    for (long i = 0; i < 6; i++)
+    {
+        ASSERT_TRUE (queue.push (createUpdate (&point, i)));
+    }
+
+    ASSERT_EQ (queue.size (), 6);
+
+    vector<TASE2PointUpdate> batch;
+
+    ASSERT_EQ (queue.pop (batch, 4, 0), 4);
+    ASSERT_EQ (queue.pop (batch, 4, 0), 2);
+    ASSERT_EQ (queue.pop (batch, 4, 0), 0);
+
+    for (long i = 0; i < 6; i++)
+    {
+        ASSERT_EQ (batch[i].intValue, i);
+    }
+
+    TASE2IngestStats stats = queue.getStats ();
+
+    ASSERT_EQ (stats.capacity, 8);
+    ASSERT_EQ (stats.occupancy, 0);
+    ASSERT_EQ (stats.highWatermark, 6);
+    ASSERT_EQ (stats.pushed, 6);
+    ASSERT_EQ (stats.published, 6);
+    ASSERT_EQ (stats.dropped, 0);
+
+    queue.close ();
+
+    ASSERT_FALSE (queue.push (createUpdate (&point, 7)));
+}
+
+TEST (IngestQueueTest, DropOldest)
+{
+    TASE2Datapoint point ("datapoint1", DISCRETE);
+    TASE2IngestQueue queue (4, INGEST_OVERFLOW_DROP_OLDEST);
+
+    for (long i = 0; i < 10; i++)
+    {
+        ASSERT_TRUE (queue.push (createUpdate (&point, i)));
+    }
+
+    vector<TASE2PointUpdate> batch;
+
+    ASSERT_EQ (queue.pop (batch, 100, 0), 4);
+
+    for (long i = 0; i < 4; i++)
+    {
+        ASSERT_EQ (batch[i].intValue, 6 + i);
+    }
+
+    ASSERT_EQ (queue.getStats ().dropped, 6);
+}
+
+TEST (IngestQueueTest, CoalesceOverflow)
+{
+    TASE2Datapoint point1 ("datapoint1", DISCRETE);
+    TASE2Datapoint point2 ("datapoint2", DISCRETE);
+    TASE2IngestQueue queue (2, INGEST_OVERFLOW_COALESCE);
+
+    queue.push (createUpdate (&point1, 1));
+    queue.push (createUpdate (&point2, 2));
+
+    /* ring full, the rest is kept per point */
+    queue.push (createUpdate (&point1, 3));
+    queue.push (createUpdate (&point2, 4));
+    queue.push (createUpdate (&point1, 5));
+
+    vector<TASE2PointUpdate> batch;
+
+    /* the ring goes first, then the parked updates in arrival order */
+    ASSERT_EQ (queue.pop (batch, 100, 0), 4);
+
+    ASSERT_EQ (batch[0].intValue, 1);
+    ASSERT_EQ (batch[1].intValue, 2);
+    ASSERT_EQ (batch[2].point, &point1);
+    ASSERT_EQ (batch[2].intValue, 5);
+    ASSERT_EQ (batch[3].point, &point2);
+    ASSERT_EQ (batch[3].intValue, 4);
+
+    ASSERT_EQ (queue.getStats ().coalesced, 1);
+
+    /* back to the ring once the overflow has been taken */
+    queue.push (createUpdate (&point1, 6));
+    ASSERT_EQ (queue.size (), 1);
+}
+
+TEST (IngestQueueTest, BlockUntilPublished)
+{
+    TASE2Datapoint point ("datapoint1", DISCRETE);
+    TASE2IngestQueue queue (16, INGEST_OVERFLOW_BLOCK);
+
+    const long count = 100000;
+    vector<TASE2PointUpdate> received;
+
+    thread publisher ([&] () {
+        vector<TASE2PointUpdate> batch;
+
+        while ((long)received.size () < count)
+        {
+            batch.clear ();
+            queue.pop (batch, 8, 100);
+            received.insert (received.end (), batch.begin (), batch.end ());
+        }
+    });
+
+    for (long i = 0; i < count; i++)
+    {
+        ASSERT_TRUE (queue.push (createUpdate (&point, i)));
+    }
+
+    publisher.join ();
+
+    ASSERT_EQ (received.size (), count);
+
+    for (long i = 0; i < count; i++)
+    {
+        ASSERT_EQ (received[i].intValue, i);
+    }
+
+    TASE2IngestStats stats = queue.getStats ();
+
+    ASSERT_LE (stats.highWatermark, 16);
+    ASSERT_EQ (stats.dropped, 0);
+    ASSERT_EQ (stats.published, count);
+}
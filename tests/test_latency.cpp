@@ -0,0 +1,119 @@
+#include "tase2_datapoint.hpp"
+#include "tase2_latency.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST (LatencyHistogramTest, BucketBounds)
+{
+    /* small values are exact */
+    for (uint64_t v = 0; v < 16; v++)
+    {
+        ASSERT_EQ (TASE2LatencyHistogram::bucketIndex (v), v);
+        ASSERT_EQ (TASE2LatencyHistogram::bucketUpperBound (v), v);
+    }
+
+    /* every value lies within the bounds of its bucket, which are at
+     * most 1/16 apart */
+    for (uint64_t v = 16; v < (1ULL << 36); v = v * 3 / 2 + 7)
+    {
+        size_t index = TASE2LatencyHistogram::bucketIndex (v);
+
+        ASSERT_LT (index, TASE2LatencyHistogram::BUCKETS);
+
+        uint64_t upper = TASE2LatencyHistogram::bucketUpperBound (index);
+        uint64_t lower = TASE2LatencyHistogram::bucketUpperBound (index - 1);
+
+        ASSERT_LE (v, upper);
+        ASSERT_GT (v, lower);
+        ASSERT_LE (upper - lower, v / 16 + 1);
+    }
+
+    ASSERT_EQ (TASE2LatencyHistogram::bucketIndex (1ULL << 40),
+               TASE2LatencyHistogram::BUCKETS - 1);
+}
+
+TEST (LatencyHistogramTest, Percentiles)
+{
+    TASE2LatencyHistogram histogram;
+
+    ASSERT_EQ (histogram.percentile (50), 0);
+
+    for (uint64_t v = 1; v <= 1000; v++)
+    {
+        histogram.record (v);
+    }
+
+    ASSERT_EQ (histogram.count (), 1000);
+    ASSERT_EQ (histogram.max (), 1000);
+    ASSERT_DOUBLE_EQ (histogram.mean (), 500.5);
+
+    uint64_t p50 = histogram.percentile (50);
+    uint64_t p99 = histogram.percentile (99);
+
+    ASSERT_GE (p50, 500);
+    ASSERT_LE (p50, 500 + 500 / 16);
+    ASSERT_GE (p99, 990);
+    ASSERT_LE (p99, 1000);
+    ASSERT_EQ (histogram.percentile (100), 1000);
+}
+
+TEST (LatencyHistogramTest, ConcurrentRecord)
+{
+    TASE2LatencyHistogram histogram;
+
+    vector<thread> threads;
+
+    for (int t = 0; t < 4; t++)
+    {
+        threads.push_back (thread ([&histogram, t] {
+            for (uint64_t v = 0; v < 100000; v++)
+            {
+                histogram.record (v % 5000 + t);
+            }
+        }));
+    }
+
+    for (auto& t : threads)
+    {
+        t.join ();
+    }
+
+    ASSERT_EQ (histogram.count (), 400000);
+    ASSERT_EQ (histogram.max (), 4999 + 3);
+}
+
+TEST (LatencyHistogramTest, PointLatencyCreatedOnFirstCommand)
+{
+    TASE2Datapoint point ("command1", COMMAND);
+
+    point.createCommandParams ("icc1");
+
+    ASSERT_EQ (point.getCommandLatency (), nullptr);
+
+    vector<thread> threads;
+    vector<TASE2CommandLatency*> created (4);
+
+    for (int t = 0; t < 4; t++)
+    {
+        threads.push_back (thread ([&point, &created, t] {
+            created[t] = point.createCommandLatency ();
+            created[t]->throttled++;
+        }));
+    }
+
+    for (auto& t : threads)
+    {
+        t.join ();
+    }
+
+    /* every thread got the same histograms */
+    for (TASE2CommandLatency* latency : created)
+    {
+        ASSERT_EQ (latency, point.getCommandLatency ());
+    }
+
+    ASSERT_EQ (point.getCommandLatency ()->throttled, 4);
+}
@@ -0,0 +1,256 @@
+#include "tase2.hpp"
+#include <gtest/gtest.h>
+#include <reading.h>
+
+using namespace std;
+
+#define LIFECYCLE_POINTS 1000
+#define DRAIN_ROUNDS 200
+
+static string protocol_stack = QUOTE ({
+    "protocol_stack" : {
+        "name" : "tase2north",
+        "version" : "1.0",
+        "transport_layer" : {
+            "srv_ip" : "0.0.0.0",
+            "port" : 10002,
+            "passive" : true,
+            "localApTitle" : "1.1.1.999:12",
+            "remoteApTitle" : "1.1.1.998:12"
+        }
+    }
+});
+
+static string protocol_stack_async = QUOTE ({
+    "protocol_stack" : {
+        "name" : "tase2north",
+        "version" : "1.0",
+        "transport_layer" : {
+            "srv_ip" : "0.0.0.0",
+            "port" : 10002,
+            "passive" : true,
+            "localApTitle" : "1.1.1.999:12",
+            "remoteApTitle" : "1.1.1.998:12"
+        },
+        "ingest" : { "mode" : "async", "queue_size" : 1024 }
+    }
+});
+
+/* the first connection attempt fails, the next one is an hour away */
+static string protocol_stack_active = QUOTE ({
+    "protocol_stack" : {
+        "name" : "tase2north",
+        "version" : "1.0",
+        "transport_layer" : {
+            "srv_ip" : "0.0.0.0",
+            "port" : 10002,
+            "passive" : false,
+            "localApTitle" : "1.1.1.999:12",
+            "remoteApTitle" : "1.1.1.998:12",
+            "remote_ip" : "127.0.0.1",
+            "reconnect_min_interval" : 3600000,
+            "reconnect_max_interval" : 3600000
+        }
+    }
+});
+
+static string exchanged_data = QUOTE ({
+    "exchanged_data" : {
+        "datapoints" : [ {
+            "pivot_id" : "TM1",
+            "label" : "TM1",
+            "protocols" : [ { "name" : "tase2", "ref" : "ICC1:point0" } ]
+        } ]
+    }
+});
+
+static string
+createModelConfig (int pointCount)
+{
+    string config = "{\"model_conf\":{\"vcc\":{\"datapoints\":[]},"
+                    "\"icc\":[{\"name\":\"ICC1\",\"datapoints\":[";
+
+    for (int i = 0; i < pointCount; i++)
+    {
+        if (i > 0)
+        {
+            config += ",";
+        }
+
+        config += "{\"name\":\"point" + to_string (i)
+                  + "\",\"type\":\"DiscreteQTime\",\"hasCOV\":false,"
+                    "\"suppress_identical\":true}";
+    }
+
+    config += "]}],\"bilateral_tables\":[]}}";
+
+    return config;
+}
+
+template <class T>
+static Datapoint*
+createDatapoint (const std::string& dataname, const T value)
+{
+    DatapointValue dp_value = DatapointValue (value);
+    return new Datapoint (dataname, dp_value);
+}
+
+/* an update of ICC1:point0 */
+static Reading*
+createReading (long value)
+{
+    auto* attributes = new vector<Datapoint*>;
+
+    attributes->push_back (createDatapoint ("do_type", "DiscreteQTime"));
+    attributes->push_back (createDatapoint ("do_domain", "ICC1"));
+    attributes->push_back (createDatapoint ("do_name", "point0"));
+    attributes->push_back (createDatapoint ("do_value", value));
+    attributes->push_back (createDatapoint ("do_validity", "valid"));
+    attributes->push_back (createDatapoint ("do_cs", "telemetered"));
+    attributes->push_back (createDatapoint ("do_ts", (long)123456));
+
+    DatapointValue dpv (attributes, true);
+
+    vector<Datapoint*> dataObjects;
+    dataObjects.push_back (new Datapoint ("data_object", dpv));
+
+    return new Reading ("TM1", dataObjects);
+}
+
+static uint32_t
+sendValue (TASE2Server* tase2Server, long value)
+{
+    Reading* reading = createReading (value);
+    vector<Reading*> readings = { reading };
+
+    uint32_t sent = tase2Server->send (readings);
+
+    delete reading;
+
+    return sent;
+}
+
+/* true when the value is the last one applied to ICC1:point0 */
+static bool
+isCommitted (TASE2Server* tase2Server, long value)
+{
+    TASE2Datapoint* point
+        = tase2Server->getConfig ()->findDatapoint ("ICC1", "point0");
+
+    Tase2_DataFlags flags = TASE2_DATA_FLAGS_VALIDITY_VALID
+                            | TASE2_DATA_FLAGS_CURRENT_SOURCE_TELEMETERED;
+
+    return !point->checkChange (value, 0.0, false, flags);
+}
+
+TEST (LifecycleTest, StartStopCycles)
+{
+    string model_config = createModelConfig (LIFECYCLE_POINTS);
+
+    for (int cycle = 0; cycle < 3; cycle++)
+    {
+        TASE2Server* tase2Server = new TASE2Server ();
+
+        tase2Server->setJsonConfig (protocol_stack, exchanged_data, "",
+                                    model_config);
+
+        tase2Server->start ();
+        tase2Server->stop ();
+
+        delete tase2Server;
+    }
+}
+
+TEST (LifecycleTest, StopDoesNotWaitForReconnect)
+{
+    TASE2Server* tase2Server = new TASE2Server ();
+
+    tase2Server->setJsonConfig (protocol_stack_active, exchanged_data, "",
+                                createModelConfig (10));
+
+    tase2Server->start ();
+
+    /* the connection thread waits on a condition variable, stop wakes it
+     * up instead of waiting for the reconnect interval to pass */
+    tase2Server->stop ();
+
+    ASSERT_EQ (sendValue (tase2Server, 1), 0);
+
+    delete tase2Server;
+}
+
+TEST (LifecycleTest, StopIsIdempotent)
+{
+    TASE2Server* tase2Server = new TASE2Server ();
+
+    tase2Server->setJsonConfig (protocol_stack, exchanged_data, "",
+                                createModelConfig (10));
+
+    tase2Server->start ();
+
+    ASSERT_EQ (sendValue (tase2Server, 1), 1);
+
+    tase2Server->stop ();
+    tase2Server->stop ();
+
+    /* nothing is published once the server is stopped */
+    ASSERT_EQ (sendValue (tase2Server, 2), 0);
+
+    delete tase2Server;
+}
+
+TEST (LifecycleTest, StopWithoutStart)
+{
+    TASE2Server* tase2Server = new TASE2Server ();
+
+    tase2Server->setJsonConfig (protocol_stack, exchanged_data, "",
+                                createModelConfig (10));
+
+    delete tase2Server;
+}
+
+TEST (LifecycleTest, StopPublishesQueuedUpdates)
+{
+    TASE2Server* tase2Server = new TASE2Server ();
+
+    tase2Server->setJsonConfig (protocol_stack_async, exchanged_data, "",
+                                createModelConfig (10));
+
+    tase2Server->start ();
+
+    /* updates are only queued once the endpoint is up */
+    TASE2IngestStats stats;
+
+    for (int i = 0; i < 100; i++)
+    {
+        sendValue (tase2Server, 0);
+
+        ASSERT_TRUE (tase2Server->getIngestStats (stats));
+
+        if (stats.pushed > 0)
+        {
+            break;
+        }
+
+        Thread_sleep (10);
+    }
+
+    ASSERT_GT (stats.pushed, 0);
+
+    for (long value = 1; value <= DRAIN_ROUNDS; value++)
+    {
+        ASSERT_EQ (sendValue (tase2Server, value), 1);
+    }
+
+    tase2Server->stop ();
+
+    /* everything queued before the stop reached the model, in order */
+    ASSERT_TRUE (tase2Server->getIngestStats (stats));
+    ASSERT_EQ (stats.dropped, 0);
+    ASSERT_EQ (stats.published, stats.pushed);
+    ASSERT_TRUE (isCommitted (tase2Server, DRAIN_ROUNDS));
+
+    ASSERT_EQ (sendValue (tase2Server, DRAIN_ROUNDS + 1), 0);
+
+    delete tase2Server;
+}
@@ -0,0 +1,185 @@
+#include "tase2.hpp"
+#include "tase2_model_reader.hpp"
+#include "tase2_test_model.hpp"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+#define IMPORT_ICCS 40
+#define IMPORT_POINTS_PER_ICC 3750
+
+/* ICC names after the datapoints and tables before the ICCs, the
+ * streaming import has to keep them until they can be imported */
+static string model_config = QUOTE ({
+    "model_conf" : {
+        "command_rate_limit" : { "point" : { "rate" : 5 } },
+        "bilateral_tables" : [ {
+            "name" : "BLT_MZA_001_V1",
+            "icc" : "icc1",
+            "apTitle" : "1.1.1.998",
+            "aeQualifier" : 12,
+            "datapoints" : [
+                { "name" : "datapoint1" }, { "name" : "command1" },
+                { "name" : "unknown" }
+            ]
+        } ],
+        "vcc" : {
+            "datapoints" : [
+                { "name" : "vccpoint1", "type" : "Real", "hasCOV" : false },
+                {
+                    "name" : "vcccommand1",
+                    "type" : "Command",
+                    "mode" : "direct",
+                    "hasTag" : false,
+                    "checkBackId" : 1
+                }
+            ]
+        },
+        "icc" : [
+            {
+                "datapoints" : [
+                    {
+                        "name" : "datapoint1",
+                        "type" : "StateQTime",
+                        "hasCOV" : false,
+                        "deadband" : 1.0
+                    },
+                    {
+                        "name" : "command1",
+                        "type" : "Command",
+                        "mode" : "sbo",
+                        "hasTag" : true,
+                        "checkBackId" : 2,
+                        "rate_limit" : { "rate" : 1 }
+                    },
+                    { "name" : "invalid", "type" : "Unknown" }
+                ],
+                "name" : "icc1"
+            },
+            {
+                "name" : "icc2",
+                "datapoints" : [ {
+                    "name" : "datapoint2",
+                    "type" : "Discrete",
+                    "hasCOV" : true
+                } ]
+            }
+        ],
+        "dataset_transfer_sets" : [ { "name" : "DSTS1", "domain" : "icc1" } ],
+        "datasets" : [ {
+            "name" : "ds1",
+            "domain" : "icc1",
+            "datapoints" : [ "datapoint1", "unknown" ]
+        } ]
+    }
+});
+
+TEST (ModelImportTest, StreamBuildsSameModel)
+{
+    ImportResult dom = importModel (model_config, false);
+    ImportResult stream = importModel (model_config, true);
+
+    ASSERT_EQ (dom.points.size (), 5);
+    ASSERT_EQ (dom.controlPoints, 2);
+    ASSERT_EQ (dom.bilateralTables, 1);
+
+    ASSERT_EQ (stream.points, dom.points);
+    ASSERT_EQ (stream.controlPoints, dom.controlPoints);
+    ASSERT_EQ (stream.bilateralTables, dom.bilateralTables);
+}
+
+TEST (ModelImportTest, StreamStopsOnInvalidDatapoint)
+{
+    string config = QUOTE ({
+        "model_conf" : {
+            "vcc" : { "datapoints" : [] },
+            "icc" : [ {
+                "name" : "icc1",
+                "datapoints" : [
+                    {
+                        "name" : "datapoint1",
+                        "type" : "Real",
+                        "hasCOV" : false
+                    },
+                    "datapoint2",
+                    {
+                        "name" : "datapoint3",
+                        "type" : "Real",
+                        "hasCOV" : false
+                    }
+                ]
+            } ],
+            "bilateral_tables" : []
+        }
+    });
+
+    ImportResult dom = importModel (config, false);
+    ImportResult stream = importModel (config, true);
+
+    ASSERT_EQ (dom.points.size (), 1);
+    ASSERT_EQ (stream.points, dom.points);
+
+    /* truncated */
+    ASSERT_EQ (importModel ("{\"model_conf\":", true).points.size (), 0);
+}
+
+TEST (ModelImportTest, LargeModelStreamsLikeDocument)
+{
+    string config = createTestModelConfig (
+        vector<int> (IMPORT_ICCS, IMPORT_POINTS_PER_ICC), true);
+
+    /* importModelConfig takes the streaming import for this one */
+    ASSERT_GE (config.size (), (size_t)TASE2_MODEL_STREAM_THRESHOLD);
+
+    ImportResult stream = importModel (config, true);
+    ImportResult dom = importModel (config, false);
+
+    ASSERT_EQ (dom.points.size (),
+               (size_t)IMPORT_ICCS * IMPORT_POINTS_PER_ICC);
+    ASSERT_EQ (stream.points, dom.points);
+    ASSERT_EQ (stream.controlPoints, dom.controlPoints);
+    ASSERT_EQ (stream.bilateralTables, (size_t)IMPORT_ICCS);
+}
+
+TEST (ModelImportTest, DuplicateDatapointIsSkipped)
+{
+    string config = QUOTE ({
+        "model_conf" : {
+            "vcc" : { "datapoints" : [] },
+            "icc" : [ {
+                "name" : "icc1",
+                "datapoints" : [
+                    {
+                        "name" : "datapoint1",
+                        "type" : "State",
+                        "hasCOV" : false
+                    },
+                    {
+                        "name" : "datapoint1",
+                        "type" : "Command",
+                        "mode" : "sbo",
+                        "hasTag" : false,
+                        "checkBackId" : 1
+                    },
+                    {
+                        "name" : "datapoint2",
+                        "type" : "Real",
+                        "hasCOV" : false
+                    }
+                ]
+            } ],
+            "bilateral_tables" : []
+        }
+    });
+
+    vector<string> expected = { "icc1:datapoint1", "icc1:datapoint2" };
+
+    for (bool stream : { false, true })
+    {
+        ImportResult result = importModel (config, stream);
+
+        /* the first definition is kept, the import goes on */
+        ASSERT_EQ (result.points, expected);
+        ASSERT_EQ (result.controlPoints, 0);
+    }
+}
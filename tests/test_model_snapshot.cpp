@@ -0,0 +1,323 @@
+#include "tase2.hpp"
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+using namespace std;
+
+#define SNAPSHOT_POINTS 100000
+
+static string protocol_stack = QUOTE ({
+    "protocol_stack" : {
+        "name" : "tase2north",
+        "version" : "1.0",
+        "transport_layer" : {
+            "srv_ip" : "0.0.0.0",
+            "port" : 10002,
+            "passive" : true,
+            "localApTitle" : "1.1.1.999:12",
+            "remoteApTitle" : "1.1.1.998:12"
+        }
+    }
+});
+
+static string model_config = QUOTE ({
+    "model_conf" : {
+        "command_rate_limit" : {
+            "global" : { "rate" : 20, "burst" : 40 },
+            "point" : { "rate" : 5 }
+        },
+        "vcc" : {
+            "datapoints" : [ {
+                "name" : "vccpoint1",
+                "type" : "Real",
+                "hasCOV" : false
+            } ]
+        },
+        "icc" : [ {
+            "name" : "icc1",
+            "datapoints" : [
+                {
+                    "name" : "datapoint1",
+                    "type" : "StateQTime",
+                    "hasCOV" : false,
+                    "deadband" : 1.0
+                },
+                {
+                    "name" : "datapoint2",
+                    "type" : "DiscreteQ",
+                    "hasCOV" : false,
+                    "soe" : true,
+                    "suppress_identical" : true
+                },
+                {
+                    "name" : "command1",
+                    "type" : "Command",
+                    "mode" : "sbo",
+                    "hasTag" : true,
+                    "checkBackId" : 2,
+                    "rate_limit" : { "rate" : 1 }
+                }
+            ]
+        } ],
+        "bilateral_tables" : [ {
+            "name" : "BLT_MZA_001_V1",
+            "icc" : "icc1",
+            "apTitle" : "1.1.1.998",
+            "aeQualifier" : 12,
+            "datapoints" :
+                [ { "name" : "datapoint1" }, { "name" : "command1" } ]
+        } ],
+        "dataset_transfer_sets" : [ { "name" : "DSTS1", "domain" : "icc1" } ],
+        "datasets" : [ {
+            "name" : "ds1",
+            "domain" : "icc1",
+            "datapoints" : [ "datapoint1", "datapoint2" ]
+        } ]
+    }
+});
+
+static string exchanged_data = QUOTE ({
+    "exchanged_data" : {
+        "datapoints" : [
+            {
+                "pivot_id" : "TS1",
+                "label" : "label1",
+                "protocols" :
+                    [ { "name" : "tase2", "ref" : "icc1:datapoint1" } ]
+            },
+            {
+                "label" : "label2",
+                "protocols" : [ { "name" : "tase2", "ref" : "icc1:command1" } ]
+            }
+        ]
+    }
+});
+
+static string
+createLargeModelConfig (int pointCount)
+{
+    string config = "{\"model_conf\":{\"vcc\":{\"datapoints\":[]},"
+                    "\"icc\":[{\"name\":\"ICC1\",\"datapoints\":[";
+
+    for (int i = 0; i < pointCount; i++)
+    {
+        if (i > 0)
+        {
+            config += ",";
+        }
+
+        config += "{\"name\":\"point" + to_string (i)
+                  + "\",\"type\":\"DiscreteQTime\",\"hasCOV\":false}";
+    }
+
+    config += "]}],\"bilateral_tables\":[]}}";
+
+    return config;
+}
+
+class ModelSnapshotTest : public testing::Test
+{
+  protected:
+    void
+    SetUp () override
+    {
+        char path[] = "/tmp/tase2_snapshot_XXXXXX";
+        int fd = mkstemp (path);
+
+        ASSERT_GE (fd, 0);
+        close (fd);
+
+        snapshotPath = path;
+    }
+
+    void
+    TearDown () override
+    {
+        unlink (snapshotPath.c_str ());
+    }
+
+    static void
+    destroyModel (TASE2Config* config, Tase2_DataModel model)
+    {
+        for (Tase2_BilateralTable blt : config->getBilateralTables ())
+        {
+            Tase2_BilateralTable_destroy (blt);
+        }
+
+        delete config;
+        Tase2_DataModel_destroy (model);
+    }
+
+    string snapshotPath;
+};
+
+TEST_F (ModelSnapshotTest, ReplayBuildsSameModel)
+{
+    uint64_t hash = TASE2ModelSnapshot::hash (model_config, exchanged_data);
+
+    TASE2Config* imported = new TASE2Config ();
+    Tase2_DataModel importedModel = Tase2_DataModel_create ();
+    TASE2ModelSnapshot snapshot (hash);
+
+    imported->setModelSnapshot (&snapshot);
+    imported->importModelConfig (model_config, importedModel);
+    imported->importExchangeConfig (exchanged_data, importedModel);
+    imported->setModelSnapshot (nullptr);
+
+    ASSERT_TRUE (snapshot.save (snapshotPath));
+
+    TASE2Config* replayed = new TASE2Config ();
+    Tase2_DataModel replayedModel = Tase2_DataModel_create ();
+
+    ASSERT_TRUE (
+        replayed->importModelSnapshot (snapshotPath, hash, replayedModel));
+
+    const TASE2PointIndex& expected = imported->getPointIndex ();
+    const TASE2PointIndex& actual = replayed->getPointIndex ();
+
+    ASSERT_EQ (expected.size (), 4);
+    ASSERT_EQ (actual.size (), expected.size ());
+
+    for (uint32_t i = 0; i < expected.size (); i++)
+    {
+        TASE2Datapoint* e = expected.point (i);
+        TASE2Datapoint* a = actual.point (i);
+
+        ASSERT_EQ (actual.domain (i), expected.domain (i));
+        ASSERT_EQ (a->getLabel (), e->getLabel ());
+        ASSERT_EQ (a->getType (), e->getType ());
+        ASSERT_EQ (a->getPointId (), e->getPointId ());
+        ASSERT_EQ (a->isCoalesceExempt (), e->isCoalesceExempt ());
+        ASSERT_EQ (a->hasChangeFilter (), e->hasChangeFilter ());
+        ASSERT_EQ (a->getCheckBackId (), e->getCheckBackId ());
+        ASSERT_EQ (a->inExchangedDefinitions (), e->inExchangedDefinitions ());
+        ASSERT_EQ (a->getCommandRate () != nullptr,
+                   e->getCommandRate () != nullptr);
+    }
+
+    ASSERT_EQ (replayed->getControlPoints ().size (), 1);
+    ASSERT_EQ (replayed->getBilateralTables ().size (), 1);
+    ASSERT_EQ (replayed->GlobalCommandRateLimit ().rate, 20.0);
+    ASSERT_EQ (replayed->GlobalCommandRateLimit ().burst, 40.0);
+
+    const TASE2AssetEntry* entry = replayed->getDatapointByAsset ("TS1");
+
+    ASSERT_NE (entry, nullptr);
+    ASSERT_EQ (entry->domain, "icc1");
+    ASSERT_EQ (entry->point->getLabel (), "datapoint1");
+    ASSERT_NE (replayed->getDatapointByAsset ("label2"), nullptr);
+
+    destroyModel (replayed, replayedModel);
+    destroyModel (imported, importedModel);
+}
+
+TEST_F (ModelSnapshotTest, RejectOtherConfigurationOrDamage)
+{
+    uint64_t hash = TASE2ModelSnapshot::hash (model_config, exchanged_data);
+    TASE2ModelSnapshot snapshot (hash);
+
+    snapshot.addDomain ("icc1");
+
+    ASSERT_TRUE (snapshot.save (snapshotPath));
+
+    /* the exchanged data is part of the key */
+    ASSERT_NE (TASE2ModelSnapshot::hash (model_config, ""), hash);
+
+    TASE2SnapshotReader reader;
+    ASSERT_FALSE (reader.open (snapshotPath, hash + 1));
+
+    TASE2SnapshotReader valid;
+    ASSERT_TRUE (valid.open (snapshotPath, hash));
+
+    FILE* file = fopen (snapshotPath.c_str (), "r+b");
+    ASSERT_NE (file, nullptr);
+    fseek (file, -2, SEEK_END);
+    fputc ('x', file);
+    fclose (file);
+
+    TASE2SnapshotReader damaged;
+    ASSERT_FALSE (damaged.open (snapshotPath, hash));
+
+    ASSERT_FALSE (damaged.open ("/nonexistent/tase2.model", hash));
+}
+
+TEST_F (ModelSnapshotTest, FailedImportRemovesSnapshot)
+{
+    /* the import stops at the point that is not an object */
+    string config = QUOTE ({
+        "model_conf" : {
+            "vcc" : { "datapoints" : [ 1 ] },
+            "icc" : [],
+            "bilateral_tables" : []
+        }
+    });
+
+    /* left from an earlier configuration */
+    ASSERT_EQ (access (snapshotPath.c_str (), F_OK), 0);
+
+    TASE2Server* tase2Server = new TASE2Server ();
+
+    tase2Server->setModelSnapshotPath (snapshotPath);
+    tase2Server->setJsonConfig (protocol_stack, exchanged_data, "", config);
+
+    ASSERT_NE (access (snapshotPath.c_str (), F_OK), 0);
+
+    delete tase2Server;
+
+    tase2Server = new TASE2Server ();
+
+    tase2Server->setModelSnapshotPath (snapshotPath);
+    tase2Server->setJsonConfig (protocol_stack, exchanged_data, "",
+                                model_config);
+
+    ASSERT_EQ (access (snapshotPath.c_str (), F_OK), 0);
+
+    delete tase2Server;
+}
+
+TEST_F (ModelSnapshotTest, WarmRestart)
+{
+    string config = createLargeModelConfig (SNAPSHOT_POINTS);
+    string exchange = QUOTE ({ "exchanged_data" : { "datapoints" : [] } });
+
+    TASE2Server* servers[2];
+
+    unlink (snapshotPath.c_str ());
+
+    /* the first start writes the snapshot, the second one replays it */
+    for (int start = 0; start < 2; start++)
+    {
+        servers[start] = new TASE2Server ();
+
+        servers[start]->setModelSnapshotPath (snapshotPath);
+        servers[start]->setJsonConfig (protocol_stack, exchange, "", config);
+
+        ASSERT_EQ (access (snapshotPath.c_str (), R_OK), 0);
+    }
+
+    ASSERT_FALSE (servers[0]->isModelReplayed ());
+    ASSERT_TRUE (servers[1]->isModelReplayed ());
+
+    const TASE2PointIndex& imported
+        = servers[0]->getConfig ()->getPointIndex ();
+    const TASE2PointIndex& replayed
+        = servers[1]->getConfig ()->getPointIndex ();
+
+    ASSERT_EQ (imported.size (), (size_t)SNAPSHOT_POINTS);
+    ASSERT_EQ (replayed.size (), imported.size ());
+    ASSERT_EQ (servers[1]->getConfig ()->getModelShape (),
+               servers[0]->getConfig ()->getModelShape ());
+
+    for (uint32_t i = 0; i < imported.size (); i++)
+    {
+        ASSERT_EQ (replayed.domain (i), imported.domain (i));
+        ASSERT_EQ (replayed.point (i)->getLabel (),
+                   imported.point (i)->getLabel ());
+        ASSERT_EQ (replayed.point (i)->getType (),
+                   imported.point (i)->getType ());
+    }
+
+    delete servers[1];
+    delete servers[0];
+}
@@ -0,0 +1,118 @@
+#include "tase2_outstanding_command.hpp"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class OutstandingCommandTest : public testing::Test
+{
+  protected:
+    void
+    SetUp () override
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            auto point = make_shared<TASE2Datapoint> (
+                "command" + to_string (i), COMMAND);
+            point->setControlIndex (i);
+            points.push_back (point);
+
+            /* the handles only serve as keys */
+            controlPoints[(Tase2_ControlPoint)(intptr_t)(i + 1)]
+                = point.get ();
+        }
+
+        commands.init (controlPoints);
+    }
+
+    vector<shared_ptr<TASE2Datapoint> > points;
+    unordered_map<Tase2_ControlPoint, TASE2Datapoint*> controlPoints;
+    TASE2OutstandingCommands commands;
+};
+
+TEST_F (OutstandingCommandTest, SelectOperateConfirm)
+{
+    TASE2OutstandingCommand* command = commands.get (points[0].get ());
+    ASSERT_NE (command, nullptr);
+    ASSERT_EQ (command->State (), COMMAND_IDLE);
+
+    ASSERT_TRUE (commands.select (*command, 1000, 10, 0));
+    ASSERT_EQ (command->State (), COMMAND_SELECTED);
+    ASSERT_EQ (command->Deadline (), 11000);
+    ASSERT_EQ (commands.size (), 1);
+    ASSERT_TRUE (points[0]->hasOutstandingCommands ());
+
+    /* duplicate select */
+    ASSERT_FALSE (commands.select (*command, 1100, 10, 0));
+
+    /* confirmation of the select, the point stays selected */
+    ASSERT_TRUE (commands.confirm (*command));
+    ASSERT_EQ (command->State (), COMMAND_SELECTED);
+    ASSERT_FALSE (commands.confirm (*command));
+
+    ASSERT_TRUE (commands.operate (*command, 2000, 5, 0));
+    ASSERT_EQ (command->State (), COMMAND_OPERATING);
+    ASSERT_EQ (command->Deadline (), 7000);
+    ASSERT_EQ (commands.size (), 1);
+
+    /* duplicate operate */
+    ASSERT_FALSE (commands.operate (*command, 2100, 5, 0));
+
+    ASSERT_TRUE (commands.confirm (*command));
+    ASSERT_EQ (command->State (), COMMAND_CONFIRMED);
+    ASSERT_EQ (commands.size (), 0);
+    ASSERT_FALSE (points[0]->hasOutstandingCommands ());
+
+    /* a confirmed point accepts a new select */
+    ASSERT_TRUE (commands.select (*command, 3000, 10, 0));
+}
+
+TEST_F (OutstandingCommandTest, Timeouts)
+{
+    TASE2OutstandingCommand* command = commands.get (points[1].get ());
+
+    ASSERT_TRUE (commands.select (*command, 0, 10, 0));
+    uint64_t selectId = command->Id ();
+
+    ASSERT_TRUE (commands.operate (*command, 100, 5, 0));
+    uint64_t operateId = command->Id ();
+
+    /* the select timeout was superseded by the operate */
+    ASSERT_FALSE (commands.expire (*command, selectId));
+    ASSERT_EQ (command->State (), COMMAND_OPERATING);
+
+    ASSERT_TRUE (commands.expire (*command, operateId));
+    ASSERT_EQ (command->State (), COMMAND_IDLE);
+    ASSERT_EQ (commands.size (), 0);
+
+    ASSERT_FALSE (commands.expire (*command, operateId));
+
+    /* select timeout */
+    ASSERT_TRUE (commands.select (*command, 0, 10, 0));
+    ASSERT_TRUE (commands.expire (*command, command->Id ()));
+    ASSERT_EQ (command->State (), COMMAND_IDLE);
+}
+
+TEST_F (OutstandingCommandTest, Cancel)
+{
+    ASSERT_TRUE (
+        commands.select (*commands.get (points[0].get ()), 0, 10, 0));
+    ASSERT_TRUE (
+        commands.operate (*commands.get (points[2].get ()), 0, 5, 0));
+    ASSERT_EQ (commands.size (), 2);
+
+    commands.clear ();
+
+    ASSERT_EQ (commands.size (), 0);
+    ASSERT_TRUE (commands.empty ());
+
+    for (auto& point : points)
+    {
+        ASSERT_FALSE (point->hasOutstandingCommands ());
+        ASSERT_EQ (commands.get (point.get ())->State (), COMMAND_IDLE);
+    }
+
+    /* not a control point of the table */
+    TASE2Datapoint other ("other", COMMAND);
+    other.setControlIndex (0);
+    ASSERT_EQ (commands.get (&other), nullptr);
+}
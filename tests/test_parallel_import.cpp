@@ -0,0 +1,127 @@
+#include "tase2.hpp"
+#include "tase2_import_pool.hpp"
+#include "tase2_test_model.hpp"
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+
+using namespace std;
+
+#define PARALLEL_ICCS 32
+
+TEST (ParallelImportTest, SameModelInIccOrder)
+{
+    string config = QUOTE ({
+        "model_conf" : {
+            "vcc" : {
+                "datapoints" : [
+                    { "name" : "vccpoint1", "type" : "Real", "hasCOV" : false }
+                ]
+            },
+            "icc" : [
+                {
+                    "name" : "icc1",
+                    "datapoints" : [
+                        {
+                            "name" : "point1",
+                            "type" : "Real",
+                            "hasCOV" : false
+                        },
+                        { "name" : "invalid", "type" : "Unknown" },
+                        {
+                            "name" : "point2",
+                            "type" : "State",
+                            "hasCOV" : false
+                        }
+                    ]
+                },
+                {
+                    "name" : "icc2",
+                    "datapoints" : [
+                        {
+                            "name" : "point1",
+                            "type" : "Real",
+                            "hasCOV" : false
+                        }
+                    ]
+                },
+                { "name" : "icc3" },
+                {
+                    "name" : "icc4",
+                    "datapoints" : [
+                        {
+                            "name" : "point1",
+                            "type" : "Real",
+                            "hasCOV" : false
+                        }
+                    ]
+                }
+            ],
+            "bilateral_tables" : []
+        }
+    });
+
+    ImportResult dom = importModel (config, false);
+    ImportResult stream = importModel (config, true);
+
+    /* the ICC without datapoints stops the import */
+    vector<string> expected
+        = { "vcc:vccpoint1", "icc1:point1", "icc1:point2", "icc2:point1" };
+
+    ASSERT_EQ (dom.points, expected);
+    ASSERT_EQ (stream.points, expected);
+}
+
+TEST (ParallelImportTest, PoolRunsTasksOnItsThreads)
+{
+    thread::id owner = this_thread::get_id ();
+    vector<thread::id> ranOn (PARALLEL_ICCS);
+
+    {
+        TASE2ImportPool pool (4);
+
+        for (int i = 0; i < PARALLEL_ICCS; i++)
+        {
+            pool.submit ([&ranOn, i] { ranOn[i] = this_thread::get_id (); });
+        }
+
+        /* the model is only changed after this, by the owner */
+        pool.wait ();
+    }
+
+    set<thread::id> threads (ranOn.begin (), ranOn.end ());
+
+    ASSERT_EQ (threads.count (owner), 0);
+    ASSERT_EQ (threads.count (thread::id ()), 0);
+    ASSERT_LE (threads.size (), 4);
+
+    /* without threads the tasks run in submit */
+    TASE2ImportPool inlinePool (0);
+
+    inlinePool.submit ([&ranOn] { ranOn[0] = this_thread::get_id (); });
+
+    ASSERT_EQ (ranOn[0], owner);
+}
+
+TEST (ParallelImportTest, PointIdsFollowIccOrder)
+{
+    /* the first ICCs are the largest, with threads they finish last */
+    vector<int> iccSizes;
+    vector<string> expected;
+
+    for (int icc = 0; icc < PARALLEL_ICCS; icc++)
+    {
+        iccSizes.push_back ((PARALLEL_ICCS - icc) * 20);
+
+        for (int i = 0; i < iccSizes.back (); i++)
+        {
+            expected.push_back ("icc" + to_string (icc) + ":point"
+                                + to_string (i));
+        }
+    }
+
+    string config = createTestModelConfig (iccSizes, false);
+
+    ASSERT_EQ (importModel (config, false).points, expected);
+    ASSERT_EQ (importModel (config, true).points, expected);
+}
@@ -0,0 +1,148 @@
+#include "tase2_pivot.hpp"
+#include <gtest/gtest.h>
+#include <reading.h>
+
+using namespace std;
+
+template <class T>
+static Datapoint*
+createDatapoint (const std::string& dataname, const T value)
+{
+    DatapointValue dp_value = DatapointValue (value);
+    return new Datapoint (dataname, dp_value);
+}
+
+static Datapoint*
+createDataObject (vector<Datapoint*>* attributes)
+{
+    DatapointValue dpv (attributes, true);
+    return new Datapoint ("data_object", dpv);
+}
+
+TEST (PivotDecoderTest, AttributeNames)
+{
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_domain"),
+               PIVOT_ATTR_DOMAIN);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_name"), PIVOT_ATTR_NAME);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_type"), PIVOT_ATTR_TYPE);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_value"),
+               PIVOT_ATTR_VALUE);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_validity"),
+               PIVOT_ATTR_VALIDITY);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_cs"), PIVOT_ATTR_CS);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_quality_normal_value"),
+               PIVOT_ATTR_NORMAL_VALUE);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_ts"), PIVOT_ATTR_TS);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_ts_validity"),
+               PIVOT_ATTR_TS_VALIDITY);
+
+    /* same hash key as a known attribute but different text */
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("xx_name"),
+               PIVOT_ATTR_UNKNOWN);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute ("do_tx"), PIVOT_ATTR_UNKNOWN);
+    ASSERT_EQ (TASE2PivotDecoder::getAttribute (""), PIVOT_ATTR_UNKNOWN);
+}
+
+TEST (PivotDecoderTest, QualityFlags)
+{
+    ASSERT_EQ (TASE2PivotDecoder::getValidityFlags ("valid"),
+               TASE2_DATA_FLAGS_VALIDITY_VALID);
+    ASSERT_EQ (TASE2PivotDecoder::getValidityFlags ("held"),
+               TASE2_DATA_FLAGS_VALIDITY_HELD);
+    ASSERT_EQ (TASE2PivotDecoder::getValidityFlags ("suspect"),
+               TASE2_DATA_FLAGS_VALIDITY_SUSPECT);
+    ASSERT_EQ (TASE2PivotDecoder::getValidityFlags ("invalid"),
+               TASE2_DATA_FLAGS_VALIDITY_NOTVALID);
+    ASSERT_EQ (TASE2PivotDecoder::getValidityFlags ("iNvalid"), 0);
+
+    ASSERT_EQ (TASE2PivotDecoder::getCurrentSourceFlags ("telemetered"),
+               TASE2_DATA_FLAGS_CURRENT_SOURCE_TELEMETERED);
+    ASSERT_EQ (TASE2PivotDecoder::getCurrentSourceFlags ("entered"),
+               TASE2_DATA_FLAGS_CURRENT_SOURCE_ENTERED);
+    ASSERT_EQ (TASE2PivotDecoder::getCurrentSourceFlags ("calculated"),
+               TASE2_DATA_FLAGS_CURRENT_SOURCE_CALCULATED);
+    ASSERT_EQ (TASE2PivotDecoder::getCurrentSourceFlags ("estimated"),
+               TASE2_DATA_FLAGS_CURRENT_SOURCE_ESTIMATED);
+    ASSERT_EQ (TASE2PivotDecoder::getCurrentSourceFlags ("unknown"), 0);
+}
+
+TEST (PivotDecoderTest, DecodeDataObject)
+{
+    auto* attributes = new vector<Datapoint*>;
+    attributes->push_back (createDatapoint ("do_type", "RealQTime"));
+    attributes->push_back (createDatapoint ("do_domain", "icc1"));
+    attributes->push_back (createDatapoint ("do_name", "datapointReal"));
+    attributes->push_back (createDatapoint ("do_value", 12.5));
+    attributes->push_back (createDatapoint ("do_validity", "suspect"));
+    attributes->push_back (createDatapoint ("do_cs", "estimated"));
+    attributes->push_back (
+        createDatapoint ("do_quality_normal_value", "normal"));
+    attributes->push_back (createDatapoint ("do_ts", (long)123456));
+    attributes->push_back (createDatapoint ("do_ts_validity", "invalid"));
+
+    Datapoint* dataObject = createDataObject (attributes);
+
+    TASE2PivotRecord record;
+
+    ASSERT_TRUE (TASE2PivotDecoder::decode (dataObject, record));
+
+    ASSERT_STREQ (record.domain, "icc1");
+    ASSERT_STREQ (record.name, "datapointReal");
+    ASSERT_EQ (record.type, REALQTIME);
+    ASSERT_EQ (record.valueKind, PIVOT_VALUE_FLOAT);
+    ASSERT_DOUBLE_EQ (record.floatValue, 12.5);
+    ASSERT_EQ (record.dataFlags,
+               TASE2_DATA_FLAGS_VALIDITY_SUSPECT
+                   | TASE2_DATA_FLAGS_CURRENT_SOURCE_ESTIMATED
+                   | TASE2_DATA_FLAGS_NORMAL_VALUE);
+    ASSERT_TRUE (record.hasTs);
+    ASSERT_EQ (record.timestamp, 123456);
+    ASSERT_FALSE (record.tsValid);
+
+    delete dataObject;
+}
+
+TEST (PivotDecoderTest, DecodeNameTooLong)
+{
+    auto* attributes = new vector<Datapoint*>;
+    attributes->push_back (createDatapoint ("do_type", "State"));
+    attributes->push_back (createDatapoint ("do_domain", "icc1"));
+    attributes->push_back (createDatapoint (
+        "do_name", std::string (TASE2_PIVOT_MAX_ID_LENGTH + 1, 'x')));
+    attributes->push_back (createDatapoint ("do_value", (long)1));
+
+    Datapoint* dataObject = createDataObject (attributes);
+
+    TASE2PivotRecord record;
+
+    ASSERT_FALSE (TASE2PivotDecoder::decode (dataObject, record));
+    ASSERT_EQ (record.valueKind, PIVOT_VALUE_INTEGER);
+
+    delete dataObject;
+}
+
+TEST (PivotDecoderTest, DecodeValueOnly)
+{
+    auto* attributes = new vector<Datapoint*>;
+    attributes->push_back (createDatapoint ("do_type", "RealQ"));
+    attributes->push_back (createDatapoint ("do_domain", "icc1"));
+    attributes->push_back (createDatapoint (
+        "do_name", std::string (TASE2_PIVOT_MAX_ID_LENGTH + 1, 'x')));
+    attributes->push_back (createDatapoint ("do_value", 1.5));
+    attributes->push_back (createDatapoint ("do_validity", "suspect"));
+
+    Datapoint* dataObject = createDataObject (attributes);
+
+    TASE2PivotRecord record;
+
+    /* the identifiers are not looked at, not even their length */
+    ASSERT_TRUE (TASE2PivotDecoder::decode (dataObject, record, false));
+    ASSERT_STREQ (record.domain, "");
+    ASSERT_STREQ (record.name, "");
+    ASSERT_EQ (record.type, DP_TYPE_UNKNOWN);
+    ASSERT_EQ (record.valueKind, PIVOT_VALUE_FLOAT);
+    ASSERT_EQ (record.floatValue, 1.5);
+    ASSERT_EQ (record.dataFlags, TASE2_DATA_FLAGS_VALIDITY_SUSPECT);
+
+    delete dataObject;
+}
@@ -0,0 +1,147 @@
+#include "tase2_point_index.hpp"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+#define MEMORY_POINTS 100000
+
+static void
+fillDomain (TASE2PointIndex& index, const string& domain, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        index.insert (domain, "point" + to_string (i), REALQTIME);
+    }
+}
+
+TEST (PointIndexTest, InsertAndFind)
+{
+    TASE2PointIndex index;
+
+    TASE2Datapoint* p1 = index.insert ("icc1", "datapoint1", STATE);
+    TASE2Datapoint* p2 = index.insert ("icc2", "datapoint1", REAL);
+
+    ASSERT_EQ (index.size (), 2);
+    ASSERT_EQ (index.find ("icc1", "datapoint1"), p1);
+    ASSERT_EQ (index.find (string ("icc2"), string ("datapoint1")), p2);
+    ASSERT_EQ (index.point (1), p2);
+    ASSERT_EQ (index.domain (1), "icc2");
+
+    /* the separator keeps domain and name apart */
+    ASSERT_EQ (index.find ("icc1d", "atapoint1"), nullptr);
+    ASSERT_EQ (index.find ("icc3", "datapoint1"), nullptr);
+    ASSERT_EQ (index.find ("icc1", "datapoint2"), nullptr);
+
+    /* same reference is rejected, the point is kept as it is */
+    ASSERT_EQ (index.insert ("icc1", p1->getLabel (), DISCRETE), nullptr);
+
+    ASSERT_EQ (index.size (), 2);
+    ASSERT_EQ (index.find ("icc1", "datapoint1"), p1);
+    ASSERT_EQ (p1->getType (), STATE);
+    ASSERT_EQ (p1->getLabel (), "datapoint1");
+    ASSERT_EQ (p1->getPointId (), 0);
+
+    ASSERT_TRUE (index.hasDomain ("icc1"));
+    ASSERT_TRUE (index.hasDomain ("icc2"));
+    ASSERT_FALSE (index.hasDomain ("icc"));
+
+    /* lookup with a pointer/length pair into a larger buffer */
+    const char* ref = "icc2:datapoint1";
+    ASSERT_EQ (index.find (TASE2StringRef (ref, 4), TASE2StringRef (ref + 5)),
+               p2);
+
+    index.clear ();
+
+    ASSERT_EQ (index.size (), 0);
+    ASSERT_EQ (index.find ("icc1", "datapoint1"), nullptr);
+    ASSERT_FALSE (index.hasDomain ("icc1"));
+}
+
+TEST (PointIndexTest, GrowKeepsEntries)
+{
+    TASE2PointIndex index;
+
+    fillDomain (index, "icc1", 5000);
+    fillDomain (index, "icc2", 10);
+
+    ASSERT_EQ (index.size (), 5010);
+
+    for (size_t i = 0; i < 5000; i++)
+    {
+        string name = "point" + to_string (i);
+        TASE2Datapoint* point = index.find ("icc1", name);
+
+        ASSERT_NE (point, nullptr);
+        ASSERT_EQ (point->getLabel (), name);
+        ASSERT_EQ (point->getPointId (), i);
+        ASSERT_EQ (index.point (i), point);
+    }
+
+    ASSERT_NE (index.find ("icc2", "point9"), nullptr);
+    ASSERT_EQ (index.find ("icc2", "point10"), nullptr);
+}
+
+TEST (PointIndexTest, LookupCostIsFlat)
+{
+    const size_t sizes[] = { 100, 1000, 10000, 100000 };
+
+    ASSERT_EQ (TASE2PointIndex ().probes ("icc1", "point0"), 0);
+
+    for (size_t size : sizes)
+    {
+        TASE2PointIndex index;
+
+        fillDomain (index, "vcc", 10);
+        fillDomain (index, "icc1", size);
+
+        size_t total = 0;
+        size_t longest = 0;
+
+        for (size_t i = 0; i < size; i++)
+        {
+            size_t probes = index.probes ("icc1", "point" + to_string (i));
+
+            ASSERT_GE (probes, 1);
+
+            total += probes;
+            longest = max (longest, probes);
+        }
+
+        /* the table is at most half full, a lookup looks at a few slots
+         * whatever the size of the domain */
+        ASSERT_LT ((double)total / size, 2.0);
+        ASSERT_LT (longest, 64);
+
+        ASSERT_LT (index.probes ("icc1", "missing"), 64);
+    }
+}
+
+TEST (PointIndexTest, MemoryPerPoint)
+{
+    /* two cache lines, the hot fields come first */
+    ASSERT_LE (sizeof (TASE2Datapoint), 128);
+
+    TASE2PointIndex index;
+
+    fillDomain (index, "icc1", MEMORY_POINTS);
+
+    ASSERT_EQ (index.size (), (size_t)MEMORY_POINTS);
+
+    /* the points live in the chunks, not in allocations of their own */
+    ASSERT_EQ (index.chunks (),
+               (size_t)(MEMORY_POINTS + TASE2_POINT_CHUNK - 1)
+                   / TASE2_POINT_CHUNK);
+    ASSERT_EQ (index.chunks (), 98);
+
+    uintptr_t first = (uintptr_t)index.point (0);
+
+    for (uint32_t pointId = 1; pointId < TASE2_POINT_CHUNK; pointId++)
+    {
+        ASSERT_EQ ((uintptr_t)index.point (pointId),
+                   first + pointId * sizeof (TASE2Datapoint));
+    }
+
+    index.clear ();
+
+    ASSERT_EQ (index.chunks (), 0);
+}
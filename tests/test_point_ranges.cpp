@@ -0,0 +1,202 @@
+#include "tase2.hpp"
+#include "tase2_test_model.hpp"
+#include <cstdio>
+#include <gtest/gtest.h>
+
+using namespace std;
+
+#define RANGE_METERS 2000
+#define RANGE_BREAKERS 200
+
+/* the same model as createExpandedConfig, written with ranges and tags */
+static string
+createRangeConfig ()
+{
+    return "{\"model_conf\":{\"vcc\":{\"datapoints\":[{\"prefix\":\"vcc\","
+           "\"range\":[1,3],\"type\":\"Real\",\"hasCOV\":false}]},"
+           "\"icc\":[{\"name\":\"icc1\",\"datapoints\":["
+           "{\"name\":\"status\",\"type\":\"State\",\"hasCOV\":false},"
+           "{\"prefix\":\"meter\",\"range\":[1,"
+           + to_string (RANGE_METERS)
+           + "],\"digits\":4,\"type\":\"RealQTime\",\"hasCOV\":false,"
+             "\"deadband\":0.5,\"tag\":\"meters\"},"
+             "{\"prefix\":\"breaker\",\"range\":[0,"
+           + to_string (RANGE_BREAKERS - 1)
+           + "],\"type\":\"Command\",\"mode\":\"sbo\",\"hasTag\":false,"
+             "\"checkBackId\":1,\"tag\":\"breakers\"}]}],"
+             "\"bilateral_tables\":["
+             "{\"name\":\"BLT1\",\"icc\":\"icc1\",\"apTitle\":\"1.1.1.998\","
+             "\"aeQualifier\":12,\"datapoints\":[{\"name\":\"status\"},"
+             "{\"tag\":\"meters\"},{\"prefix\":\"breaker\","
+             "\"range\":[0,9]}]},"
+             "{\"name\":\"BLT2\",\"icc\":\"icc1\",\"apTitle\":\"1.1.1.997\","
+             "\"aeQualifier\":12,\"datapoints\":[{\"tag\":\"breakers\"}]}],"
+             "\"datasets\":[{\"name\":\"ds1\",\"domain\":\"icc1\","
+             "\"datapoints\":[\"status\",{\"prefix\":\"meter\","
+             "\"range\":[1,10],\"digits\":4}]}]}}";
+}
+
+static string
+createExpandedConfig ()
+{
+    string vcc;
+    string meters;
+    string breakers;
+    string meterNames;
+    string breakerNames;
+    string firstBreakers;
+
+    for (int i = 1; i <= 3; i++)
+    {
+        vcc += string (i > 1 ? "," : "") + "{\"name\":\"vcc"
+               + to_string (i) + "\",\"type\":\"Real\",\"hasCOV\":false}";
+    }
+
+    for (int i = 1; i <= RANGE_METERS; i++)
+    {
+        char name[16];
+
+        snprintf (name, sizeof (name), "meter%04d", i);
+
+        meters += string (",{\"name\":\"") + name
+                  + "\",\"type\":\"RealQTime\",\"hasCOV\":false,"
+                    "\"deadband\":0.5}";
+        meterNames += string (",{\"name\":\"") + name + "\"}";
+    }
+
+    for (int i = 0; i < RANGE_BREAKERS; i++)
+    {
+        string name = "breaker" + to_string (i);
+
+        breakers += ",{\"name\":\"" + name
+                    + "\",\"type\":\"Command\",\"mode\":\"sbo\","
+                      "\"hasTag\":false,\"checkBackId\":1}";
+        breakerNames += string (i > 0 ? "," : "") + "{\"name\":\"" + name
+                        + "\"}";
+
+        if (i < 10)
+        {
+            firstBreakers += ",{\"name\":\"" + name + "\"}";
+        }
+    }
+
+    return "{\"model_conf\":{\"vcc\":{\"datapoints\":[" + vcc
+           + "]},\"icc\":[{\"name\":\"icc1\",\"datapoints\":["
+             "{\"name\":\"status\",\"type\":\"State\",\"hasCOV\":false}"
+           + meters + breakers
+           + "]}],\"bilateral_tables\":["
+             "{\"name\":\"BLT1\",\"icc\":\"icc1\",\"apTitle\":\"1.1.1.998\","
+             "\"aeQualifier\":12,\"datapoints\":[{\"name\":\"status\"}"
+           + meterNames + firstBreakers
+           + "]},"
+             "{\"name\":\"BLT2\",\"icc\":\"icc1\",\"apTitle\":\"1.1.1.997\","
+             "\"aeQualifier\":12,\"datapoints\":["
+           + breakerNames
+           + "]}],"
+             "\"datasets\":[{\"name\":\"ds1\",\"domain\":\"icc1\","
+             "\"datapoints\":[\"status\",\"meter0001\",\"meter0002\","
+             "\"meter0003\",\"meter0004\",\"meter0005\",\"meter0006\","
+             "\"meter0007\",\"meter0008\",\"meter0009\",\"meter0010\"]}]}}";
+}
+
+TEST (PointRangesTest, RangesExpandToSameModel)
+{
+    string rangeConfig = createRangeConfig ();
+    string expandedConfig = createExpandedConfig ();
+
+    ImportResult expanded = importModel (expandedConfig, false);
+
+    ASSERT_EQ (expanded.points.size (),
+               (size_t)(3 + 1 + RANGE_METERS + RANGE_BREAKERS));
+    ASSERT_EQ (expanded.points[4], "icc1:meter0001");
+    ASSERT_EQ (expanded.tables.size (), 2);
+    ASSERT_EQ (expanded.tables[0].points.size (),
+               (size_t)(1 + RANGE_METERS + 10));
+    ASSERT_EQ (expanded.tables[1].points.size (), (size_t)RANGE_BREAKERS);
+
+    for (bool stream : { false, true })
+    {
+        ImportResult ranges = importModel (rangeConfig, stream);
+
+        ASSERT_EQ (ranges.points, expanded.points);
+        ASSERT_EQ (ranges.tables, expanded.tables);
+
+        /* includes the dataset entries */
+        ASSERT_EQ (ranges.shape, expanded.shape);
+    }
+
+    ASSERT_LT (rangeConfig.size () * 10, expandedConfig.size ());
+}
+
+TEST (PointRangesTest, InvalidRangeStopsImport)
+{
+    string config = QUOTE ({
+        "model_conf" : {
+            "vcc" : { "datapoints" : [] },
+            "icc" : [ {
+                "name" : "icc1",
+                "datapoints" : [
+                    {
+                        "prefix" : "point",
+                        "range" : [ 1, 2 ],
+                        "type" : "Real",
+                        "hasCOV" : false
+                    },
+                    {
+                        "prefix" : "reversed",
+                        "range" : [ 5, 1 ],
+                        "type" : "Real",
+                        "hasCOV" : false
+                    },
+                    { "name" : "last", "type" : "Real", "hasCOV" : false }
+                ]
+            } ],
+            "bilateral_tables" : []
+        }
+    });
+
+    vector<string> expected = { "icc1:point1", "icc1:point2" };
+
+    ASSERT_EQ (importModel (config, false).points, expected);
+    ASSERT_EQ (importModel (config, true).points, expected);
+}
+
+TEST (PointRangesTest, TableEntriesSelectExistingPoints)
+{
+    string config = QUOTE ({
+        "model_conf" : {
+            "vcc" : { "datapoints" : [] },
+            "icc" : [ {
+                "name" : "icc1",
+                "datapoints" : [ {
+                    "prefix" : "point",
+                    "range" : [ 1, 2 ],
+                    "type" : "Real",
+                    "hasCOV" : false,
+                    "tag" : "points"
+                } ]
+            } ],
+            "bilateral_tables" : [ {
+                "name" : "BLT1",
+                "icc" : "icc1",
+                "apTitle" : "1.1.1.998",
+                "aeQualifier" : 12,
+                "datapoints" : [
+                    { "tag" : "unknown" }, { "prefix" : "point" },
+                    { "prefix" : "point", "range" : [ 0, 9 ] },
+                    { "tag" : "points" }
+                ]
+            } ]
+        }
+    });
+
+    for (bool stream : { false, true })
+    {
+        ImportResult result = importModel (config, stream);
+
+        ASSERT_EQ (result.tables.size (), 1);
+
+        /* point1 and point2 from the range, then again from the tag */
+        ASSERT_EQ (result.tables[0].points.size (), 4);
+    }
+}
@@ -0,0 +1,146 @@
+#include "tase2.hpp"
+#include "tase2_rate_limit.hpp"
+#include <gtest/gtest.h>
+
+using namespace std;
+
+static bool
+takeToken (TASE2TokenBucket& bucket, uint64_t nowUs)
+{
+    if (!bucket.refill (nowUs))
+    {
+        return false;
+    }
+
+    bucket.take ();
+
+    return true;
+}
+
+TEST (TokenBucketTest, Unlimited)
+{
+    TASE2TokenBucket bucket;
+
+    ASSERT_FALSE (bucket.isLimited ());
+
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_TRUE (takeToken (bucket, 1000000));
+    }
+}
+
+TEST (TokenBucketTest, BurstThenRate)
+{
+    TASE2RateLimit limit = { 2.0, 5.0 };
+    TASE2TokenBucket bucket (limit);
+
+    uint64_t now = 1000000;
+
+    /* the bucket starts full */
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_TRUE (takeToken (bucket, now));
+    }
+
+    ASSERT_FALSE (takeToken (bucket, now));
+
+    /* two tokens per second */
+    ASSERT_FALSE (takeToken (bucket, now + 400000));
+    ASSERT_TRUE (takeToken (bucket, now + 500000));
+    ASSERT_FALSE (takeToken (bucket, now + 600000));
+    ASSERT_TRUE (takeToken (bucket, now + 1000000));
+
+    /* never more than the burst */
+    now += 60000000;
+
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_TRUE (takeToken (bucket, now));
+    }
+
+    ASSERT_FALSE (takeToken (bucket, now));
+}
+
+TEST (TokenBucketTest, RefillWithoutTake)
+{
+    TASE2RateLimit limit = { 1.0, 0.0 };
+    TASE2TokenBucket bucket (limit);
+
+    /* a burst below one still lets a single command through */
+    ASSERT_TRUE (bucket.refill (1000000));
+    ASSERT_TRUE (bucket.refill (1000000));
+
+    bucket.take ();
+
+    ASSERT_FALSE (bucket.refill (1000000));
+    ASSERT_TRUE (bucket.refill (2000000));
+}
+
+TEST (RateLimitTest, RejectedRequestKeepsTokens)
+{
+    string protocol_stack = QUOTE ({
+        "protocol_stack" : {
+            "name" : "tase2north",
+            "version" : "1.0",
+            "transport_layer" : {
+                "srv_ip" : "0.0.0.0",
+                "port" : 10002,
+                "passive" : true,
+                "localApTitle" : "1.1.1.999:12",
+                "remoteApTitle" : "1.1.1.998:12"
+            }
+        }
+    });
+
+    /* two requests, no refill during the test */
+    string model_config = QUOTE ({
+        "model_conf" : {
+            "vcc" : { "datapoints" : [] },
+            "icc" : [ {
+                "name" : "icc1",
+                "datapoints" : [ {
+                    "name" : "command1",
+                    "type" : "Command",
+                    "mode" : "sbo",
+                    "hasTag" : false,
+                    "checkBackId" : 1,
+                    "rate_limit" : { "rate" : 0.001, "burst" : 2 }
+                } ]
+            } ],
+            "bilateral_tables" : []
+        }
+    });
+
+    TASE2Server* tase2Server = new TASE2Server ();
+
+    tase2Server->setJsonConfig (
+        protocol_stack,
+        QUOTE ({ "exchanged_data" : { "datapoints" : [] } }), "",
+        model_config);
+
+    TASE2Datapoint* command
+        = tase2Server->getConfig ()->findDatapoint ("icc1", "command1");
+
+    ASSERT_NE (command, nullptr);
+
+    ASSERT_EQ (tase2Server->startCommand (command, true, 0),
+               TASE2_RESULT_SUCCESS);
+
+    /* rejected by the select state, not by the rate limit */
+    ASSERT_EQ (tase2Server->startCommand (command, true, 0),
+               TASE2_RESULT_TEMPORARILY_UNAVAILABLE);
+    ASSERT_EQ (tase2Server->getThrottledCommands (), 0);
+
+    /* the second token is still there for the operate */
+    ASSERT_EQ (tase2Server->startCommand (command, false, 0),
+               TASE2_RESULT_SUCCESS);
+
+    /* the point is free again, the next request hits the rate limit */
+    tase2Server->cancelCommand (command);
+
+    ASSERT_EQ (tase2Server->startCommand (command, true, 0),
+               TASE2_RESULT_TEMPORARILY_UNAVAILABLE);
+    ASSERT_EQ (tase2Server->getThrottledCommands (), 1);
+
+    delete tase2Server;
+}
@@ -0,0 +1,273 @@
+#include "tase2.hpp"
+#include <gtest/gtest.h>
+#include <plugin_api.h>
+
+using namespace std;
+
+extern "C"
+{
+    PLUGIN_HANDLE plugin_init (ConfigCategory* config);
+
+    void plugin_reconfigure (PLUGIN_HANDLE* handle, const string& newConfig);
+
+    void plugin_shutdown (PLUGIN_HANDLE handle);
+};
+
+static string protocol_stack = QUOTE ({
+    "protocol_stack" : {
+        "name" : "tase2north",
+        "version" : "1.0",
+        "transport_layer" : {
+            "srv_ip" : "0.0.0.0",
+            "port" : 10002,
+            "passive" : true,
+            "localApTitle" : "1.1.1.999:12",
+            "remoteApTitle" : "1.1.1.998:12"
+        }
+    }
+});
+
+static string exchanged_data = QUOTE ({
+    "exchanged_data" : {
+        "datapoints" : [
+            {
+                "label" : "TS1",
+                "protocols" : [ { "name" : "tase2", "ref" : "icc1:point1" } ]
+            },
+            {
+                "label" : "TS2",
+                "protocols" : [ { "name" : "tase2", "ref" : "icc1:real1" } ]
+            },
+            {
+                "label" : "TC1",
+                "protocols" :
+                    [ { "name" : "tase2", "ref" : "icc1:command1" } ]
+            }
+        ]
+    }
+});
+
+/* real1 left out, point1 under another label */
+static string exchanged_data_changed = QUOTE ({
+    "exchanged_data" : {
+        "datapoints" : [
+            {
+                "label" : "TS10",
+                "protocols" : [ { "name" : "tase2", "ref" : "icc1:point1" } ]
+            },
+            {
+                "label" : "TC1",
+                "protocols" :
+                    [ { "name" : "tase2", "ref" : "icc1:command1" } ]
+            }
+        ]
+    }
+});
+
+struct ModelOptions
+{
+    double deadband;
+    int commandRate;
+    bool commandInBlt2;
+    bool extraPoint;
+};
+
+static string
+createModelConfig (const ModelOptions& options)
+{
+    string points
+        = "{\"name\":\"point1\",\"type\":\"StateQTime\",\"hasCOV\":false},"
+          "{\"name\":\"real1\",\"type\":\"Real\",\"hasCOV\":false,"
+          "\"deadband\":"
+          + to_string (options.deadband)
+          + "},"
+            "{\"name\":\"command1\",\"type\":\"Command\",\"mode\":\"direct\","
+            "\"hasTag\":false,\"checkBackId\":1,\"rate_limit\":{\"rate\":"
+          + to_string (options.commandRate) + "}}";
+
+    if (options.extraPoint)
+    {
+        points += ",{\"name\":\"point2\",\"type\":\"State\","
+                  "\"hasCOV\":false}";
+    }
+
+    string blt2 = "{\"name\":\"point1\"}";
+
+    if (options.commandInBlt2)
+    {
+        blt2 += ",{\"name\":\"command1\"}";
+    }
+
+    return "{\"model_conf\":{\"vcc\":{\"datapoints\":[]},"
+           "\"icc\":[{\"name\":\"icc1\",\"datapoints\":["
+           + points
+           + "]}],\"bilateral_tables\":["
+             "{\"name\":\"BLT1\",\"icc\":\"icc1\",\"apTitle\":\"1.1.1.998\","
+             "\"aeQualifier\":12,\"datapoints\":[{\"name\":\"point1\"},"
+             "{\"name\":\"real1\"}]},"
+             "{\"name\":\"BLT2\",\"icc\":\"icc1\",\"apTitle\":\"1.1.1.997\","
+             "\"aeQualifier\":12,\"datapoints\":["
+           + blt2 + "]}]}}";
+}
+
+static string
+escape (const string& json)
+{
+    string escaped;
+
+    for (char c : json)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+
+        escaped += c;
+    }
+
+    return escaped;
+}
+
+static string
+createCategory (const string& stack, const string& model,
+                const string& exchange)
+{
+    return "{\"name\":{\"description\":\"Server name\",\"type\":\"string\","
+           "\"default\":\"tase2reconfigure\"},"
+           "\"protocol_stack\":{\"description\":\"Protocol stack\","
+           "\"type\":\"JSON\",\"default\":\""
+           + escape (stack)
+           + "\"},"
+             "\"model_conf\":{\"description\":\"Data model\","
+             "\"type\":\"JSON\",\"default\":\""
+           + escape (model)
+           + "\"},"
+             "\"exchanged_data\":{\"description\":\"Exchanged data\","
+             "\"type\":\"JSON\",\"default\":\""
+           + escape (exchange) + "\"}}";
+}
+
+class ReconfigureTest : public testing::Test
+{
+  protected:
+    void
+    SetUp () override
+    {
+        ModelOptions options = { 0.5, 5, false, false };
+
+        ConfigCategory config (
+            "tase2Config", createCategory (protocol_stack,
+                                           createModelConfig (options),
+                                           exchanged_data));
+
+        handle = plugin_init (&config);
+        server = (TASE2Server*)handle;
+    }
+
+    void
+    TearDown () override
+    {
+        plugin_shutdown (handle);
+    }
+
+    void
+    reconfigure (const string& stack, const ModelOptions& options,
+                 const string& exchange)
+    {
+        plugin_reconfigure (
+            &handle,
+            createCategory (stack, createModelConfig (options), exchange));
+    }
+
+    PLUGIN_HANDLE handle = nullptr;
+    TASE2Server* server = nullptr;
+};
+
+TEST_F (ReconfigureTest, ModelSnapshotIsOptIn)
+{
+    /* the category has no model_snapshot item */
+    ASSERT_TRUE (server->getModelSnapshotPath ().empty ());
+}
+
+TEST_F (ReconfigureTest, UpdateInPlace)
+{
+    TASE2Config* config = server->getConfig ();
+    TASE2Datapoint* point1 = config->findDatapoint ("icc1", "point1");
+    TASE2Datapoint* real1 = config->findDatapoint ("icc1", "real1");
+    TASE2Datapoint* command1 = config->findDatapoint ("icc1", "command1");
+
+    ASSERT_NE (point1, nullptr);
+    ASSERT_NE (real1, nullptr);
+    ASSERT_NE (command1, nullptr);
+    ASSERT_TRUE (real1->inExchangedDefinitions ());
+    ASSERT_EQ (real1->getDeadband (), 0.5);
+    ASSERT_EQ (command1->getCommandRate ()->getLimit ().rate, 5.0);
+    ASSERT_EQ (config->getBilateralTables ().size (), 2);
+
+    Tase2_BilateralTable blt1 = config->getBilateralTables ()[0];
+    Tase2_BilateralTable blt2 = config->getBilateralTables ()[1];
+    uint64_t shape = config->getModelShape ();
+
+    ModelOptions options = { 2.0, 1, true, false };
+
+    reconfigure (protocol_stack, options, exchanged_data_changed);
+
+    /* same configuration, same model, same points */
+    ASSERT_EQ (server->getConfig (), config);
+    ASSERT_EQ (config->getModelShape (), shape);
+    ASSERT_EQ (config->findDatapoint ("icc1", "real1"), real1);
+
+    ASSERT_FALSE (real1->inExchangedDefinitions ());
+    ASSERT_TRUE (point1->inExchangedDefinitions ());
+    ASSERT_EQ (real1->getDeadband (), 2.0);
+    ASSERT_EQ (command1->getCommandRate ()->getLimit ().rate, 1.0);
+
+    ASSERT_EQ (config->getDatapointByAsset ("TS1"), nullptr);
+    ASSERT_EQ (config->getDatapointByAsset ("TS2"), nullptr);
+
+    const TASE2AssetEntry* entry = config->getDatapointByAsset ("TS10");
+
+    ASSERT_NE (entry, nullptr);
+    ASSERT_EQ (entry->point, point1);
+
+    /* only the table with other points is replaced */
+    ASSERT_EQ (config->getBilateralTables ().size (), 2);
+    ASSERT_EQ (config->getBilateralTables ()[0], blt1);
+    ASSERT_NE (config->getBilateralTables ()[1], blt2);
+}
+
+TEST_F (ReconfigureTest, RebuildOnModelChange)
+{
+    TASE2Config* config = server->getConfig ();
+    uint64_t shape = config->getModelShape ();
+
+    ModelOptions options = { 0.5, 5, false, true };
+
+    reconfigure (protocol_stack, options, exchanged_data);
+
+    ASSERT_NE (server->getConfig (), config);
+    ASSERT_NE (server->getConfig ()->getModelShape (), shape);
+    ASSERT_NE (server->getConfig ()->findDatapoint ("icc1", "point2"),
+               nullptr);
+    ASSERT_EQ (server->getConfig ()->getBilateralTables ().size (), 2);
+}
+
+TEST_F (ReconfigureTest, RebuildOnProtocolChange)
+{
+    TASE2Config* config = server->getConfig ();
+
+    string stack = protocol_stack;
+    size_t port = stack.find ("10002");
+
+    ASSERT_NE (port, string::npos);
+    stack.replace (port, 5, "10003");
+
+    ModelOptions options = { 0.5, 5, false, false };
+
+    reconfigure (stack, options, exchanged_data);
+
+    ASSERT_NE (server->getConfig (), config);
+    ASSERT_EQ (server->getConfig ()->TcpPort (), 10003);
+    ASSERT_NE (server->getConfig ()->findDatapoint ("icc1", "point1"),
+               nullptr);
+}
@@ -1084,4 +1084,27 @@ TEST_F (SendSpontDataTest, SendDataNotInExchange)
     executeTest<int> (client, handle, "StateSupQTimeExt",
                       "datapointNotInExchange", "Ex", "valid", "telemetered",
                       "normal", 12, false);
-}
\ No newline at end of file
+}
+TEST_F (SendSpontDataTest, SendDataByAssetLabel)
+{
+    ConfigCategory config;
+    Tase2_Client client;
+
+    setupTest (config, handle, client);
+
+    const TASE2AssetEntry* entry
+        = ((TASE2Server*)handle)->getConfig ()->getDatapointByAsset ("TS3");
+
+    ASSERT_NE (entry, nullptr);
+    ASSERT_EQ (entry->domain, "icc1");
+    ASSERT_EQ (entry->point->getLabel (), "datapointReal");
+    ASSERT_EQ (entry->point->getType (), REAL);
+    ASSERT_EQ (entry->traits, TASE2UpdateTable::get (REAL));
+
+    ASSERT_EQ (
+        ((TASE2Server*)handle)->getConfig ()->getDatapointByAsset ("Ex"),
+        nullptr);
+
+    executeTest<float> (client, handle, "Real", "datapointReal", "TS3",
+                        "valid", "telemetered", "normal", 42.5f, true);
+}
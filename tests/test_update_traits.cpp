@@ -0,0 +1,40 @@
+#include "tase2_update_traits.hpp"
+#include <gtest/gtest.h>
+
+static_assert (TASE2TypeTraits<REALQTIMEEXT>::valueKind == PIVOT_VALUE_FLOAT,
+               "Real points carry a float value");
+static_assert (!TASE2TypeTraits<STATE>::hasQuality, "State has no quality");
+static_assert (TASE2TypeTraits<DISCRETEQTIME>::hasTimestamp,
+               "DiscreteQTime has a timestamp");
+
+TEST (UpdateTraitsTest, TableMatchesTypes)
+{
+    for (int type = REAL; type < COMMAND; type++)
+    {
+        const TASE2UpdateTraits* traits
+            = TASE2UpdateTable::get (static_cast<DPTYPE> (type));
+
+        ASSERT_NE (traits, nullptr);
+        ASSERT_NE (traits->apply, nullptr);
+
+        ASSERT_EQ (traits->valueKind, type <= REALQTIMEEXT
+                                          ? PIVOT_VALUE_FLOAT
+                                          : PIVOT_VALUE_INTEGER);
+        ASSERT_EQ (traits->hasQuality, type % 4 != 0);
+        ASSERT_EQ (traits->hasTimestamp, type % 4 >= 2);
+    }
+
+    /* both timestamp variants share the setter */
+    ASSERT_EQ (TASE2UpdateTable::get (STATESUPQTIME)->apply,
+               TASE2UpdateTable::get (STATESUPQTIMEEXT)->apply);
+    ASSERT_NE (TASE2UpdateTable::get (STATESUPQ)->apply,
+               TASE2UpdateTable::get (STATESUPQTIME)->apply);
+}
+
+TEST (UpdateTraitsTest, NoEntryForCommands)
+{
+    ASSERT_EQ (TASE2UpdateTable::get (COMMAND), nullptr);
+    ASSERT_EQ (TASE2UpdateTable::get (SETPOINTREAL), nullptr);
+    ASSERT_EQ (TASE2UpdateTable::get (SETPOINTDISCRETE), nullptr);
+    ASSERT_EQ (TASE2UpdateTable::get (DP_TYPE_UNKNOWN), nullptr);
+}